@@ -0,0 +1,193 @@
+/******************************************************************************
+ *  File Name:
+ *    lockfree_queue.hpp
+ *
+ *  Description:
+ *    Bounded multi-producer/multi-consumer lock free queue
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOCKFREE_QUEUE_HPP
+#define AURORA_LOCKFREE_QUEUE_HPP
+
+/* STL Includes */
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Aurora::Container
+{
+  /**
+   * Fixed capacity queue based on Dmitry Vyukov's bounded MPMC design. Each cell
+   * carries a sequence number that tells producers and consumers whether it is
+   * ready for them, so the only contention is a single compare-exchange on the
+   * head or tail index. No mutexes are involved, making it safe to push from
+   * any thread without risk of priority inversion.
+   *
+   * Memory is embedded in the object, so static allocation is recommended.
+   *
+   * @tparam T    Element type. Must be copy assignable.
+   * @tparam N    Number of elements. Must be a power of two.
+   */
+  template<typename T, const size_t N>
+  class LockFreeQueue
+  {
+    static_assert( ( N >= 2 ) && ( ( N & ( N - 1 ) ) == 0 ), "Queue size must be a power of two" );
+
+  public:
+    LockFreeQueue()
+    {
+      clear();
+    }
+
+    ~LockFreeQueue()
+    {
+    }
+
+    /**
+     *  @brief Resets the queue to empty
+     *  @warning Not thread safe. Only call when nothing else is accessing the queue.
+     *
+     *  @return void
+     */
+    void clear()
+    {
+      for ( size_t i = 0; i < N; i++ )
+      {
+        mCells[ i ].sequence.store( i, std::memory_order_relaxed );
+      }
+
+      mEnqueuePos.store( 0, std::memory_order_relaxed );
+      mDequeuePos.store( 0, std::memory_order_relaxed );
+    }
+
+    /**
+     *  @brief Adds an element to the back of the queue
+     *
+     *  @param item     Element to copy in
+     *  @return bool    False if the queue was full
+     */
+    bool push( const T &item )
+    {
+      Cell  *cell = nullptr;
+      size_t pos  = mEnqueuePos.load( std::memory_order_relaxed );
+
+      while ( true )
+      {
+        cell = &mCells[ pos & MASK ];
+
+        const size_t   seq = cell->sequence.load( std::memory_order_acquire );
+        const intptr_t dif = static_cast<intptr_t>( seq ) - static_cast<intptr_t>( pos );
+
+        if ( dif == 0 )
+        {
+          if ( mEnqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+          {
+            break;
+          }
+        }
+        else if ( dif < 0 )
+        {
+          return false;
+        }
+        else
+        {
+          pos = mEnqueuePos.load( std::memory_order_relaxed );
+        }
+      }
+
+      cell->data = item;
+      cell->sequence.store( pos + 1, std::memory_order_release );
+      return true;
+    }
+
+    /**
+     *  @brief Removes an element from the front of the queue
+     *
+     *  @param item     Output element
+     *  @return bool    False if the queue was empty
+     */
+    bool pop( T &item )
+    {
+      Cell  *cell = nullptr;
+      size_t pos  = mDequeuePos.load( std::memory_order_relaxed );
+
+      while ( true )
+      {
+        cell = &mCells[ pos & MASK ];
+
+        const size_t   seq = cell->sequence.load( std::memory_order_acquire );
+        const intptr_t dif = static_cast<intptr_t>( seq ) - static_cast<intptr_t>( pos + 1 );
+
+        if ( dif == 0 )
+        {
+          if ( mDequeuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+          {
+            break;
+          }
+        }
+        else if ( dif < 0 )
+        {
+          return false;
+        }
+        else
+        {
+          pos = mDequeuePos.load( std::memory_order_relaxed );
+        }
+      }
+
+      item = cell->data;
+      cell->sequence.store( pos + MASK + 1, std::memory_order_release );
+      return true;
+    }
+
+    /**
+     *  @brief Approximate number of elements in the queue
+     *  @note Only a snapshot. Other threads may change it at any time.
+     *
+     *  @return size_t
+     */
+    size_t size() const
+    {
+      const size_t head = mDequeuePos.load( std::memory_order_relaxed );
+      const size_t tail = mEnqueuePos.load( std::memory_order_relaxed );
+      return ( tail >= head ) ? ( tail - head ) : 0;
+    }
+
+    /**
+     *  @brief Checks if the queue is empty
+     *  @return bool
+     */
+    bool empty() const
+    {
+      return size() == 0;
+    }
+
+    /**
+     *  @brief Max number of elements the queue can hold
+     *  @return size_t
+     */
+    static constexpr size_t capacity()
+    {
+      return N;
+    }
+
+  private:
+    static constexpr size_t MASK = N - 1;
+
+    struct Cell
+    {
+      std::atomic<size_t> sequence;
+      T                   data;
+    };
+
+    std::array<Cell, N> mCells;
+    std::atomic<size_t> mEnqueuePos;
+    std::atomic<size_t> mDequeuePos;
+  };
+}  // namespace Aurora::Container
+
+#endif /* !AURORA_LOCKFREE_QUEUE_HPP */
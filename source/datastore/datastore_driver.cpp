@@ -17,10 +17,23 @@
 
 namespace Aurora::Datastore
 {
+  /*---------------------------------------------------------------------------
+  Observable Implementation
+  ---------------------------------------------------------------------------*/
+  void IObservableAttr::onPublish( Manager *const manager, const Database::Key key, const void *const data,
+                                   const size_t size )
+  {
+    if ( manager )
+    {
+      manager->onPublish( key, data, size );
+    }
+  }
+
+
   /*---------------------------------------------------------------------------
   Manager Implementation
   ---------------------------------------------------------------------------*/
-  Manager::Manager() : mObservableMap( nullptr )
+  Manager::Manager() : mObservableMap( nullptr ), mRecorder( nullptr )
   {
   }
 
@@ -71,6 +84,7 @@ namespace Aurora::Datastore
       is located.
       -------------------------------------------------*/
       observable->assignDatabase( database );
+      observable->assignManager( this );
 
       /*-------------------------------------------------
       Allocate memory in the database for the observable
@@ -171,4 +185,54 @@ namespace Aurora::Datastore
     this->unlock();
     return result;
   }
+
+
+  bool Manager::inject( const Database::Key key, const void *const data, const size_t size )
+  {
+    bool result = false;
+    this->lock();
+
+    /*-------------------------------------------------------------------------
+    Does the key exist?
+    -------------------------------------------------------------------------*/
+    auto iterator = mObservableMap->find( key );
+    if ( iterator == mObservableMap->end() )
+    {
+      mCBService_registry.call<CB_INVALID_KEY>();
+      goto exit;
+    }
+
+    /*-------------------------------------------------------------------------
+    Publish the data as if the observable produced it
+    -------------------------------------------------------------------------*/
+    result = iterator->second->inject( data, size );
+
+  /*-------------------------------------------------
+  Common exit sequence
+  -------------------------------------------------*/
+  exit:
+    this->unlock();
+    return result;
+  }
+
+
+  void Manager::attachRecorder( Recorder *const recorder )
+  {
+    this->lock();
+    mRecorder = recorder;
+    this->unlock();
+  }
+
+
+  void Manager::onPublish( const Database::Key key, const void *const data, const size_t size )
+  {
+    /*-------------------------------------------------------------------------
+    The recorder does its own locking. Don't grab the registry lock here as
+    this is usually called from inside process() with it already held.
+    -------------------------------------------------------------------------*/
+    if ( mRecorder )
+    {
+      mRecorder->record( key, data, size );
+    }
+  }
 }  // namespace Aurora::Datastore
@@ -25,6 +25,11 @@
 
 namespace Aurora::Datastore
 {
+  /*---------------------------------------------------------------------------
+  Forward Declarations
+  ---------------------------------------------------------------------------*/
+  class Recorder;
+
   /*---------------------------------------------------------------------------
   Classes
   ---------------------------------------------------------------------------*/
@@ -86,11 +91,35 @@ namespace Aurora::Datastore
      */
     bool requestUpdate( const Database::Key key );
 
+    /**
+     *  Pushes data through the publish path of an observable, exactly as if the
+     *  observable had produced it. Used to replay recorded data.
+     *
+     *  @param[in]  key           The key to publish against
+     *  @param[in]  data          Data to publish
+     *  @param[in]  size          Size of the data, must match the registered size
+     *  @return bool
+     */
+    bool inject( const Database::Key key, const void *const data, const size_t size );
+
+    /**
+     *  Attaches a flight recorder that captures every observable update. Pass
+     *  nullptr to detach the current recorder.
+     *
+     *  @param[in]  recorder      Recorder to attach
+     *  @return void
+     */
+    void attachRecorder( Recorder *const recorder );
+
   private:
     friend Chimera::Thread::Lockable<Manager>;
     friend Chimera::Callback::DelegateService<Manager, CallbackId>;
+    friend IObservableAttr;
 
     ObservableMap *mObservableMap;
+    Recorder      *mRecorder;
+
+    void onPublish( const Database::Key key, const void *const data, const size_t size );
   };
 }  // namespace Aurora::Datastore
 
@@ -0,0 +1,169 @@
+/******************************************************************************
+ *  File Name:
+ *    datastore_filter.hpp
+ *
+ *  Description:
+ *    Notification filters for reducing observer traffic on noisy data
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_DATASTORE_FILTER_HPP
+#define AURORA_DATASTORE_FILTER_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <etl/delegate.h>
+#include <etl/observer.h>
+
+namespace Aurora::Datastore
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Rules deciding when an observer should be told about new data
+   *
+   * Every rule is optional and disabled when left at its zero value. The
+   * interval, mask, and deadband checks must all pass for a notification to
+   * be dispatched. Exceeding either deadband satisfies the deadband check.
+   *
+   * Deadbands operate directly on arithmetic types. Structured types need a
+   * distance function that reduces the change between two samples to a single
+   * magnitude. The relative deadband for structured types is measured against
+   * the distance between the last notified value and a value initialized one.
+   */
+  template<typename T>
+  struct NotifyFilter
+  {
+    using DistanceFunc = etl::delegate<float( const T &, const T & )>;
+
+    float        absDeadband; /**< Notify only if the value moved more than this */
+    float        relDeadband; /**< Notify only if the value moved more than this fraction of itself */
+    size_t       minInterval; /**< Minimum time between notifications in milliseconds */
+    const T     *fieldMask;   /**< Notify only if a bit set in this mask changed */
+    DistanceFunc distance;    /**< Distance metric for non-arithmetic types */
+
+    NotifyFilter() : absDeadband( 0.0f ), relDeadband( 0.0f ), minInterval( 0 ), fieldMask( nullptr ), distance()
+    {
+    }
+  };
+
+
+  /**
+   * @brief Runtime state of a filter attached to a single observer
+   *
+   * Plain observers use a default constructed filter, which lets everything
+   * through, so both kinds live in the same observer list.
+   */
+  template<typename T>
+  struct FilteredObserver
+  {
+    etl::observer<T> *observer; /**< Observer being filtered */
+    NotifyFilter<T>   filter;   /**< Rules to apply */
+    T                 last;     /**< Last value the observer was notified with */
+    size_t            lastTime; /**< Time of the last notification */
+    bool              primed;   /**< Has the observer been notified at least once? */
+    bool              enabled;  /**< Is the observer currently accepting notifications? */
+
+    /**
+     * @brief Decides if the observer should see the new data
+     *
+     * Updates the filter state when the notification is allowed through.
+     *
+     * @param data    Newly published data
+     * @param now     Current system time in milliseconds
+     * @return bool   True if the observer should be notified
+     */
+    bool evaluate( const T &data, const size_t now )
+    {
+      if ( primed && !( passInterval( now ) && passMask( data ) && passDeadband( data ) ) )
+      {
+        return false;
+      }
+
+      last     = data;
+      lastTime = now;
+      primed   = true;
+      return true;
+    }
+
+  private:
+    bool passInterval( const size_t now ) const
+    {
+      return ( now - lastTime ) >= filter.minInterval;
+    }
+
+    bool passMask( const T &data ) const
+    {
+      if ( !filter.fieldMask )
+      {
+        return true;
+      }
+
+      auto mask = reinterpret_cast<const uint8_t *>( filter.fieldMask );
+      auto lhs  = reinterpret_cast<const uint8_t *>( &data );
+      auto rhs  = reinterpret_cast<const uint8_t *>( &last );
+
+      for ( size_t idx = 0; idx < sizeof( T ); idx++ )
+      {
+        if ( ( lhs[ idx ] ^ rhs[ idx ] ) & mask[ idx ] )
+        {
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    bool passDeadband( const T &data ) const
+    {
+      if ( ( filter.absDeadband <= 0.0f ) && ( filter.relDeadband <= 0.0f ) )
+      {
+        return true;
+      }
+
+      /*-----------------------------------------------------------------------
+      Reduce the change to a single magnitude
+      -----------------------------------------------------------------------*/
+      float delta     = 0.0f;
+      float magnitude = 0.0f;
+
+      if constexpr ( std::is_arithmetic_v<T> )
+      {
+        delta     = std::fabs( static_cast<float>( data ) - static_cast<float>( last ) );
+        magnitude = std::fabs( static_cast<float>( last ) );
+      }
+      else
+      {
+        if ( !filter.distance.is_valid() )
+        {
+          return true;
+        }
+
+        delta     = filter.distance( data, last );
+        magnitude = filter.distance( last, T{} );
+      }
+
+      /*-----------------------------------------------------------------------
+      Any enabled deadband that's exceeded lets the change through
+      -----------------------------------------------------------------------*/
+      if ( ( filter.absDeadband > 0.0f ) && ( delta > filter.absDeadband ) )
+      {
+        return true;
+      }
+
+      return ( filter.relDeadband > 0.0f ) && ( delta > ( filter.relDeadband * magnitude ) );
+    }
+  };
+
+}  // namespace Aurora::Datastore
+
+#endif /* !AURORA_DATASTORE_FILTER_HPP */
@@ -15,13 +15,19 @@
 /* STL Includes */
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <limits>
 
 /* ETL Includes */
 #include <etl/observer.h>
+#include <etl/vector.h>
 
 /* Aurora Includes */
 #include <Aurora/source/database/volatile/database_intf.hpp>
+#include <Aurora/source/datastore/datastore_filter.hpp>
+
+/* Chimera Includes */
+#include <Chimera/thread>
 
 namespace Aurora::Datastore
 {
@@ -100,6 +106,19 @@ namespace Aurora::Datastore
       return false;
     }
 
+    /**
+     *  Pushes externally sourced data through the observable's publish path,
+     *  as if it had been produced by update(). Used for replaying recordings.
+     *
+     *  @param[in]  data      Data to publish, sized for observable type
+     *  @param[in]  size      Size of the data buffer
+     *  @return bool          True if the data was accepted
+     */
+    virtual bool inject( const void *const data, const size_t size )
+    {
+      return false;
+    }
+
     /**
      *  Checks if the currently stored data is stale
      *  @return bool
@@ -152,14 +171,35 @@ namespace Aurora::Datastore
     {
       return nullptr;
     };
+    virtual void assignManager( Manager *const manager ){};
+
+    /**
+     *  Informs the manager that new data was published for a key. This is
+     *  where system wide hooks, like the flight recorder, get their data.
+     *
+     *  @param[in]  manager   Manager the observable is registered with
+     *  @param[in]  key       Key of the published data
+     *  @param[in]  data      The published data
+     *  @param[in]  size      Number of bytes in the data buffer
+     *  @return void
+     */
+    static void onPublish( Manager *const manager, const Database::Key key, const void *const data, const size_t size );
   };
 
 
   template<typename DataType, const Database::Key AccessKey, const size_t NumObservers, const size_t Rate, const size_t Timeout>
-  class BaseObservable : public etl::observable<etl::observer<DataType>, NumObservers>, virtual public IObservableAttr
+  class BaseObservable : virtual public IObservableAttr
   {
   public:
-    BaseObservable() : mLastUpdate( 0 ), mDB( nullptr ), mKey( AccessKey ), mRate( Rate ), mTimeout( Timeout )
+    /*-------------------------------------------------------------------------------
+    Aliases, matching etl::observable
+    -------------------------------------------------------------------------------*/
+    using observer_type = etl::observer<DataType>;
+    using size_type     = size_t;
+
+    BaseObservable() :
+        mLastUpdate( 0 ), mDB( nullptr ), mManager( nullptr ), mNotifyDepth( 0 ), mDeferredErase( false ), mKey( AccessKey ),
+        mRate( Rate ), mTimeout( Timeout )
     {
     }
 
@@ -216,6 +256,254 @@ namespace Aurora::Datastore
       return read( &tmp, sizeof( tmp ) ) && validate( &tmp, sizeof( tmp ) );
     }
 
+
+    bool inject( const void *const data, const size_t size ) final override
+    {
+      if ( !data || ( size != sizeof( DataType ) ) )
+      {
+        return false;
+      }
+
+      DataType tmp;
+      memcpy( &tmp, data, sizeof( DataType ) );
+      return publish( tmp );
+    }
+
+
+    /**
+     *  Registers an observer that hears about every update. Observers may be
+     *  added and removed from inside their own notification() callback.
+     *
+     *  @param[in]  observer  Observer to notify
+     *  @return bool          True if registered
+     */
+    bool add_observer( etl::observer<DataType> &observer )
+    {
+      return addFilteredObserver( observer, NotifyFilter<DataType>() );
+    }
+
+
+    /**
+     *  Registers an observer that is only notified when the filter rules
+     *  decide the new data is meaningfully different from what the observer
+     *  last saw. Plain and filtered observers share the same NumObservers
+     *  slots. Registering an existing observer replaces its filter.
+     *
+     *  @param[in]  observer  Observer to notify
+     *  @param[in]  filter    Rules deciding when to notify
+     *  @return bool          True if registered
+     */
+    bool addFilteredObserver( etl::observer<DataType> &observer, const NotifyFilter<DataType> &filter )
+    {
+      Chimera::Thread::LockGuard _lck( mObserverLock );
+
+      for ( auto &entry : mObservers )
+      {
+        if ( entry.observer == &observer )
+        {
+          entry.filter = filter;
+          entry.primed = false;
+          return true;
+        }
+      }
+
+      FilteredObserver<DataType> entry;
+      entry.observer = &observer;
+      entry.filter   = filter;
+      entry.lastTime = 0;
+      entry.primed   = false;
+      entry.enabled  = true;
+
+      /*-----------------------------------------------------------------------
+      Slots emptied during a notification haven't been erased yet, so reuse
+      one of those if the list looks full
+      -----------------------------------------------------------------------*/
+      if ( mObservers.full() )
+      {
+        for ( auto &slot : mObservers )
+        {
+          if ( !slot.observer )
+          {
+            slot = entry;
+            return true;
+          }
+        }
+
+        return false;
+      }
+
+      mObservers.push_back( entry );
+      return true;
+    }
+
+
+    /**
+     *  Removes an observer, filtered or not
+     *
+     *  @param[in]  observer  Observer to remove
+     *  @return bool          True if the observer was found
+     */
+    bool remove_observer( etl::observer<DataType> &observer )
+    {
+      Chimera::Thread::LockGuard _lck( mObserverLock );
+
+      for ( auto iter = mObservers.begin(); iter != mObservers.end(); iter++ )
+      {
+        if ( iter->observer != &observer )
+        {
+          continue;
+        }
+
+        /*---------------------------------------------------------------------
+        Erasing would shift the list out from under notify_observers(), so
+        while it runs just empty the slot and clean up once it's done
+        ---------------------------------------------------------------------*/
+        if ( mNotifyDepth )
+        {
+          iter->observer = nullptr;
+          mDeferredErase = true;
+        }
+        else
+        {
+          mObservers.erase( iter );
+        }
+
+        return true;
+      }
+
+      return false;
+    }
+
+
+    /**
+     *  Turns notifications for an observer on or off without removing it
+     *
+     *  @param[in]  observer  Observer to change
+     *  @param[in]  state     True to enable, false to disable
+     *  @return void
+     */
+    void enable_observer( etl::observer<DataType> &observer, const bool state = true )
+    {
+      Chimera::Thread::LockGuard _lck( mObserverLock );
+
+      for ( auto &entry : mObservers )
+      {
+        if ( entry.observer == &observer )
+        {
+          entry.enabled = state;
+          return;
+        }
+      }
+    }
+
+
+    /**
+     *  Stops notifying an observer without removing it
+     *
+     *  @param[in]  observer  Observer to change
+     *  @return void
+     */
+    void disable_observer( etl::observer<DataType> &observer )
+    {
+      enable_observer( observer, false );
+    }
+
+
+    /**
+     *  Alias of remove_observer(), kept for symmetry with addFilteredObserver()
+     *
+     *  @param[in]  observer  Observer to remove
+     *  @return bool          True if the observer was found
+     */
+    bool removeFilteredObserver( etl::observer<DataType> &observer )
+    {
+      return remove_observer( observer );
+    }
+
+
+    /**
+     *  Removes all observers
+     *  @return void
+     */
+    void clear_observers()
+    {
+      Chimera::Thread::LockGuard _lck( mObserverLock );
+
+      if ( !mNotifyDepth )
+      {
+        mObservers.clear();
+        return;
+      }
+
+      for ( auto &entry : mObservers )
+      {
+        entry.observer = nullptr;
+      }
+
+      mDeferredErase = true;
+    }
+
+
+    /**
+     *  Gets the number of registered observers
+     *  @return size_type
+     */
+    size_type number_of_observers() const
+    {
+      Chimera::Thread::LockGuard _lck( mObserverLock );
+
+      size_type count = 0;
+      for ( const auto &entry : mObservers )
+      {
+        count += entry.observer ? 1u : 0u;
+      }
+
+      return count;
+    }
+
+
+    /**
+     *  Notifies observers of new data. This is the common path for every
+     *  update, whether it came through publish() or an update() implementation
+     *  calling notify_observers() directly. System wide hooks, like the flight
+     *  recorder, see every update. Each observer then only hears about it if
+     *  its filter lets the change through.
+     *
+     *  @param[in]  data      The latest data
+     *  @return void
+     */
+    void notify_observers( const DataType &data )
+    {
+      IObservableAttr::onPublish( mManager, mKey, &data, sizeof( DataType ) );
+
+      Chimera::Thread::LockGuard _lck( mObserverLock );
+      const size_t now = Chimera::millis();
+
+      /*-----------------------------------------------------------------------
+      Walk by index over the observers present at the start. A callback may
+      add observers, which land past the end and wait for the next update, or
+      remove them, which only empties their slot until the walk is over.
+      -----------------------------------------------------------------------*/
+      mNotifyDepth++;
+
+      const size_t count = mObservers.size();
+      for ( size_t idx = 0; idx < count; idx++ )
+      {
+        auto &entry = mObservers[ idx ];
+        if ( entry.observer && entry.enabled && entry.evaluate( data, now ) )
+        {
+          entry.observer->notification( data );
+        }
+      }
+
+      mNotifyDepth--;
+
+      if ( !mNotifyDepth && mDeferredErase )
+      {
+        eraseRemovedObservers();
+      }
+    }
+
   protected:
     friend Aurora::Datastore::Manager;
     size_t mLastUpdate;
@@ -234,14 +522,68 @@ namespace Aurora::Datastore
       return mDB;
     }
 
+    void assignManager( Manager *const manager ) final override
+    {
+      mManager = manager;
+    }
+
     void basicInit()
     {
       mDB         = nullptr;
       mLastUpdate = 0;
     }
 
+    /**
+     *  Common publish path for new data. Stores the data into the database,
+     *  lets the manager know about the update, then notifies all observers.
+     *
+     *  @param[in]  data      The latest data
+     *  @return bool          True if the data was stored and published
+     */
+    bool publish( const DataType &data )
+    {
+      if ( !mDB )
+      {
+        return false;
+      }
+
+      mDB->lock();
+      bool result = mDB->write( key(), &data );
+      mDB->unlock();
+
+      if ( !result )
+      {
+        return false;
+      }
+
+      mLastUpdate = Chimera::millis();
+      this->notify_observers( data );
+      return true;
+    }
+
   private:
+    /**
+     *  Drops the slots emptied while a notification was in progress. Must be
+     *  called with the observer lock held.
+     *  @return void
+     */
+    void eraseRemovedObservers()
+    {
+      for ( auto iter = mObservers.begin(); iter != mObservers.end(); )
+      {
+        iter = iter->observer ? ( iter + 1 ) : mObservers.erase( iter );
+      }
+
+      mDeferredErase = false;
+    }
+
+
     Aurora::Database::Volatile::RAM *mDB;
+    Manager *mManager;
+    mutable Chimera::Thread::RecursiveMutex mObserverLock;
+    etl::vector<FilteredObserver<DataType>, NumObservers> mObservers;
+    size_t mNotifyDepth;  /**< Nesting level of notify_observers() calls in progress */
+    bool mDeferredErase;  /**< Some observer slots were emptied during a notification */
     const Database::Key mKey;
     const size_t mRate;
     const size_t mTimeout;
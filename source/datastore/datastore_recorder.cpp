@@ -0,0 +1,338 @@
+/******************************************************************************
+ *  File Name:
+ *    datastore_recorder.cpp
+ *
+ *  Description:
+ *    Implements the datastore flight recorder and replay utilities
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/datastore>
+#include <Aurora/filesystem>
+#include <Chimera/assert>
+#include <Chimera/common>
+#include <cstring>
+
+namespace Aurora::Datastore
+{
+  /*---------------------------------------------------------------------------
+  Recorder Implementation
+  ---------------------------------------------------------------------------*/
+  Recorder::Recorder() :
+      mIsOpen( false ), mFile( -1 ), mBuffer( nullptr ), mSize( 0 ), mHead( 0 ), mTail( 0 ), mUsed( 0 ), mDropped( 0 )
+  {
+  }
+
+
+  Recorder::~Recorder()
+  {
+    this->close();
+  }
+
+
+  bool Recorder::assignCoreMemory( uint8_t *const buffer, const size_t size )
+  {
+    if ( !buffer || ( size < ( sizeof( RecordHeader ) + MAX_RECORD_SIZE ) ) )
+    {
+      return false;
+    }
+
+    Chimera::Thread::LockGuard _lck( *this );
+    mBuffer  = buffer;
+    mSize    = size;
+    mHead    = 0;
+    mTail    = 0;
+    mUsed    = 0;
+    mDropped = 0;
+    return true;
+  }
+
+
+  bool Recorder::open( const std::string_view &filename )
+  {
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( mIsOpen || !mBuffer )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Create the file and stamp it with the format header
+    -------------------------------------------------------------------------*/
+    const auto mode = FileSystem::O_WRONLY | FileSystem::O_CREAT | FileSystem::O_TRUNC;
+    if ( FileSystem::fopen( filename.data(), mode, mFile ) != 0 )
+    {
+      return false;
+    }
+
+    RecordFileHeader hdr;
+    memset( &hdr, 0, sizeof( hdr ) );
+    hdr.magic   = RECORD_FILE_MAGIC;
+    hdr.version = RECORD_FILE_VERSION;
+
+    if ( FileSystem::fwrite( &hdr, 1, sizeof( hdr ), mFile ) != sizeof( hdr ) )
+    {
+      FileSystem::fclose( mFile );
+      return false;
+    }
+
+    mIsOpen = true;
+    return true;
+  }
+
+
+  void Recorder::close()
+  {
+    if ( mIsOpen )
+    {
+      this->flush();
+      FileSystem::fflush( mFile );
+      FileSystem::fclose( mFile );
+      mFile   = -1;
+      mIsOpen = false;
+    }
+  }
+
+
+  bool Recorder::record( const Database::Key key, const void *const data, const size_t size )
+  {
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( !data || !size || ( size > MAX_RECORD_SIZE ) || !mBuffer )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Drop the record if there isn't room for it. Never block the publisher.
+    -------------------------------------------------------------------------*/
+    Chimera::Thread::LockGuard _lck( *this );
+
+    const size_t total = sizeof( RecordHeader ) + size;
+    if ( ( mSize - mUsed ) < total )
+    {
+      mDropped++;
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Stage the record
+    -------------------------------------------------------------------------*/
+    RecordHeader hdr;
+    hdr.key       = key;
+    hdr.size      = static_cast<uint16_t>( size );
+    hdr.timestamp = static_cast<uint32_t>( Chimera::millis() );
+
+    put( &hdr, sizeof( hdr ) );
+    put( data, size );
+    return true;
+  }
+
+
+  size_t Recorder::flush()
+  {
+    Chimera::Thread::LockGuard _flush_lck( mFlushLock );
+    if ( !mIsOpen )
+    {
+      return 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    Snapshot the staged region. Producers only ever write into free space, so
+    the snapshot can be streamed out without holding the ring lock.
+    -------------------------------------------------------------------------*/
+    this->lock();
+    const size_t tail  = mTail;
+    const size_t count = mUsed;
+    this->unlock();
+
+    if ( !count )
+    {
+      return 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    Write out at most two contiguous spans
+    -------------------------------------------------------------------------*/
+    const size_t first   = ( ( tail + count ) <= mSize ) ? count : ( mSize - tail );
+    const size_t second  = count - first;
+    size_t       written = FileSystem::fwrite( mBuffer + tail, 1, first, mFile );
+
+    if ( ( written == first ) && second )
+    {
+      written += FileSystem::fwrite( mBuffer, 1, second, mFile );
+    }
+
+    /*-------------------------------------------------------------------------
+    Release only what made it to disk. On a partial write the remainder stays
+    staged, so the next flush picks up mid-record exactly where the file left
+    off and the record stream stays aligned.
+    -------------------------------------------------------------------------*/
+    this->lock();
+    mTail = ( tail + written ) % mSize;
+    mUsed -= written;
+    this->unlock();
+
+    return written;
+  }
+
+
+  size_t Recorder::dropped()
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+    return mDropped;
+  }
+
+
+  size_t Recorder::pending()
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+    return mUsed;
+  }
+
+
+  void Recorder::put( const void *const data, const size_t size )
+  {
+    const uint8_t *src   = reinterpret_cast<const uint8_t *>( data );
+    const size_t   first = ( ( mHead + size ) <= mSize ) ? size : ( mSize - mHead );
+
+    memcpy( mBuffer + mHead, src, first );
+    if ( first < size )
+    {
+      memcpy( mBuffer, src + first, size - first );
+    }
+
+    mHead = ( mHead + size ) % mSize;
+    mUsed += size;
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Replay Implementation
+  ---------------------------------------------------------------------------*/
+  Replay::Replay() : mIsOpen( false ), mFile( -1 )
+  {
+  }
+
+
+  Replay::~Replay()
+  {
+    this->close();
+  }
+
+
+  bool Replay::open( const std::string_view &filename )
+  {
+    if ( mIsOpen )
+    {
+      return false;
+    }
+
+    if ( FileSystem::fopen( filename.data(), FileSystem::O_RDONLY, mFile ) != 0 )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Make sure this is actually a recording we understand
+    -------------------------------------------------------------------------*/
+    RecordFileHeader hdr;
+    if ( ( FileSystem::fread( &hdr, 1, sizeof( hdr ), mFile ) != sizeof( hdr ) ) || ( hdr.magic != RECORD_FILE_MAGIC )
+         || ( hdr.version != RECORD_FILE_VERSION ) )
+    {
+      FileSystem::fclose( mFile );
+      return false;
+    }
+
+    mIsOpen = true;
+    return true;
+  }
+
+
+  void Replay::close()
+  {
+    if ( mIsOpen )
+    {
+      FileSystem::fclose( mFile );
+      mFile   = -1;
+      mIsOpen = false;
+    }
+  }
+
+
+  bool Replay::step( Manager &manager, RecordHeader &header )
+  {
+    if ( !readNext( header ) )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Push it through the datastore. Keys that no longer exist are skipped.
+    -------------------------------------------------------------------------*/
+    manager.inject( header.key, mPayload.data(), header.size );
+    return true;
+  }
+
+
+  size_t Replay::run( Manager &manager, const float speed )
+  {
+    RecordHeader hdr;
+    size_t       count      = 0;
+    size_t       wall_start = Chimera::millis();
+    uint32_t     rec_last   = 0;
+    uint64_t     rec_time   = 0;
+
+    while ( readNext( hdr ) )
+    {
+      /*-----------------------------------------------------------------------
+      The first record anchors the timeline. Everything after is paced against
+      it, unless the caller asked for an unthrottled replay. Time is summed up
+      one record at a time, since the stored timestamps wrap.
+      -----------------------------------------------------------------------*/
+      rec_time += ( count == 0 ) ? 0u : static_cast<uint32_t>( hdr.timestamp - rec_last );
+      rec_last = hdr.timestamp;
+
+      if ( ( count != 0 ) && ( speed > 0.0f ) )
+      {
+        const float  elapsed = static_cast<float>( rec_time ) / speed;
+        const size_t target  = wall_start + static_cast<size_t>( elapsed );
+        const size_t now     = Chimera::millis();
+
+        if ( target > now )
+        {
+          Chimera::delayMilliseconds( target - now );
+        }
+      }
+
+      manager.inject( hdr.key, mPayload.data(), hdr.size );
+      count++;
+    }
+
+    return count;
+  }
+
+
+  bool Replay::readNext( RecordHeader &header )
+  {
+    if ( !mIsOpen )
+    {
+      return false;
+    }
+
+    if ( FileSystem::fread( &header, 1, sizeof( header ), mFile ) != sizeof( header ) )
+    {
+      return false;
+    }
+
+    return ( header.size <= mPayload.size() )
+           && ( FileSystem::fread( mPayload.data(), 1, header.size, mFile ) == header.size );
+  }
+}  // namespace Aurora::Datastore
@@ -0,0 +1,179 @@
+/******************************************************************************
+ *  File Name:
+ *    datastore_recorder.hpp
+ *
+ *  Description:
+ *    Flight recorder for capturing and replaying datastore updates
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_DATASTORE_RECORDER_HPP
+#define AURORA_DATASTORE_RECORDER_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/datastore/datastore_types.hpp>
+#include <Aurora/source/filesystem/file_types.hpp>
+#include <Chimera/thread>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Aurora::Datastore
+{
+  /*---------------------------------------------------------------------------
+  Forward Declarations
+  ---------------------------------------------------------------------------*/
+  class Manager;
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Captures every observable update as a compact binary record
+   *
+   * Records are packed into a RAM ring buffer from the publish path, which only
+   * costs a memcpy. Some other (lower priority) context is expected to call
+   * flush() periodically, which streams the buffered records out to a file on
+   * the Aurora filesystem. If the ring fills up before a flush occurs, new
+   * records are dropped and counted rather than stalling the publisher. Data
+   * that fails to write stays staged and is retried on the next flush.
+   *
+   * Each record on disk is a RecordHeader followed by the raw observable data.
+   */
+  class Recorder : public Chimera::Thread::Lockable<Recorder>
+  {
+  public:
+    Recorder();
+    ~Recorder();
+
+    /**
+     * @brief Assigns the ring buffer memory used to stage records
+     *
+     * @param buffer    Statically allocated memory
+     * @param size      Number of bytes in the buffer
+     * @return bool
+     */
+    bool assignCoreMemory( uint8_t *const buffer, const size_t size );
+
+    /**
+     * @brief Opens the file records will be streamed into
+     * @note Any existing file is truncated
+     *
+     * @param filename  Absolute path of the recording
+     * @return bool
+     */
+    bool open( const std::string_view &filename );
+
+    /**
+     * @brief Flushes all pending records and closes the file
+     */
+    void close();
+
+    /**
+     * @brief Stages a new record into the ring buffer
+     *
+     * @param key       Key of the observable that published
+     * @param data      Published data
+     * @param size      Number of bytes in the data
+     * @return bool     True if the record was staged, false if dropped
+     */
+    bool record( const Database::Key key, const void *const data, const size_t size );
+
+    /**
+     * @brief Writes all currently staged records to the file
+     *
+     * @return size_t   Number of bytes written
+     */
+    size_t flush();
+
+    /**
+     * @brief Number of records dropped due to a full ring buffer
+     * @return size_t
+     */
+    size_t dropped();
+
+    /**
+     * @brief Number of bytes currently staged in the ring buffer
+     * @return size_t
+     */
+    size_t pending();
+
+  private:
+    friend Chimera::Thread::Lockable<Recorder>;
+
+    Chimera::Thread::Mutex mFlushLock; /**< Serializes flushes against each other */
+    bool                   mIsOpen;    /**< Is the output file open? */
+    FileSystem::FileId     mFile;      /**< Output file descriptor */
+    uint8_t               *mBuffer;    /**< Ring buffer memory */
+    size_t                 mSize;      /**< Size of the ring buffer */
+    size_t                 mHead;      /**< Next byte to write */
+    size_t                 mTail;      /**< Next byte to flush */
+    size_t                 mUsed;      /**< Number of staged bytes */
+    size_t                 mDropped;   /**< Number of dropped records */
+
+    void put( const void *const data, const size_t size );
+  };
+
+
+  /**
+   * @brief Feeds a recording back through the datastore
+   *
+   * Each record is injected into the registered observable's publish path, so
+   * observers see the same sequence of notifications they did when recording.
+   * Playback can be paced to match the original timing or run as fast as the
+   * system allows. Intended for host side analysis, but nothing prevents its
+   * use on target.
+   */
+  class Replay
+  {
+  public:
+    Replay();
+    ~Replay();
+
+    /**
+     * @brief Opens a recording and validates its header
+     *
+     * @param filename  Absolute path of the recording
+     * @return bool
+     */
+    bool open( const std::string_view &filename );
+
+    /**
+     * @brief Closes the recording
+     */
+    void close();
+
+    /**
+     * @brief Replays a single record into the manager
+     *
+     * @param manager   Manager to inject the record into
+     * @param header    Output header of the record that was replayed
+     * @return bool     False once the end of the recording is reached
+     */
+    bool step( Manager &manager, RecordHeader &header );
+
+    /**
+     * @brief Replays the remainder of the recording
+     *
+     * @param manager   Manager to inject records into
+     * @param speed     Playback rate relative to real time. Values <= 0 replay
+     *                  as fast as possible.
+     * @return size_t   Number of records replayed
+     */
+    size_t run( Manager &manager, const float speed );
+
+  private:
+    bool                                 mIsOpen;
+    FileSystem::FileId                   mFile;
+    std::array<uint8_t, MAX_RECORD_SIZE> mPayload;
+
+    bool readNext( RecordHeader &header );
+  };
+}  // namespace Aurora::Datastore
+
+#endif /* !AURORA_DATASTORE_RECORDER_HPP */
@@ -23,8 +23,20 @@
 #include <Aurora/source/database/volatile/database_types.hpp>
 
 
+/*-----------------------------------------------------------------------------
+Literal Constants
+-----------------------------------------------------------------------------*/
+#if !defined( AURORA_PRJ_DS_MAX_RECORD_SIZE )
+#define AURORA_PRJ_DS_MAX_RECORD_SIZE ( 256 )
+#endif
+
 namespace Aurora::Datastore
 {
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t MAX_RECORD_SIZE = AURORA_PRJ_DS_MAX_RECORD_SIZE; /**< Largest observable payload the recorder accepts */
+
   /*---------------------------------------------------------------------------
   Aliases
   ---------------------------------------------------------------------------*/
@@ -45,6 +57,38 @@ namespace Aurora::Datastore
     CB_NUM_OPTIONS
   };
 
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+#pragma pack( push, 1 )
+  /**
+   *  Header placed at the start of every flight recorder file
+   */
+  struct RecordFileHeader
+  {
+    uint32_t magic;     /**< Identifies the file as a datastore recording */
+    uint8_t  version;   /**< Recording format version */
+    uint8_t  _pad[ 3 ]; /**< Unused */
+  };
+
+  /**
+   *  Header placed in front of every observable update in a recording
+   *
+   *  The timestamp is the low 32 bits of Chimera::millis(), so it wraps about
+   *  every 49.7 days. Only the difference between neighboring records is
+   *  meaningful, which Replay relies on to pace recordings across a wrap.
+   */
+  struct RecordHeader
+  {
+    Database::Key key;       /**< Key of the observable that published */
+    uint16_t      size;      /**< Number of payload bytes following this header */
+    uint32_t      timestamp; /**< System time (ms) the data was published, modulo 2^32 */
+  };
+#pragma pack( pop )
+
+  static constexpr uint32_t RECORD_FILE_MAGIC   = 0x52534441; /**< "ADSR" */
+  static constexpr uint8_t  RECORD_FILE_VERSION = 1;
+
 }  // namespace Aurora::Datastore
 
 #endif  /* !AURORA_DATASTORE_TYPES_HPP */
@@ -16,17 +16,67 @@ Includes
 
 #include <Aurora/filesystem>
 #include <Aurora/logging>
+#include <Aurora/memory>
+#include <Chimera/assert>
+#include <Chimera/common>
 #include <Chimera/thread>
+#include <etl/algorithm.h>
+#include <etl/array.h>
+#include <etl/string.h>
 #include <etl/vector.h>
+#include <atomic>
 
 
 namespace Aurora::FileSystem::FatFs
 {
+  /*---------------------------------------------------------------------------
+  Aliases
+  ---------------------------------------------------------------------------*/
+  namespace AM = Aurora::Memory;
+
+  /**
+   * @brief Path with the "N:" drive prefix FatFS uses to pick a volume
+   */
+  using DrivePath = etl::string<MAX_FILE_NAME_LEN + 2>;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Internal representation of a FatFS file
+   */
+  struct File
+  {
+    FileId  fileDesc; /**< Descriptor assigned to this file */
+    Volume *pVolume;  /**< Parent volume file belongs to */
+    FIL     fil;      /**< FatFS file control block */
+    bool    append;   /**< Every write goes to the end of the file */
+
+    inline void clear()
+    {
+      fileDesc = -1;
+      pVolume  = nullptr;
+      append   = false;
+      memset( &fil, 0, sizeof( fil ) );
+    }
+  };
+
   /*---------------------------------------------------------------------------
   Static Data
   ---------------------------------------------------------------------------*/
-  static Chimera::Thread::RecursiveMutex    s_lock;    /**< Module lock */
+  static uint32_t                           s_init;    /**< Initialized key */
+  static Chimera::Thread::RecursiveMutex    s_lock;    /**< Guards the volume registry. Each volume has its own lock. */
   static etl::vector<Volume *, MAX_VOLUMES> s_volumes; /**< Registered volumes */
+  static etl::array<File, MAX_OPEN_FILES>   s_files;   /**< Open files, indexed by descriptor slot */
+
+  /**
+   * @brief Attached volumes, indexed by FatFS drive number
+   *
+   * The disk_* hooks look up their volume here on every transfer, while the
+   * volume's lock is held. Reading it must not take s_lock, or a caller that
+   * holds s_lock and then waits on the volume lock would deadlock with them.
+   */
+  static etl::array<std::atomic<Volume *>, FF_VOLUMES> s_drives;
 
 
   /*---------------------------------------------------------------------------
@@ -34,13 +84,15 @@ namespace Aurora::FileSystem::FatFs
   ---------------------------------------------------------------------------*/
 
   /**
-   * @brief Finds the LFS volume structure from an ID
+   * @brief Finds the FatFS volume structure from an ID
    *
    * @param id    Which ID is associated with the volume
    * @return Volume*
    */
   static Volume *get_volume( VolumeId id )
   {
+    Chimera::Thread::LockGuard _lck( s_lock );
+
     for ( Volume *iter : s_volumes )
     {
       if ( iter->volumeID == id )
@@ -53,6 +105,70 @@ namespace Aurora::FileSystem::FatFs
   }
 
 
+  /**
+   * @brief Finds the volume FatFS knows as a physical drive number
+   *
+   * @param pdrv    Physical drive number
+   * @return Volume*
+   */
+  static Volume *get_drive( const BYTE pdrv )
+  {
+    return ( pdrv < s_drives.size() ) ? s_drives[ pdrv ].load( std::memory_order_acquire ) : nullptr;
+  }
+
+
+  /**
+   * @brief Finds the FatFS file structure from an ID
+   *
+   * @param stream  Which ID is associated with the file
+   * @return File*
+   */
+  static File *get_file( const FileId stream )
+  {
+    const size_t slot = fileSlot( stream );
+    if ( ( stream < 0 ) || ( slot >= s_files.size() ) || !s_files[ slot ].pVolume || ( s_files[ slot ].fileDesc != stream ) )
+    {
+      return nullptr;
+    }
+
+    return &s_files[ slot ];
+  }
+
+
+  /**
+   * @brief Builds the FatFS path for a file on a volume
+   *
+   * @param vol       Volume holding the file
+   * @param filename  Path within the volume, or null for the volume root
+   * @return DrivePath
+   */
+  static DrivePath drive_path( const Volume *const vol, const char *const filename )
+  {
+    DrivePath path;
+    path.push_back( static_cast<char>( '0' + vol->drive ) );
+    path.push_back( ':' );
+
+    if ( filename )
+    {
+      path.append( filename );
+    }
+
+    return path;
+  }
+
+
+  /**
+   * @brief Converts a FatFS result into the interface's return convention
+   *
+   * @param result  FatFS result
+   * @return int    0 if all ok, negative otherwise
+   */
+  static inline int to_error( const FRESULT result )
+  {
+    return -static_cast<int>( result );
+  }
+
+
   static int fs_init()
   {
     FatFs::initialize();
@@ -62,14 +178,12 @@ namespace Aurora::FileSystem::FatFs
 
   static int mount( const VolumeId drive, void *context )
   {
-    Chimera::Thread::LockGuard _lck( s_lock );
-
     /*-------------------------------------------------------------------------
     Update the drive number for the Volume object passed in. If the drive is
     already registered, this will reveal itself in the "get_volume" call.
     -------------------------------------------------------------------------*/
     RT_HARD_ASSERT( context );
-    Volume *vol    = reinterpret_cast<Volume *>( context );
+    Volume *vol   = reinterpret_cast<Volume *>( context );
     vol->volumeID = drive;
 
     vol = get_volume( drive );
@@ -78,15 +192,22 @@ namespace Aurora::FileSystem::FatFs
       return -1;
     }
 
+    Chimera::Thread::LockGuard _lck( vol->lock );
 
-    return -1;
+    /*-------------------------------------------------------------------------
+    Mount immediately so an unformatted device is reported now, rather than
+    on the first file access.
+    -------------------------------------------------------------------------*/
+    const DrivePath path   = drive_path( vol, nullptr );
+    const FRESULT   result = f_mount( &vol->fs, path.c_str(), 1 );
+
+    LOG_TRACE_IF( result != FR_OK, "Mount error: %d\r\n", result );
+    return to_error( result );
   }
 
 
   static int unmount( const VolumeId drive )
   {
-    Chimera::Thread::LockGuard _lck( s_lock );
-
     /*-------------------------------------------------------------------------
     Only attempt an unmount if the volume actually exists
     -------------------------------------------------------------------------*/
@@ -96,113 +217,310 @@ namespace Aurora::FileSystem::FatFs
       return -1;
     }
 
-    return -1;
+    Chimera::Thread::LockGuard _lck( vol->lock );
+
+    /*-------------------------------------------------------------------------
+    Perform the unmount, but don't destroy the volume registration
+    -------------------------------------------------------------------------*/
+    const DrivePath path   = drive_path( vol, nullptr );
+    const FRESULT   result = f_unmount( path.c_str() );
+
+    LOG_TRACE_IF( result != FR_OK, "Unmount error: %d\r\n", result );
+    return to_error( result );
   }
 
 
   static int fopen( const char *filename, const AccessFlags mode, const FileId stream, const VolumeId vol )
   {
-    Chimera::Thread::LockGuard _lck( s_lock );
+    /*-------------------------------------------------------------------------
+    Input Protections
+    -------------------------------------------------------------------------*/
+    if ( ( stream < 0 ) || ( fileSlot( stream ) >= s_files.size() ) )
+    {
+      return -1;
+    }
+
+    /*-------------------------------------------------------------------------
+    Nothing to do if the file already exists in the registry
+    -------------------------------------------------------------------------*/
+    File *file = get_file( stream );
+    if ( file )
+    {
+      return 0;
+    }
 
     Volume *volume = get_volume( vol );
-    RT_DBG_ASSERT( volume );
+    if ( !volume )
+    {
+      return -1;
+    }
+
+    Chimera::Thread::LockGuard _lck( volume->lock );
+
+    /*-------------------------------------------------------------------------
+    Translate the mode flags to the FatFS flags
+    -------------------------------------------------------------------------*/
+    BYTE     flags    = 0;
+    uint32_t access   = mode & O_ACCESS_MSK;
+    uint32_t modifier = mode & O_MODIFY_MSK;
+
+    switch ( access )
+    {
+      case O_RDONLY:
+        flags = FA_READ;
+        break;
+
+      case O_WRONLY:
+        flags = FA_WRITE;
+        break;
+
+      case O_RDWR:
+        flags = FA_READ | FA_WRITE;
+        break;
+
+      default:
+        return -1;
+    }
+
+    if ( ( modifier & O_CREAT ) && ( modifier & O_EXCL ) )
+    {
+      flags |= FA_CREATE_NEW;
+    }
+    else if ( ( modifier & O_CREAT ) && ( modifier & O_TRUNC ) )
+    {
+      flags |= FA_CREATE_ALWAYS;
+    }
+    else if ( modifier & O_CREAT )
+    {
+      flags |= FA_OPEN_ALWAYS;
+    }
+    else
+    {
+      flags |= FA_OPEN_EXISTING;
+    }
+
+    /*-------------------------------------------------------------------------
+    Claim the slot assigned to this descriptor
+    -------------------------------------------------------------------------*/
+    file = &s_files[ fileSlot( stream ) ];
+    if ( file->pVolume )
+    {
+      return -1;
+    }
+
+    file->clear();
 
     /*-------------------------------------------------------------------------
-    Translate the mode flags to the LFS flags
+    Open the new file. Truncating an existing file without creating one has
+    no FatFS open mode, so it's done as a separate step.
     -------------------------------------------------------------------------*/
-    // int      flags    = 0;
-    // uint32_t access   = mode & O_ACCESS_MSK;
-    // uint32_t modifier = mode & O_MODIFY_MSK;
-
-    // switch ( access )
-    // {
-    //   case O_RDONLY:
-    //     flags = LFS_O_RDONLY;
-    //     break;
-
-    //   case O_WRONLY:
-    //     flags = LFS_O_WRONLY;
-    //     break;
-
-    //   case O_RDWR:
-    //     flags = LFS_O_RDWR;
-    //     break;
-
-    //   default:
-    //     return -1;
-    // }
-
-    // if ( modifier & O_APPEND )
-    // {
-    //   flags |= LFS_O_APPEND;
-    // }
-
-    // if ( modifier & O_CREAT )
-    // {
-    //   flags |= LFS_O_CREAT;
-    // }
-
-    // if ( modifier & O_EXCL )
-    // {
-    //   flags |= LFS_O_EXCL;
-    // }
-
-    // if ( modifier & O_TRUNC )
-    // {
-    //   flags |= LFS_O_TRUNC;
-    // }
-
-
-    return -1;
+    const DrivePath path   = drive_path( volume, filename );
+    FRESULT         result = f_open( &file->fil, path.c_str(), flags );
+
+    if ( ( result == FR_OK ) && ( modifier & O_TRUNC ) && !( modifier & O_CREAT ) )
+    {
+      result = f_truncate( &file->fil );
+      if ( result != FR_OK )
+      {
+        f_close( &file->fil );
+      }
+    }
+
+    if ( result != FR_OK )
+    {
+      file->clear();
+      LOG_TRACE( "Open error: %d\r\n", result );
+      return to_error( result );
+    }
+
+    file->fileDesc = stream;
+    file->pVolume  = volume;
+    file->append   = ( modifier & O_APPEND );
+    return 0;
   }
 
 
   static int fclose( FileId stream )
   {
-    Chimera::Thread::LockGuard _lck( s_lock );
+    /*-------------------------------------------------------------------------
+    Look up the file in the registry
+    -------------------------------------------------------------------------*/
+    File *file = get_file( stream );
+    if ( !file )
+    {
+      return 0;
+    }
+
+    Chimera::Thread::LockGuard _lck( file->pVolume->lock );
+
+    /*-------------------------------------------------------------------------
+    Close the file and release the slot, even on error
+    -------------------------------------------------------------------------*/
+    const FRESULT result = f_close( &file->fil );
+    LOG_TRACE_IF( result != FR_OK, "Close error: %d\r\n", result );
 
-    return -1;
+    file->clear();
+    return to_error( result );
   }
 
 
   static int fflush( FileId stream )
   {
-    return -1;
+    /*-------------------------------------------------------------------------
+    Look up the file in the registry
+    -------------------------------------------------------------------------*/
+    File *file = get_file( stream );
+    if ( !file )
+    {
+      return 0;
+    }
+
+    Chimera::Thread::LockGuard _lck( file->pVolume->lock );
+
+    /*-------------------------------------------------------------------------
+    Perform the FatFS operation
+    -------------------------------------------------------------------------*/
+    const FRESULT result = f_sync( &file->fil );
+    LOG_TRACE_IF( result != FR_OK, "Sync error: %d\r\n", result );
+    return to_error( result );
   }
 
 
   static size_t fread( void *ptr, size_t size, size_t count, FileId stream )
   {
-    return -1;
+    /*-------------------------------------------------------------------------
+    Look up the file in the registry
+    -------------------------------------------------------------------------*/
+    File *file = get_file( stream );
+    if ( !file )
+    {
+      return 0;
+    }
+
+    Chimera::Thread::LockGuard _lck( file->pVolume->lock );
+
+    /*-------------------------------------------------------------------------
+    Perform the FatFS operation. Whole sectors in the middle of the request
+    go straight to disk_read() as one transfer.
+    -------------------------------------------------------------------------*/
+    UINT          bytes_read = 0;
+    const FRESULT result     = f_read( &file->fil, ptr, static_cast<UINT>( size * count ), &bytes_read );
+
+    LOG_TRACE_IF( result != FR_OK, "Read error: %d\r\n", result );
+    return static_cast<size_t>( bytes_read );
   }
 
 
   static size_t fwrite( const void *ptr, size_t size, size_t count, FileId stream )
   {
-    return -1;
+    /*-------------------------------------------------------------------------
+    Look up the file in the registry
+    -------------------------------------------------------------------------*/
+    File *file = get_file( stream );
+    if ( !file )
+    {
+      return 0;
+    }
+
+    Chimera::Thread::LockGuard _lck( file->pVolume->lock );
+
+    /*-------------------------------------------------------------------------
+    FatFS has no append mode that applies to every write, so emulate it
+    -------------------------------------------------------------------------*/
+    if ( file->append && ( f_lseek( &file->fil, f_size( &file->fil ) ) != FR_OK ) )
+    {
+      return 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    Perform the FatFS operation
+    -------------------------------------------------------------------------*/
+    UINT          bytes_written = 0;
+    const FRESULT result        = f_write( &file->fil, ptr, static_cast<UINT>( size * count ), &bytes_written );
+
+    LOG_TRACE_IF( result != FR_OK, "Write error: %d\r\n", result );
+    return static_cast<size_t>( bytes_written );
   }
 
 
   static int fseek( const FileId stream, const size_t offset, const WhenceFlags whence )
   {
-    return -1;
+    /*-------------------------------------------------------------------------
+    Look up the file in the registry
+    -------------------------------------------------------------------------*/
+    File *file = get_file( stream );
+    if ( !file )
+    {
+      return 0;
+    }
+
+    Chimera::Thread::LockGuard _lck( file->pVolume->lock );
+
+    /*-------------------------------------------------------------------------
+    FatFS only seeks to absolute positions
+    -------------------------------------------------------------------------*/
+    FSIZE_t position = offset;
+    switch ( whence )
+    {
+      case F_SEEK_SET:
+        break;
+
+      case F_SEEK_CUR:
+        position += f_tell( &file->fil );
+        break;
+
+      case F_SEEK_END:
+        position += f_size( &file->fil );
+        break;
+
+      default:
+        return -1;
+    }
+
+    const FRESULT result = f_lseek( &file->fil, position );
+    LOG_TRACE_IF( result != FR_OK, "Seek error: %d\r\n", result );
+    return to_error( result );
   }
 
 
   static size_t ftell( FileId stream )
   {
-    return -1;
+    File *file = get_file( stream );
+    if ( !file )
+    {
+      return 0;
+    }
+
+    Chimera::Thread::LockGuard _lck( file->pVolume->lock );
+    return static_cast<size_t>( f_tell( &file->fil ) );
   }
 
 
   static void frewind( FileId stream )
   {
+    File *file = get_file( stream );
+    if ( !file )
+    {
+      return;
+    }
+
+    Chimera::Thread::LockGuard _lck( file->pVolume->lock );
+
+    const FRESULT result = f_rewind( &file->fil );
+    LOG_TRACE_IF( result != FR_OK, "Rewind error: %d\r\n", result );
   }
 
 
   static size_t fsize( const FileId stream )
   {
-    return 0;
+    File *file = get_file( stream );
+    if ( !file )
+    {
+      return 0;
+    }
+
+    Chimera::Thread::LockGuard _lck( file->pVolume->lock );
+    return static_cast<size_t>( f_size( &file->fil ) );
   }
 
 
@@ -212,8 +530,20 @@ namespace Aurora::FileSystem::FatFs
 
   void initialize()
   {
-    s_lock.unlock();
-    s_volumes.clear();
+    if ( s_init != Chimera::DRIVER_INITIALIZED_KEY )
+    {
+      s_lock.unlock();
+      s_volumes.clear();
+      for ( auto &drive : s_drives )
+      {
+        drive.store( nullptr, std::memory_order_relaxed );
+      }
+      for ( File &f : s_files )
+      {
+        f.clear();
+      }
+      s_init = Chimera::DRIVER_INITIALIZED_KEY;
+    }
   }
 
 
@@ -245,7 +575,7 @@ namespace Aurora::FileSystem::FatFs
     /*-------------------------------------------------------------------------
     Input Protection
     -------------------------------------------------------------------------*/
-    if ( !vol || !vol->device )
+    if ( !vol || !vol->device || !vol->sectorCount || ( vol->sectorSize < FF_MIN_SS ) || ( vol->sectorSize > FF_MAX_SS ) )
     {
       return false;
     }
@@ -253,7 +583,25 @@ namespace Aurora::FileSystem::FatFs
     /*-------------------------------------------------------------------------
     Ensure we can store the new volume and it hasn't already been registered.
     -------------------------------------------------------------------------*/
-    if ( s_volumes.full() || get_volume( vol->volumeID ) )
+    FatFs::initialize();
+    Chimera::Thread::LockGuard _lck( s_lock );
+
+    if ( s_volumes.full() || ( s_volumes.size() >= FF_VOLUMES )
+         || ( etl::find( s_volumes.begin(), s_volumes.end(), vol ) != s_volumes.end() ) )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Hand out the lowest free FatFS drive number
+    -------------------------------------------------------------------------*/
+    uint8_t drive = 0;
+    while ( ( drive < s_drives.size() ) && get_drive( drive ) )
+    {
+      drive++;
+    }
+
+    if ( drive >= s_drives.size() )
     {
       return false;
     }
@@ -262,8 +610,11 @@ namespace Aurora::FileSystem::FatFs
     Initialize the volume
     -------------------------------------------------------------------------*/
     memset( &vol->fs, 0, sizeof( vol->fs ) );
+    vol->drive      = drive;
+    vol->eraseBlock = vol->eraseBlock ? vol->eraseBlock : 1;
 
     s_volumes.push_back( vol );
+    s_drives[ drive ].store( vol, std::memory_order_release );
     return true;
   }
 
@@ -273,13 +624,31 @@ namespace Aurora::FileSystem::FatFs
     /*-------------------------------------------------------------------------
     Input Protection
     -------------------------------------------------------------------------*/
-    if ( !vol )
+    if ( !vol || ( get_drive( vol->drive ) != vol ) )
     {
       return false;
     }
 
-    // TODO
+#if FF_USE_MKFS
+    /*-------------------------------------------------------------------------
+    Build a fresh filesystem. The work area is only needed for the duration of
+    the call, so one buffer is shared across all volumes and guarded on its
+    own. The disk hooks run under the volume lock, so it must be taken last.
+    -------------------------------------------------------------------------*/
+    static BYTE                            s_work[ FF_MAX_SS ];
+    static Chimera::Thread::RecursiveMutex s_work_lock;
+
+    Chimera::Thread::LockGuard _wlck( s_work_lock );
+    Chimera::Thread::LockGuard _vlck( vol->lock );
+
+    const DrivePath path   = drive_path( vol, nullptr );
+    const FRESULT   result = f_mkfs( path.c_str(), nullptr, s_work, sizeof( s_work ) );
+
+    LOG_TRACE_IF( result != FR_OK, "Format error: %d\r\n", result );
+    return result == FR_OK;
+#else
     return false;
+#endif
   }
 
 }  // namespace Aurora::FileSystem::FatFs
@@ -288,31 +657,126 @@ namespace Aurora::FileSystem::FatFs
 /*-----------------------------------------------------------------------------
 FatFS Hooks
 -----------------------------------------------------------------------------*/
+namespace FS = Aurora::FileSystem::FatFs;
+namespace AM = Aurora::Memory;
+
 extern "C" DSTATUS disk_initialize( BYTE pdrv )
 {
-  return STA_NOINIT;
+  /*---------------------------------------------------------------------------
+  The device is opened by whoever owns it, so there is nothing to bring up
+  ---------------------------------------------------------------------------*/
+  return disk_status( pdrv );
 }
 
 
 extern "C" DSTATUS disk_status( BYTE pdrv )
 {
-  return STA_NOINIT;
+  FS::Volume *vol = FS::get_drive( pdrv );
+  return ( vol && vol->device ) ? 0 : STA_NOINIT;
 }
 
 
 extern "C" DRESULT disk_read( BYTE pdrv, BYTE *buff, LBA_t sector, UINT count )
 {
-  return RES_PARERR;
+  /*---------------------------------------------------------------------------
+  Input Protection
+  ---------------------------------------------------------------------------*/
+  FS::Volume *vol = FS::get_drive( pdrv );
+  if ( !vol || !buff || !count || ( ( sector + count ) > vol->sectorCount ) )
+  {
+    return RES_PARERR;
+  }
+
+  /*---------------------------------------------------------------------------
+  Pass the whole run of sectors through as a single transfer
+  ---------------------------------------------------------------------------*/
+  const size_t address = static_cast<size_t>( sector ) * vol->sectorSize;
+  const size_t length  = static_cast<size_t>( count ) * vol->sectorSize;
+
+  auto result = vol->device->read( address, buff, length );
+  LOG_TRACE_IF( result != AM::Status::ERR_OK, "Disk read error: %d\r\n", result );
+  return ( result == AM::Status::ERR_OK ) ? RES_OK : RES_ERROR;
 }
 
 
 extern "C" DRESULT disk_write( BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count )
 {
-  return RES_PARERR;
+  /*---------------------------------------------------------------------------
+  Input Protection
+  ---------------------------------------------------------------------------*/
+  FS::Volume *vol = FS::get_drive( pdrv );
+  if ( !vol || !buff || !count || ( ( sector + count ) > vol->sectorCount ) )
+  {
+    return RES_PARERR;
+  }
+
+  /*---------------------------------------------------------------------------
+  Pass the whole run of sectors through as a single transfer
+  ---------------------------------------------------------------------------*/
+  const size_t address = static_cast<size_t>( sector ) * vol->sectorSize;
+  const size_t length  = static_cast<size_t>( count ) * vol->sectorSize;
+
+  auto result = vol->device->write( address, buff, length );
+  if ( result == AM::Status::ERR_OK )
+  {
+    result = vol->device->pendEvent( AM::Event::MEM_WRITE_COMPLETE, Chimera::Thread::TIMEOUT_BLOCK );
+  }
+
+  LOG_TRACE_IF( result != AM::Status::ERR_OK, "Disk write error: %d\r\n", result );
+  return ( result == AM::Status::ERR_OK ) ? RES_OK : RES_ERROR;
 }
 
 
 extern "C" DRESULT disk_ioctl( BYTE pdrv, BYTE cmd, void *buff )
 {
-  return RES_PARERR;
+  FS::Volume *vol = FS::get_drive( pdrv );
+  if ( !vol )
+  {
+    return RES_PARERR;
+  }
+
+  switch ( cmd )
+  {
+    case CTRL_SYNC:
+      return ( vol->device->flush() == AM::Status::ERR_OK ) ? RES_OK : RES_ERROR;
+
+    case GET_SECTOR_COUNT:
+      *reinterpret_cast<LBA_t *>( buff ) = static_cast<LBA_t>( vol->sectorCount );
+      return RES_OK;
+
+    case GET_SECTOR_SIZE:
+      *reinterpret_cast<WORD *>( buff ) = static_cast<WORD>( vol->sectorSize );
+      return RES_OK;
+
+    case GET_BLOCK_SIZE:
+      *reinterpret_cast<DWORD *>( buff ) = static_cast<DWORD>( vol->eraseBlock );
+      return RES_OK;
+
+    case CTRL_TRIM: {
+      /*-----------------------------------------------------------------------
+      Only whole erase blocks inside the range can be released. Partial blocks
+      still hold live sectors, and trimming is just a hint anyways.
+      -----------------------------------------------------------------------*/
+      const LBA_t *range = reinterpret_cast<const LBA_t *>( buff );
+      const size_t first = ( static_cast<size_t>( range[ 0 ] ) + vol->eraseBlock - 1 ) / vol->eraseBlock;
+      const size_t last  = ( static_cast<size_t>( range[ 1 ] ) + 1 ) / vol->eraseBlock;
+
+      if ( first >= last )
+      {
+        return RES_OK;
+      }
+
+      const size_t blockBytes = vol->eraseBlock * vol->sectorSize;
+      auto result = vol->device->erase( first * blockBytes, ( last - first ) * blockBytes );
+      if ( result == AM::Status::ERR_OK )
+      {
+        result = vol->device->pendEvent( AM::Event::MEM_ERASE_COMPLETE, Chimera::Thread::TIMEOUT_BLOCK );
+      }
+
+      return ( result == AM::Status::ERR_OK ) ? RES_OK : RES_ERROR;
+    }
+
+    default:
+      return RES_PARERR;
+  }
 }
@@ -33,10 +33,14 @@ namespace Aurora::FileSystem::FatFs
    */
   struct Volume
   {
-    FATFS                           fs;       /**< Core memory to manage a full filesystem */
-    Aurora::Memory::IGenericDevice *device;   /**< Memory device to use for storage */
-    VolumeId                        volumeID; /**< Mapped volume ID */
-    Chimera::Thread::RecursiveMutex lock;     /**< Multi-threaded access protection */
+    FATFS                           fs;          /**< Core memory to manage a full filesystem */
+    Aurora::Memory::IGenericDevice *device;      /**< Memory device to use for storage */
+    VolumeId                        volumeID;    /**< Mapped volume ID */
+    Chimera::Thread::RecursiveMutex lock;        /**< Multi-threaded access protection */
+    size_t                          sectorSize;  /**< Bytes per sector, between FF_MIN_SS and FF_MAX_SS */
+    size_t                          sectorCount; /**< Number of sectors on the device */
+    size_t                          eraseBlock;  /**< Sectors per erase block, or 1 if unknown */
+    uint8_t                         drive;       /**< FatFS physical drive number, assigned on attach */
   };
 
 
@@ -0,0 +1,42 @@
+/******************************************************************************
+ *  File Name:
+ *    fatfs_tests.hpp
+ *
+ *  Description:
+ *    Host tests for the FatFS driver
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_FILESYSTEM_FATFS_TESTS_HPP
+#define AURORA_FILESYSTEM_FATFS_TESTS_HPP
+
+#if defined( SIMULATOR )
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/filesystem/fatfs/fatfs_driver.hpp>
+#include <filesystem>
+
+namespace Aurora::FileSystem::FatFs::Test
+{
+  namespace FileDevice
+  {
+    /**
+     * @brief Formats and mounts a volume stored in a host file, writes a file
+     * to it, then remounts and reads the file back.
+     *
+     * Mounts the volume at "/" through the Aurora file system API, so nothing
+     * else may be mounted there while it runs.
+     *
+     * @param image   Host file to hold the disk image. Its contents are lost.
+     * @return int    0 if all ok, negative otherwise
+     */
+    int mount_write_read( const std::filesystem::path &image );
+  }  // namespace FileDevice
+}  // namespace Aurora::FileSystem::FatFs::Test
+
+#endif /* SIMULATOR */
+#endif /* !AURORA_FILESYSTEM_FATFS_TESTS_HPP */
@@ -0,0 +1,128 @@
+/******************************************************************************
+ *  File Name:
+ *    test_file_device.cpp
+ *
+ *  Description:
+ *    Host test running the FatFS driver on a file backed device
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#if defined( SIMULATOR )
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/filesystem>
+#include <Aurora/memory>
+#include <cstring>
+
+namespace Aurora::FileSystem::FatFs::Test::FileDevice
+{
+  int mount_write_read( const std::filesystem::path &image )
+  {
+    namespace AM = Aurora::Memory;
+
+    /*-------------------------------------------------------------------------
+    Config Constants
+    -------------------------------------------------------------------------*/
+    static constexpr size_t SECTOR_SIZE  = 512;
+    static constexpr size_t SECTOR_COUNT = 4096;
+    static constexpr size_t DATA_SIZE    = ( 3 * SECTOR_SIZE ) + 17; /* Spans sectors, ends mid sector */
+    static constexpr char   FILE_NAME[]  = "/round_trip.bin";
+
+    /*-------------------------------------------------------------------------
+    Volumes can't be detached, so the device and volume live on between runs
+    -------------------------------------------------------------------------*/
+    static AM::FileDevice device;
+    static Volume         volume;
+    static bool           attached = false;
+    static uint8_t        written[ DATA_SIZE ];
+    static uint8_t        readback[ DATA_SIZE ];
+
+    int    result = 0;
+    FileId file   = -1;
+
+    /*-------------------------------------------------------------------------
+    Start from a fresh image
+    -------------------------------------------------------------------------*/
+    const AM::DeviceAttr attr = { SECTOR_SIZE, SECTOR_SIZE, SECTOR_SIZE };
+
+    device.close();
+    std::filesystem::remove( image );
+    device.configure( image, SECTOR_SIZE * SECTOR_COUNT );
+    if ( device.open( &attr ) != AM::Status::ERR_OK )
+    {
+      return -1;
+    }
+
+    if ( !attached )
+    {
+      volume.device      = &device;
+      volume.volumeID    = -1;
+      volume.sectorSize  = SECTOR_SIZE;
+      volume.sectorCount = SECTOR_COUNT;
+      volume.eraseBlock  = 1;
+
+      attached = attachVolume( &volume );
+      if ( !attached )
+      {
+        return -1;
+      }
+    }
+
+    if ( !formatVolume( &volume ) )
+    {
+      return -1;
+    }
+
+    /*-------------------------------------------------------------------------
+    Write a pattern that differs in every byte of a sector
+    -------------------------------------------------------------------------*/
+    for ( size_t i = 0; i < DATA_SIZE; i++ )
+    {
+      written[ i ] = static_cast<uint8_t>( ( i * 7u ) + ( i / SECTOR_SIZE ) );
+    }
+
+    Interface intf = getInterface( &volume );
+    Aurora::FileSystem::initialize();
+
+    VolumeId mounted = Aurora::FileSystem::mount( "/", intf );
+    if ( mounted < 0 )
+    {
+      return -1;
+    }
+
+    result |= Aurora::FileSystem::fopen( FILE_NAME, O_RDWR | O_CREAT | O_TRUNC, file );
+    if ( Aurora::FileSystem::fwrite( written, 1, DATA_SIZE, file ) != DATA_SIZE )
+    {
+      result |= -1;
+    }
+    result |= Aurora::FileSystem::fclose( file );
+    Aurora::FileSystem::unmount( mounted );
+
+    /*-------------------------------------------------------------------------
+    Read it back through a fresh mount so nothing comes from cached state
+    -------------------------------------------------------------------------*/
+    mounted = Aurora::FileSystem::mount( "/", intf );
+    if ( mounted < 0 )
+    {
+      return -1;
+    }
+
+    memset( readback, 0, sizeof( readback ) );
+    result |= Aurora::FileSystem::fopen( FILE_NAME, O_RDONLY, file );
+    if ( ( Aurora::FileSystem::fsize( file ) != DATA_SIZE )
+         || ( Aurora::FileSystem::fread( readback, 1, DATA_SIZE, file ) != DATA_SIZE )
+         || ( memcmp( written, readback, DATA_SIZE ) != 0 ) )
+    {
+      result |= -1;
+    }
+    result |= Aurora::FileSystem::fclose( file );
+    Aurora::FileSystem::unmount( mounted );
+
+    return ( result == 0 ) ? 0 : -1;
+  }
+}  // namespace Aurora::FileSystem::FatFs::Test::FileDevice
+
+#endif /* SIMULATOR */
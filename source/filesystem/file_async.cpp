@@ -0,0 +1,376 @@
+/******************************************************************************
+ *  File Name:
+ *    file_async.cpp
+ *
+ *  Description:
+ *    Asynchronous file operation implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/filesystem>
+#include <Chimera/assert>
+#include <Chimera/common>
+#include <Chimera/thread>
+#include <algorithm>
+#include <etl/array.h>
+
+namespace Aurora::FileSystem
+{
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static Chimera::Thread::RecursiveMutex        s_lock;    /**< Guards the worker registry */
+  static etl::array<AsyncWorker *, MAX_VOLUMES> s_workers; /**< Attached workers, one per volume */
+
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Wakes any waiter, marks the request DONE, then runs its callback
+   *
+   * The waiter is signaled first since the request may be released as soon
+   * as it reads DONE. The callback is copied out for the same reason, in case
+   * the owner resubmits the request with a different one.
+   *
+   * @param request   Request that finished
+   */
+  static void finish( AsyncRequest &request )
+  {
+    const AsyncCallback callback = request.callback;
+
+    request.signal.release();
+    request.state = AsyncState::DONE;
+
+    if ( callback.is_valid() )
+    {
+      callback( request );
+    }
+  }
+
+
+  /**
+   * @brief Runs a request against the synchronous API and reports completion
+   *
+   * @param request   Request to run
+   */
+  static void execute( AsyncRequest &request )
+  {
+    request.state = AsyncState::BUSY;
+
+    switch ( request.op )
+    {
+      case AsyncOp::READ:
+        request.result = fread( request.data, request.size, request.count, request.stream );
+        request.status = ( request.result == ( request.size * request.count ) ) ? 0 : -1;
+        break;
+
+      case AsyncOp::WRITE:
+        request.result = fwrite( request.data, request.size, request.count, request.stream );
+        request.status = ( request.result == ( request.size * request.count ) ) ? 0 : -1;
+        break;
+
+      case AsyncOp::FLUSH:
+        request.result = 0;
+        request.status = fflush( request.stream );
+        break;
+
+      default:
+        request.result = 0;
+        request.status = -1;
+        break;
+    }
+
+    finish( request );
+  }
+
+
+  /**
+   * @brief Completes a request that will never run
+   *
+   * @param request   Request to fail
+   */
+  static void cancel( AsyncRequest &request )
+  {
+    request.result = 0;
+    request.status = -1;
+    finish( request );
+  }
+
+
+  /**
+   * @brief Fills in a request and hands it to the worker of its file's volume
+   *
+   * @param request   Request to fill in
+   * @param op        Operation to perform
+   * @param stream    File to operate on
+   * @param data      Read destination or write source
+   * @param size      Size of each item in bytes
+   * @param count     Number of items
+   * @param callback  Optional completion notification
+   * @return bool
+   */
+  static bool enqueue( AsyncRequest &request, const AsyncOp op, const FileId stream, void *const data, const size_t size,
+                       const size_t count, AsyncCallback &callback )
+  {
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( !request.complete() || ( ( op != AsyncOp::FLUSH ) && !data ) )
+    {
+      return false;
+    }
+
+    const VolumeId volume = fvolume( stream );
+    if ( volume < 0 )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Build the request
+    -------------------------------------------------------------------------*/
+    request.op       = op;
+    request.stream   = stream;
+    request.data     = data;
+    request.size     = size;
+    request.count    = count;
+    request.callback = callback;
+    request.result   = 0;
+    request.status   = 0;
+
+    /*-------------------------------------------------------------------------
+    Queue it. The registry stays locked so the worker can't detach under us.
+    -------------------------------------------------------------------------*/
+    Chimera::Thread::LockGuard _lck( s_lock );
+
+    for ( AsyncWorker *worker : s_workers )
+    {
+      if ( worker && ( worker->volume() == volume ) )
+      {
+        return worker->submit( request );
+      }
+    }
+
+    return false;
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Class Implementation
+  ---------------------------------------------------------------------------*/
+  AsyncWorker::AsyncWorker() : mVolume( -1 ), mHead( nullptr ), mTail( nullptr )
+  {
+  }
+
+
+  AsyncWorker::~AsyncWorker()
+  {
+    detach();
+  }
+
+
+  bool AsyncWorker::attach( const VolumeId volume )
+  {
+    Chimera::Thread::LockGuard _lck( s_lock );
+
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( ( volume < 0 ) || ( mVolume >= 0 ) )
+    {
+      return false;
+    }
+
+    for ( AsyncWorker *worker : s_workers )
+    {
+      if ( worker && ( worker->mVolume == volume ) )
+      {
+        return false;
+      }
+    }
+
+    /*-------------------------------------------------------------------------
+    Take a free registry slot
+    -------------------------------------------------------------------------*/
+    for ( AsyncWorker *&slot : s_workers )
+    {
+      if ( !slot )
+      {
+        slot    = this;
+        mVolume = volume;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+
+  void AsyncWorker::detach()
+  {
+    /*-------------------------------------------------------------------------
+    Stop accepting new requests
+    -------------------------------------------------------------------------*/
+    {
+      Chimera::Thread::LockGuard _lck( s_lock );
+
+      for ( AsyncWorker *&slot : s_workers )
+      {
+        if ( slot == this )
+        {
+          slot = nullptr;
+        }
+      }
+
+      mVolume = -1;
+    }
+
+    /*-------------------------------------------------------------------------
+    Release anyone still waiting on the old queue
+    -------------------------------------------------------------------------*/
+    while ( AsyncRequest *request = pop() )
+    {
+      cancel( *request );
+    }
+  }
+
+
+  VolumeId AsyncWorker::volume() const
+  {
+    return mVolume;
+  }
+
+
+  bool AsyncWorker::submit( AsyncRequest &request )
+  {
+    Chimera::Thread::LockGuard _lck( mLock );
+
+    if ( mVolume < 0 )
+    {
+      return false;
+    }
+
+    request.next  = nullptr;
+    request.state = AsyncState::QUEUED;
+
+    if ( mTail )
+    {
+      mTail->next = &request;
+    }
+    else
+    {
+      mHead = &request;
+    }
+
+    mTail = &request;
+    mPending.release();
+    return true;
+  }
+
+
+  size_t AsyncWorker::process( const size_t limit )
+  {
+    size_t count = 0;
+
+    while ( count < limit )
+    {
+      AsyncRequest *request = pop();
+      if ( !request )
+      {
+        break;
+      }
+
+      execute( *request );
+      count++;
+    }
+
+    return count;
+  }
+
+
+  void AsyncWorker::workerThread( void *arg )
+  {
+    AsyncWorker *const worker = reinterpret_cast<AsyncWorker *>( arg );
+    RT_HARD_ASSERT( worker );
+
+    while ( true )
+    {
+      if ( !worker->process( MAX_OPEN_FILES ) )
+      {
+        worker->mPending.try_acquire_for( AURORA_PRJ_FS_ASYNC_POLL_PERIOD_MS );
+      }
+    }
+  }
+
+
+  /**
+   * @brief Removes the oldest request from the queue
+   * @return AsyncRequest*    Null if the queue is empty
+   */
+  AsyncRequest *AsyncWorker::pop()
+  {
+    Chimera::Thread::LockGuard _lck( mLock );
+
+    AsyncRequest *request = mHead;
+    if ( request )
+    {
+      mHead         = request->next;
+      mTail         = mHead ? mTail : nullptr;
+      request->next = nullptr;
+    }
+
+    return request;
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  bool fread_async( void *const ptr, const size_t size, const size_t count, const FileId stream, AsyncRequest &request,
+                    AsyncCallback callback )
+  {
+    return enqueue( request, AsyncOp::READ, stream, ptr, size, count, callback );
+  }
+
+
+  bool fwrite_async( const void *const ptr, const size_t size, const size_t count, const FileId stream,
+                     AsyncRequest &request, AsyncCallback callback )
+  {
+    return enqueue( request, AsyncOp::WRITE, stream, const_cast<void *>( ptr ), size, count, callback );
+  }
+
+
+  bool fflush_async( const FileId stream, AsyncRequest &request, AsyncCallback callback )
+  {
+    return enqueue( request, AsyncOp::FLUSH, stream, nullptr, 0, 0, callback );
+  }
+
+
+  bool fwait_async( const AsyncRequest &request, const size_t timeout )
+  {
+    const size_t start = Chimera::millis();
+
+    /*-------------------------------------------------------------------------
+    The signal is only a wakeup. It may be left over from a completion nobody
+    waited on, or arrive just before the state changes, so the state is the
+    final word and no single wait lasts longer than a poll period.
+    -------------------------------------------------------------------------*/
+    while ( !request.complete() )
+    {
+      const size_t elapsed = Chimera::millis() - start;
+      if ( elapsed >= timeout )
+      {
+        return false;
+      }
+
+      request.signal.try_acquire_for( std::min<size_t>( timeout - elapsed, AURORA_PRJ_FS_ASYNC_POLL_PERIOD_MS ) );
+    }
+
+    return true;
+  }
+}  // namespace Aurora::FileSystem
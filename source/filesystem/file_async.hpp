@@ -0,0 +1,236 @@
+/******************************************************************************
+ *  File Name:
+ *    file_async.hpp
+ *
+ *  Description:
+ *    Asynchronous file operations serviced by per-volume worker threads
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_FILESYSTEM_ASYNC_HPP
+#define AURORA_FILESYSTEM_ASYNC_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/filesystem/file_types.hpp>
+#include <Chimera/thread>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <etl/delegate.h>
+
+/*-----------------------------------------------------------------------------
+Literal Constants
+-----------------------------------------------------------------------------*/
+#if !defined( AURORA_PRJ_FS_ASYNC_POLL_PERIOD_MS )
+#define AURORA_PRJ_FS_ASYNC_POLL_PERIOD_MS ( 5 )
+#endif
+
+namespace Aurora::FileSystem
+{
+  /*---------------------------------------------------------------------------
+  Forward Declarations
+  ---------------------------------------------------------------------------*/
+  struct AsyncRequest;
+
+  /*---------------------------------------------------------------------------
+  Aliases
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Completion notification, invoked from the volume's worker thread
+   *
+   * The request is already DONE when this runs, so the callback may resubmit
+   * it to chain operations.
+   */
+  using AsyncCallback = etl::delegate<void( AsyncRequest & )>;
+
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  enum class AsyncOp : uint8_t
+  {
+    READ,
+    WRITE,
+    FLUSH
+  };
+
+  enum class AsyncState : uint8_t
+  {
+    IDLE,    /**< Never submitted */
+    QUEUED,  /**< Waiting for the worker */
+    BUSY,    /**< Worker is executing it */
+    DONE     /**< Finished, results are valid */
+  };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief A single queued operation, doubling as its own completion handle
+   *
+   * The caller owns the memory, so queuing never allocates. It, and any data
+   * buffer it references, must stay valid until the request is DONE and its
+   * callback, if any, has returned.
+   */
+  struct AsyncRequest
+  {
+    AsyncOp       op;       /**< Operation to perform */
+    FileId        stream;   /**< File to operate on */
+    void         *data;     /**< Read destination or write source */
+    size_t        size;     /**< Size of each item in bytes */
+    size_t        count;    /**< Number of items */
+    AsyncCallback callback; /**< Optional completion notification */
+    size_t        result;   /**< Bytes transferred once DONE */
+    int           status;   /**< 0 if the operation fully succeeded, negative otherwise */
+
+    std::atomic<AsyncState>                 state;  /**< Progress through the queue */
+    AsyncRequest                           *next;   /**< Queue link, owned by the worker */
+    mutable Chimera::Thread::BinarySemaphore signal; /**< Released each time the request completes */
+
+    AsyncRequest() : op( AsyncOp::FLUSH ), stream( -1 ), data( nullptr ), size( 0 ), count( 0 ), result( 0 ),
+                     status( 0 ), state( AsyncState::IDLE ), next( nullptr )
+    {
+    }
+
+    /**
+     * @brief Checks if the request may be (re)submitted or its results read
+     * @return bool
+     */
+    bool complete() const
+    {
+      const AsyncState now = state.load();
+      return ( now == AsyncState::IDLE ) || ( now == AsyncState::DONE );
+    }
+  };
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Executes the queued requests for one volume
+   *
+   * Requests for a volume run one at a time in submission order, so writes to
+   * the same file land in the order they were queued. Each volume gets its own
+   * worker, so a slow device only holds up its own requests.
+   *
+   * Create one per volume, attach() it, then run workerThread() in a thread
+   * of your choosing, or call process() from an existing loop.
+   */
+  class AsyncWorker
+  {
+  public:
+    AsyncWorker();
+    ~AsyncWorker();
+
+    /**
+     * @brief Registers the worker as the handler of a volume's requests
+     *
+     * @param volume    Mounted volume to service
+     * @return bool     False if the volume already has a worker or none are free
+     */
+    bool attach( const VolumeId volume );
+
+    /**
+     * @brief Unregisters the worker. Anything still queued completes with an error.
+     */
+    void detach();
+
+    /**
+     * @brief Gets the volume being serviced
+     * @return VolumeId   Negative if detached
+     */
+    VolumeId volume() const;
+
+    /**
+     * @brief Adds a request to the end of the queue
+     *
+     * The stream isn't checked against the serviced volume, that's up to the
+     * caller. fread_async() and friends route each request to the right one.
+     *
+     * @param request   Request to run
+     * @return bool
+     */
+    bool submit( AsyncRequest &request );
+
+    /**
+     * @brief Executes queued requests from the calling context
+     *
+     * @param limit     Max number of requests to execute
+     * @return size_t   Number of requests executed
+     */
+    size_t process( const size_t limit );
+
+    /**
+     * @brief Thread entry point that services a single AsyncWorker forever
+     *
+     * @param arg       Pointer to the AsyncWorker to service
+     */
+    static void workerThread( void *arg );
+
+  private:
+    VolumeId                         mVolume;  /**< Volume being serviced, negative if detached */
+    AsyncRequest                    *mHead;    /**< Next request to run */
+    AsyncRequest                    *mTail;    /**< Last request queued */
+    Chimera::Thread::RecursiveMutex  mLock;    /**< Guards the queue links */
+    Chimera::Thread::BinarySemaphore mPending; /**< Wakes the worker thread on submit */
+
+    AsyncRequest *pop();
+  };
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Queues a read on the worker of the stream's volume
+   *
+   * @param ptr       Output storage, which must stay valid until completion
+   * @param size      Size of each item in bytes
+   * @param count     Number of items to read
+   * @param stream    Stream to act on
+   * @param request   Storage for the request. Must not already be pending.
+   * @param callback  Optional completion notification
+   * @return bool     True if the request was queued
+   */
+  bool fread_async( void *const ptr, const size_t size, const size_t count, const FileId stream, AsyncRequest &request,
+                    AsyncCallback callback = AsyncCallback() );
+
+  /**
+   * @brief Queues a write on the worker of the stream's volume
+   *
+   * @param ptr       Data to write, which must stay valid until completion
+   * @param size      Size of each item in bytes
+   * @param count     Number of items to write
+   * @param stream    Stream to act on
+   * @param request   Storage for the request. Must not already be pending.
+   * @param callback  Optional completion notification
+   * @return bool     True if the request was queued
+   */
+  bool fwrite_async( const void *const ptr, const size_t size, const size_t count, const FileId stream,
+                     AsyncRequest &request, AsyncCallback callback = AsyncCallback() );
+
+  /**
+   * @brief Queues a flush behind any reads/writes already pending on the volume
+   *
+   * @param stream    Stream to act on
+   * @param request   Storage for the request. Must not already be pending.
+   * @param callback  Optional completion notification
+   * @return bool     True if the request was queued
+   */
+  bool fflush_async( const FileId stream, AsyncRequest &request, AsyncCallback callback = AsyncCallback() );
+
+  /**
+   * @brief Blocks until a request completes. Only one thread may wait on a
+   * given request at a time.
+   *
+   * @param request   Request to wait on
+   * @param timeout   Max time to wait in milliseconds
+   * @return bool     True if the request completed
+   */
+  bool fwait_async( const AsyncRequest &request, const size_t timeout );
+
+}  // namespace Aurora::FileSystem
+
+#endif /* !AURORA_FILESYSTEM_ASYNC_HPP */
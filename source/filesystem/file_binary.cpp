@@ -5,7 +5,7 @@
  *  Description:
  *    Implementation of a binary file overlay to the Aurora core filesystem.
  *
- *  2021-2022 | Brandon Braun | brandonbraun653@gmail.com
+ *  2021-2023 | Brandon Braun | brandonbraun653@gmail.com
  *****************************************************************************/
 
 /*-----------------------------------------------------------------------------
@@ -13,14 +13,16 @@ Includes
 -----------------------------------------------------------------------------*/
 #include <Aurora/filesystem>
 #include <Chimera/common>
+#include <etl/algorithm.h>
 #include <etl/crc32.h>
+#include <limits>
 
 namespace Aurora::FileSystem
 {
   /*---------------------------------------------------------------------------
   Binary File
   ---------------------------------------------------------------------------*/
-  BinaryFile::BinaryFile() : mIsOpen( false ), mFileId( -1 ), mError( ERR_OK )
+  BinaryFile::BinaryFile() : mIsOpen( false ), mFileId( -1 ), mError( ERR_OK ), mStream( Stream::NONE ), mStreamPos( 0 )
   {
   }
 
@@ -33,7 +35,15 @@ namespace Aurora::FileSystem
 
   bool BinaryFile::open( const std::string_view &filename, const AccessFlags mode )
   {
-    return fopen( filename.data(), mode, mFileId ) == 0;
+    this->close();
+
+    mIsOpen = ( fopen( filename.data(), mode, mFileId ) == 0 );
+    if ( !mIsOpen )
+    {
+      mError = this->ERR_NO_FILE;
+    }
+
+    return mIsOpen;
   }
 
 
@@ -42,9 +52,11 @@ namespace Aurora::FileSystem
     if ( mIsOpen )
     {
       fclose( mFileId );
-      mFileId = {};
+      mFileId = -1;
       mIsOpen = false;
     }
+
+    mStream = Stream::NONE;
   }
 
 
@@ -90,20 +102,22 @@ namespace Aurora::FileSystem
     /*-------------------------------------------------------------------------
     Validate the CRC
     -------------------------------------------------------------------------*/
-    /* Calculate the CRC boundaries */
-    auto userData     = reinterpret_cast<const uint8_t *const>( buffer );
-    uint8_t *metaAddr = reinterpret_cast<uint8_t *>( &meta );
-    uint8_t *start    = metaAddr + offsetof( BinaryFile::LogStruct, version );
-    uint8_t *end      = metaAddr + offsetof( BinaryFile::LogStruct, timestamp ) + sizeof( BinaryFile::LogStruct::timestamp );
-
     /* Calculate the CRC over the structure and user data */
+    auto       userData = reinterpret_cast<const uint8_t *const>( buffer );
     etl::crc32 crc;
     crc.reset();
-    crc.add( start, end );
+    addMetaCrc( crc, meta );
     crc.add( userData, userData + size );
 
+    uint32_t stored_crc = 0;
+    if ( !readStoredCrc( meta, stored_crc ) )
+    {
+      mError = this->ERR_READ_FAIL;
+      return false;
+    }
+
     uint32_t calc_crc = crc.value();
-    if ( meta.crc != calc_crc )
+    if ( stored_crc != calc_crc )
     {
       mError = this->ERR_CRC_FAIL;
       return false;
@@ -136,16 +150,11 @@ namespace Aurora::FileSystem
     entry.timestamp = Chimera::millis();
     entry.file_size = size;
 
-    /* Calculate the CRC boundaries */
-    auto userData      = reinterpret_cast<const uint8_t *const>( buffer );
-    uint8_t *entryAddr = reinterpret_cast<uint8_t *>( &entry );
-    uint8_t *start     = entryAddr + offsetof( BinaryFile::LogStruct, version );
-    uint8_t *end       = entryAddr + offsetof( BinaryFile::LogStruct, timestamp ) + sizeof( BinaryFile::LogStruct::timestamp );
-
     /* Calculate the CRC over the structure and user data */
+    auto       userData = reinterpret_cast<const uint8_t *const>( buffer );
     etl::crc32 crc;
     crc.reset();
-    crc.add( start, end );
+    addMetaCrc( crc, entry );
     crc.add( userData, userData + size );
 
     /* Update entry's notion of the CRC */
@@ -172,6 +181,247 @@ namespace Aurora::FileSystem
   }
 
 
+  bool BinaryFile::beginRead( size_t *const size )
+  {
+    /*-------------------------------------------------------------------------
+    Input protection
+    -------------------------------------------------------------------------*/
+    if ( !mIsOpen )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Read out the file metadata and seed the CRC with it
+    -------------------------------------------------------------------------*/
+    mStream = Stream::NONE;
+
+    auto metaReadSize = fread( &mMeta, 1, sizeof( BinaryFile::LogStruct ), mFileId );
+    if ( metaReadSize != sizeof( BinaryFile::LogStruct ) )
+    {
+      return failStream( this->ERR_READ_FAIL );
+    }
+
+    mCrc.reset();
+    addMetaCrc( mCrc, mMeta );
+    mStreamPos = 0;
+    mStream    = Stream::READING;
+
+    if ( size )
+    {
+      *size = mMeta.file_size;
+    }
+
+    return true;
+  }
+
+
+  size_t BinaryFile::readChunk( void *const buffer, const size_t size )
+  {
+    /*-------------------------------------------------------------------------
+    Input protection
+    -------------------------------------------------------------------------*/
+    if ( mStream != Stream::READING )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return 0;
+    }
+    else if ( !buffer )
+    {
+      mError = this->ERR_BAD_ARG;
+      return 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    Never read past the payload into whatever follows it
+    -------------------------------------------------------------------------*/
+    const size_t request = etl::min<size_t>( size, mMeta.file_size - mStreamPos );
+    if ( !request )
+    {
+      return 0;
+    }
+
+    auto dataReadSize = fread( buffer, 1, request, mFileId );
+    auto userData     = reinterpret_cast<const uint8_t *const>( buffer );
+
+    mCrc.add( userData, userData + dataReadSize );
+    mStreamPos += dataReadSize;
+
+    if ( dataReadSize != request )
+    {
+      failStream( this->ERR_READ_FAIL );
+    }
+
+    return dataReadSize;
+  }
+
+
+  bool BinaryFile::endRead()
+  {
+    if ( mStream != Stream::READING )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Run any unread payload through the CRC. A failed read ends the stream and
+    leaves its error in place.
+    -------------------------------------------------------------------------*/
+    uint8_t scratch[ AURORA_PRJ_FS_BINARY_CHUNK_SIZE ];
+    while ( mStreamPos < mMeta.file_size )
+    {
+      if ( !readChunk( scratch, sizeof( scratch ) ) || ( mStream != Stream::READING ) )
+      {
+        return false;
+      }
+    }
+
+    mStream = Stream::NONE;
+
+    uint32_t stored_crc = 0;
+    if ( !readStoredCrc( mMeta, stored_crc ) )
+    {
+      mError = this->ERR_READ_FAIL;
+      return false;
+    }
+
+    if ( mCrc.value() != stored_crc )
+    {
+      mError = this->ERR_CRC_FAIL;
+      return false;
+    }
+
+    return true;
+  }
+
+
+  bool BinaryFile::verify()
+  {
+    if ( !mIsOpen )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return false;
+    }
+
+    frewind( mFileId );
+    const bool valid = beginRead() && endRead();
+    frewind( mFileId );
+
+    return valid;
+  }
+
+
+  bool BinaryFile::beginWrite( const size_t size )
+  {
+    /*-------------------------------------------------------------------------
+    Input protection
+    -------------------------------------------------------------------------*/
+    if ( !size || ( size > std::numeric_limits<uint32_t>::max() ) )
+    {
+      mError = this->ERR_BAD_ARG;
+      return false;
+    }
+    else if ( !mIsOpen )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Fill in everything but the CRC, which depends on data not yet seen. It
+    gets written after the payload instead, so the file is only ever appended.
+    -------------------------------------------------------------------------*/
+    BinaryFile::LogStruct entry( BinaryFile::LogStruct::TrailerCrcVersion );
+    entry.file_size = static_cast<uint32_t>( size );
+    entry.timestamp = Chimera::millis();
+
+    mStream = Stream::NONE;
+
+    auto entryWriteSize = fwrite( &entry, 1, sizeof( entry ), mFileId );
+    if ( entryWriteSize != sizeof( entry ) )
+    {
+      return failStream( this->ERR_WRITE_FAIL );
+    }
+
+    mCrc.reset();
+    addMetaCrc( mCrc, entry );
+    mMeta.file_size = entry.file_size;
+    mStreamPos      = 0;
+    mStream    = Stream::WRITING;
+    return true;
+  }
+
+
+  bool BinaryFile::writeChunk( const void *const buffer, const size_t size )
+  {
+    /*-------------------------------------------------------------------------
+    Input protection
+    -------------------------------------------------------------------------*/
+    if ( mStream != Stream::WRITING )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return false;
+    }
+    else if ( !buffer || !size )
+    {
+      mError = this->ERR_BAD_ARG;
+      return false;
+    }
+    else if ( size > ( mMeta.file_size - mStreamPos ) )
+    {
+      return failStream( this->ERR_SIZING );
+    }
+
+    /*-------------------------------------------------------------------------
+    Write the data and fold it into the CRC
+    -------------------------------------------------------------------------*/
+    auto dataWriteSize = fwrite( buffer, 1, size, mFileId );
+    auto userData      = reinterpret_cast<const uint8_t *const>( buffer );
+
+    mCrc.add( userData, userData + dataWriteSize );
+    mStreamPos += dataWriteSize;
+
+    if ( dataWriteSize != size )
+    {
+      return failStream( this->ERR_WRITE_FAIL );
+    }
+
+    return true;
+  }
+
+
+  bool BinaryFile::endWrite()
+  {
+    if ( mStream != Stream::WRITING )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return false;
+    }
+
+    mStream = Stream::NONE;
+    if ( mStreamPos != mMeta.file_size )
+    {
+      mError = this->ERR_SIZING;
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Append the CRC trailer
+    -------------------------------------------------------------------------*/
+    const uint32_t crc = mCrc.value();
+
+    if ( fwrite( &crc, 1, sizeof( crc ), mFileId ) != sizeof( crc ) )
+    {
+      mError = this->ERR_WRITE_FAIL;
+      return false;
+    }
+
+    return true;
+  }
+
+
   BinaryFile::ECode BinaryFile::getError()
   {
     return mError;
@@ -183,4 +433,57 @@ namespace Aurora::FileSystem
     mError = this->ERR_OK;
   }
 
+
+  /**
+   * @brief Aborts a streamed transfer
+   *
+   * @param error         Reason for the failure
+   * @return false        Always, for convenience
+   */
+  bool BinaryFile::failStream( const ECode error )
+  {
+    mStream = Stream::NONE;
+    mError  = error;
+    return false;
+  }
+
+
+  /**
+   * @brief Gets the CRC a file was stored with
+   *
+   * Files written in pieces keep it in a trailer, which must be the next thing
+   * in the file. Everything else keeps it in the metadata.
+   *
+   * @param meta          Metadata of the file
+   * @param crc           Output for the stored CRC
+   * @return true         The CRC was found
+   * @return false        The trailer couldn't be read
+   */
+  bool BinaryFile::readStoredCrc( const LogStruct &meta, uint32_t &crc )
+  {
+    if ( meta.version != BinaryFile::LogStruct::TrailerCrcVersion )
+    {
+      crc = meta.crc;
+      return true;
+    }
+
+    return fread( &crc, 1, sizeof( crc ), mFileId ) == sizeof( crc );
+  }
+
+
+  /**
+   * @brief Adds the CRC protected portion of the metadata to a CRC
+   *
+   * @param crc           CRC to update
+   * @param meta          Metadata to add
+   */
+  void BinaryFile::addMetaCrc( etl::crc32 &crc, const LogStruct &meta )
+  {
+    auto metaAddr = reinterpret_cast<const uint8_t *>( &meta );
+    auto start    = metaAddr + offsetof( BinaryFile::LogStruct, version );
+    auto end      = metaAddr + offsetof( BinaryFile::LogStruct, timestamp ) + sizeof( BinaryFile::LogStruct::timestamp );
+
+    crc.add( start, end );
+  }
+
 }  // namespace Aurora::FileSystem
@@ -5,7 +5,7 @@
  *  Description:
  *    High level interface to data stored as a binary file
  *
- *  2021-2022 | Brandon Braun | brandonbraun653@gmail.com
+ *  2021-2023 | Brandon Braun | brandonbraun653@gmail.com
  *****************************************************************************/
 
 #pragma once
@@ -18,8 +18,16 @@ Includes
 #include <Aurora/source/filesystem/file_types.hpp>
 #include <cstdint>
 #include <cstring>
+#include <etl/crc32.h>
 #include <string_view>
 
+/*-----------------------------------------------------------------------------
+Literal Constants
+-----------------------------------------------------------------------------*/
+#if !defined( AURORA_PRJ_FS_BINARY_CHUNK_SIZE )
+#define AURORA_PRJ_FS_BINARY_CHUNK_SIZE ( 128 )
+#endif
+
 namespace Aurora::FileSystem
 {
   /**
@@ -29,6 +37,9 @@ namespace Aurora::FileSystem
    * Expects the entire file to be read/written on any IO operation due to the minimalist nature of the
    * underlying filesystem. Tracking a R/W offset is not supported, mainly due to how infrequently that
    * use case is needed and the complexity of maintaining it.
+   *
+   * Files too large to hold in RAM can be streamed in pieces with the begin/chunk/end calls, which keep
+   * a running CRC instead of needing the whole payload at once.
    */
   class BinaryFile
   {
@@ -84,6 +95,81 @@ namespace Aurora::FileSystem
      */
     bool write( const void *const buffer, const size_t size );
 
+    /**
+     * @brief Starts reading a file in pieces
+     *
+     * Loads the file metadata. Follow up with readChunk() as many times as
+     * needed, then endRead() to check the CRC.
+     *
+     * @param size          Optional output for the payload size in bytes
+     * @return true         The file is ready to stream
+     * @return false        An error occurred, see getError()
+     */
+    bool beginRead( size_t *const size = nullptr );
+
+    /**
+     * @brief Reads the next piece of a streamed file
+     *
+     * @param buffer        Buffer to read data into
+     * @param size          Max number of bytes to read
+     * @return size_t       Bytes read. Zero once the payload is exhausted or on error.
+     */
+    size_t readChunk( void *const buffer, const size_t size );
+
+    /**
+     * @brief Finishes a streamed read and checks the CRC
+     *
+     * Any payload not yet read is consumed first, so the check always covers
+     * the whole file.
+     *
+     * @return true         The data is intact
+     * @return false        An error occurred, see getError()
+     */
+    bool endRead();
+
+    /**
+     * @brief Checks the integrity of the file without loading it into memory
+     *
+     * Streams the payload through a small fixed buffer. The file is rewound
+     * before and after, so a normal read() can follow.
+     *
+     * @return true         The data is intact
+     * @return false        An error occurred, see getError()
+     */
+    bool verify();
+
+    /**
+     * @brief Starts writing a file in pieces
+     *
+     * The CRC isn't known until the payload has been seen, so streamed files
+     * carry it in a trailer that endWrite() appends. Nothing already written
+     * is revisited, and an interrupted write has no trailer, so it fails its
+     * CRC check rather than looking valid.
+     *
+     * @param size          Total payload size in bytes
+     * @return true         The file is ready to stream
+     * @return false        An error occurred, see getError()
+     */
+    bool beginWrite( const size_t size );
+
+    /**
+     * @brief Writes the next piece of a streamed file
+     *
+     * @param buffer        Data to write
+     * @param size          Number of bytes to write
+     * @return true         Write completed successfully
+     * @return false        An error occurred, see getError()
+     */
+    bool writeChunk( const void *const buffer, const size_t size );
+
+    /**
+     * @brief Finishes a streamed write by appending the final CRC
+     *
+     * @return true         Exactly the promised number of bytes were written
+     * @return false        An error occurred, see getError()
+     */
+    bool endWrite();
+
     /**
      * @brief Retrieves the last error that occurred
      *
@@ -99,28 +185,43 @@ namespace Aurora::FileSystem
   protected:
     struct LogStruct
     {
-      uint32_t crc;           /**< CRC of the entire file + this LogStruct */
+      static constexpr uint8_t HeaderCrcVersion  = 1u; /**< CRC is stored in this structure */
+      static constexpr uint8_t TrailerCrcVersion = 2u; /**< CRC is stored after the user's data */
+
+      uint32_t crc;           /**< CRC of the entire file + this LogStruct. Unused when the CRC is in a trailer. */
       const uint8_t version;  /**< Log structure version */
       uint8_t _pad[ 3 ];      /**< Unused */
       uint32_t file_size;     /**< Length of the user's data in bytes */
       uint32_t timestamp;     /**< Last time written */
 
-      LogStruct() : version( StructVersion )
+      LogStruct( const uint8_t ver = HeaderCrcVersion ) : version( ver )
       {
         memset( _pad, 0, sizeof( _pad ) );
         crc       = 0xCCCCCCCC;
         file_size = 0xCCCCCCCC;
         timestamp = 0xCCCCCCCC;
       }
-
-    private:
-      static constexpr uint8_t StructVersion = 1u;
     };
 
   private:
-    bool mIsOpen;
-    FileId mFileId;
-    ECode mError;
+    enum class Stream : uint8_t
+    {
+      NONE,
+      READING,
+      WRITING
+    };
+
+    bool       mIsOpen;
+    FileId     mFileId;
+    ECode      mError;
+    Stream     mStream;    /**< Streamed transfer in progress, if any */
+    LogStruct  mMeta;      /**< Metadata of the streamed file */
+    etl::crc32 mCrc;       /**< Running CRC of the streamed file */
+    size_t     mStreamPos; /**< Payload bytes transferred so far */
+
+    bool failStream( const ECode error );
+    bool readStoredCrc( const LogStruct &meta, uint32_t &crc );
+    static void addMetaCrc( etl::crc32 &crc, const LogStruct &meta );
   };
 }  // namespace Aurora::FileSystem
 
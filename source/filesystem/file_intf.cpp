@@ -14,8 +14,9 @@ Includes
 #include <Aurora/filesystem>
 #include <Chimera/assert>
 #include <Chimera/thread>
+#include <atomic>
 #include <etl/algorithm.h>
-#include <etl/vector.h>
+#include <etl/array.h>
 #include <etl/string.h>
 
 namespace Aurora::FileSystem
@@ -30,24 +31,62 @@ namespace Aurora::FileSystem
   Structures
   ---------------------------------------------------------------------------*/
   /**
-   * @brief A light veneer to abstract information about open files
+   * @brief Optional user-space buffer attached to an open file
+   *
+   * Holds either pending writes or read-ahead data, never both. The driver's
+   * file position is always at the end of whatever the buffer holds.
    */
-  struct File
+  struct StreamBuffer
   {
-    FileId   fileDesc; /**< File descriptor index for this object */
-    VolumeId volDesc;  /**< Volume ID associated with the file */
-    FilePath path;     /**< Path associated with this file */
+    enum class State : uint8_t
+    {
+      IDLE,
+      READING,
+      WRITING
+    };
+
+    uint8_t   *data;  /**< User supplied memory, null if unbuffered */
+    size_t     size;  /**< Capacity of the memory */
+    size_t     len;   /**< Valid bytes held */
+    size_t     pos;   /**< Next byte to hand out when reading */
+    BufferMode mode;  /**< Buffering policy */
+    State      state; /**< What the held bytes represent */
 
-    bool operator<( const File &rhs ) const
+    inline void clear()
     {
-      return fileDesc < rhs.fileDesc;
+      data  = nullptr;
+      size  = 0;
+      len   = 0;
+      pos   = 0;
+      mode  = F_IONBF;
+      state = State::IDLE;
     }
+  };
+
+
+  /**
+   * @brief A light veneer to abstract information about open files
+   */
+  struct File
+  {
+    FileId       fileDesc;   /**< File descriptor index for this object */
+    VolumeId     volDesc;    /**< Volume ID associated with the file */
+    Interface   *fsImpl;     /**< Implementation of the owning volume. Null if the slot is free. */
+    uint32_t     pathHash;   /**< Hash of the path, to skip most string compares */
+    uint32_t     generation; /**< Times this slot has been used. Survives clear(). */
+    FilePath     path;       /**< Path associated with this file */
+    StreamBuffer buffer;     /**< User-space buffering, see setvbuf() */
+
+    Chimera::Thread::RecursiveMutex lock; /**< Serializes calls on this file only */
 
     inline void clear()
     {
       fileDesc = -1;
       volDesc  = -1;
+      fsImpl   = nullptr;
+      pathHash = 0;
       path.clear();
+      buffer.clear();
     }
   };
 
@@ -60,16 +99,12 @@ namespace Aurora::FileSystem
     VolumeId  volDesc;     /**< Volume ID associated with this object */
     DriveStr  drivePrefix; /**< This volume's drive letter/prefix */
     Interface fsImpl;      /**< Implementation specifics of the FS */
-
-
-    bool operator<( const Volume &rhs ) const
-    {
-      return volDesc < rhs.volDesc;
-    }
+    bool      mounted;     /**< Slot holds a mounted volume */
 
     inline void clear()
     {
       volDesc = -1;
+      mounted = false;
       drivePrefix.clear();
       fsImpl.clear();
     }
@@ -79,81 +114,270 @@ namespace Aurora::FileSystem
   /*---------------------------------------------------------------------------
   Static Data
   ---------------------------------------------------------------------------*/
-  static Chimera::Thread::RecursiveMutex   s_lock;         /**< Module lock */
-  static etl::vector<Volume, MAX_VOLUMES>  s_volumes;      /**< Registered volumes */
-  static etl::vector<File, MAX_OPEN_FILES> s_files;        /**< Currently open files */
-  static FileId                            s_next_file_id; /**< Next descriptor to assign to a new file */
-  static VolumeId                          s_next_vol_id;  /**< Next descriptor to assign to a new volume */
+  static Chimera::Thread::RecursiveMutex  s_lock;        /**< Guards the tables: opening, closing, and (un)mounting */
+  static etl::array<Volume, MAX_VOLUMES>  s_volumes;     /**< Registered volumes, stable addresses */
+  static etl::array<File, MAX_OPEN_FILES> s_files;       /**< Open files, indexed by descriptor slot */
+  static VolumeId                         s_next_vol_id; /**< Next descriptor to assign to a new volume */
 
 
   /*---------------------------------------------------------------------------
   Static Functions
   ---------------------------------------------------------------------------*/
   /**
-   * @brief Search open files to find the control data for this file
+   * @brief Hashes a file path (FNV-1a)
+   *
+   * @param path    Null terminated path
+   * @return uint32_t
+   */
+  static uint32_t path_hash( const char *path )
+  {
+    uint32_t hash = 2166136261u;
+    while ( *path )
+    {
+      hash = ( hash ^ static_cast<uint8_t>( *path++ ) ) * 16777619u;
+    }
+
+    return hash;
+  }
+
+
+  /**
+   * @brief Look up the control data for an open file
+   *
+   * The slot comes straight from the descriptor. A descriptor that doesn't
+   * match the slot's current one is stale and is rejected.
    *
    * @param file    File being searched for
-   * @return const File*
+   * @return File*
    */
   static File *get_file( const FileId file )
   {
-    for( File &f : s_files )
+    const size_t slot = fileSlot( file );
+    if ( ( file < 0 ) || ( slot >= s_files.size() ) || ( s_files[ slot ].fileDesc != file ) )
     {
-      if( f.fileDesc == file )
+      return nullptr;
+    }
+
+    return &s_files[ slot ];
+  }
+
+
+  /**
+   * @brief Holds an open file's lock for the duration of a call
+   *
+   * Only the file itself is locked, so calls on other files and volumes run
+   * concurrently. The descriptor is checked again once the lock is held, in
+   * case the file was closed and the slot reused while waiting.
+   */
+  class FileGuard
+  {
+  public:
+    explicit FileGuard( const FileId stream ) : mFile( get_file( stream ) ), mImpl( nullptr )
+    {
+      if ( mFile )
+      {
+        mFile->lock.lock();
+        mImpl = ( mFile->fileDesc == stream ) ? mFile->fsImpl : nullptr;
+      }
+    }
+
+    ~FileGuard()
+    {
+      if ( mFile )
       {
-        return &f;
+        mFile->lock.unlock();
       }
     }
 
-    return nullptr;
+    /**
+     * @brief Gets the implementation of the file's volume
+     * @return Interface*   Null if the file isn't open
+     */
+    Interface *impl() const
+    {
+      return mImpl;
+    }
+
+    /**
+     * @brief Gets the file control data
+     * @return File*    Null if the file isn't open
+     */
+    File *file() const
+    {
+      return mImpl ? mFile : nullptr;
+    }
+
+  private:
+    File      *mFile;
+    Interface *mImpl;
+  };
+
+
+  /**
+   * @brief Writes out any pending data held in a file's buffer
+   *
+   * @param f       File to flush
+   * @return int    0 if all ok, negative otherwise
+   */
+  static int buffer_flush( File &f )
+  {
+    StreamBuffer &buf = f.buffer;
+    if ( buf.state != StreamBuffer::State::WRITING )
+    {
+      return 0;
+    }
+
+    const size_t written = buf.len ? f.fsImpl->fwrite( buf.data, 1, buf.len, f.fileDesc ) : 0;
+    if ( written < buf.len )
+    {
+      /* Keep what didn't make it so a later flush can retry */
+      memmove( buf.data, buf.data + written, buf.len - written );
+      buf.len -= written;
+      return -1;
+    }
+
+    buf.len   = 0;
+    buf.state = StreamBuffer::State::IDLE;
+    return 0;
   }
 
 
   /**
-   * @brief Get the volume object associated with a file
+   * @brief Empties a file's buffer, leaving the driver's position where the
+   * user thinks the stream is
    *
-   * @param file    File to find the volume object for
-   * @return const Volume*
+   * @param f       File to synchronize
+   * @return int    0 if all ok, negative otherwise
    */
-  static Volume *get_volume( const FileId file )
+  static int buffer_sync( File &f )
   {
-    /*-------------------------------------------------------------------------
-    Look up the file first to see if it exists
-    -------------------------------------------------------------------------*/
-    auto f = get_file( file );
-    if ( !f )
+    StreamBuffer &buf = f.buffer;
+    if ( buf.state == StreamBuffer::State::WRITING )
     {
-      return nullptr;
+      return buffer_flush( f );
     }
 
     /*-------------------------------------------------------------------------
-    Otherwise it exists, which means the volume must exist
+    Read-ahead data the user never consumed has to be given back
     -------------------------------------------------------------------------*/
-    for ( Volume &iter : s_volumes )
+    int result = 0;
+    if ( ( buf.state == StreamBuffer::State::READING ) && ( buf.pos < buf.len ) )
+    {
+      const size_t position = f.fsImpl->ftell( f.fileDesc ) - ( buf.len - buf.pos );
+      result                = f.fsImpl->fseek( f.fileDesc, position, F_SEEK_SET );
+    }
+
+    buf.len   = 0;
+    buf.pos   = 0;
+    buf.state = StreamBuffer::State::IDLE;
+    return result;
+  }
+
+
+  /**
+   * @brief Reads through a file's buffer
+   *
+   * @param f       File to read from
+   * @param ptr     Output storage
+   * @param total   Number of bytes to read
+   * @return size_t Number of bytes read
+   */
+  static size_t buffer_read( File &f, uint8_t *const ptr, const size_t total )
+  {
+    StreamBuffer &buf = f.buffer;
+    if ( buffer_flush( f ) != 0 )
     {
-      if( iter.volDesc == f->volDesc )
+      return 0;
+    }
+
+    buf.state   = StreamBuffer::State::READING;
+    size_t done = 0;
+
+    while ( done < total )
+    {
+      /*-----------------------------------------------------------------------
+      Hand out whatever is already buffered
+      -----------------------------------------------------------------------*/
+      if ( buf.pos < buf.len )
       {
-        return &iter;
+        const size_t chunk = etl::min( buf.len - buf.pos, total - done );
+        memcpy( ptr + done, buf.data + buf.pos, chunk );
+        buf.pos += chunk;
+        done += chunk;
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Large requests skip the buffer, small ones refill it
+      -----------------------------------------------------------------------*/
+      if ( ( total - done ) >= buf.size )
+      {
+        done += f.fsImpl->fread( ptr + done, 1, total - done, f.fileDesc );
+        break;
+      }
+
+      buf.pos = 0;
+      buf.len = f.fsImpl->fread( buf.data, 1, buf.size, f.fileDesc );
+      if ( !buf.len )
+      {
+        break;
       }
     }
 
-    /* Should never get here in reality */
-    RT_DBG_ASSERT( false );
-    return nullptr;
+    return done;
   }
 
 
   /**
-   * @brief Get the filesystem implementation associated with a file id
+   * @brief Writes through a file's buffer
    *
-   * @param file    Which file to look up an interface for
-   * @return const Interface&
+   * @param f       File to write to
+   * @param ptr     Data to write
+   * @param total   Number of bytes to write
+   * @return size_t Number of bytes accepted
    */
-  static Interface *get_interface( const FileId file )
+  static size_t buffer_write( File &f, const uint8_t *const ptr, const size_t total )
   {
-    Chimera::Thread::LockGuard _lck( s_lock );
-    auto                       vol = get_volume( file );
-    return vol ? &vol->fsImpl : nullptr;
+    StreamBuffer &buf = f.buffer;
+    if ( ( buf.state == StreamBuffer::State::READING ) && ( buffer_sync( f ) != 0 ) )
+    {
+      return 0;
+    }
+
+    buf.state   = StreamBuffer::State::WRITING;
+    size_t done = 0;
+
+    while ( done < total )
+    {
+      /*-----------------------------------------------------------------------
+      Large requests skip the buffer once it's empty
+      -----------------------------------------------------------------------*/
+      if ( !buf.len && ( ( total - done ) >= buf.size ) )
+      {
+        done += f.fsImpl->fwrite( ptr + done, 1, total - done, f.fileDesc );
+        break;
+      }
+
+      const size_t chunk = etl::min( buf.size - buf.len, total - done );
+      memcpy( buf.data + buf.len, ptr + done, chunk );
+      buf.len += chunk;
+      done += chunk;
+
+      if ( ( buf.len == buf.size ) && ( buffer_flush( f ) != 0 ) )
+      {
+        return done;
+      }
+    }
+
+    /*-------------------------------------------------------------------------
+    Line buffered streams push out complete lines right away
+    -------------------------------------------------------------------------*/
+    if ( ( buf.mode == F_IOLBF ) && memchr( ptr, '\n', total ) )
+    {
+      buffer_flush( f );
+    }
+
+    return done;
   }
 
 
@@ -175,11 +399,18 @@ namespace Aurora::FileSystem
   ---------------------------------------------------------------------------*/
   void initialize()
   {
-    s_volumes.clear();
-    s_files.clear();
+    for ( Volume &vol : s_volumes )
+    {
+      vol.clear();
+    }
+
+    for ( File &f : s_files )
+    {
+      f.clear();
+    }
+
     s_lock.unlock();
-    s_next_file_id = 0;
-    s_next_vol_id  = 0;
+    s_next_vol_id = 0;
   }
 
 
@@ -190,7 +421,8 @@ namespace Aurora::FileSystem
     /*-------------------------------------------------------------------------
     Validate the inputs
     -------------------------------------------------------------------------*/
-    if ( s_volumes.full() || !is_intf_valid( intf ) || ( drive.size() > MAX_DRIVE_PREFIX_LEN ) )
+    auto vol = etl::find_if( s_volumes.begin(), s_volumes.end(), []( const Volume &v ) { return !v.mounted; } );
+    if ( ( vol == s_volumes.end() ) || !is_intf_valid( intf ) || ( drive.size() > MAX_DRIVE_PREFIX_LEN ) )
     {
       return -1;
     }
@@ -204,17 +436,16 @@ namespace Aurora::FileSystem
     }
 
     /*-------------------------------------------------------------------------
-    Build up the new volume
+    Build up the new volume in place. Open files point at its interface, so
+    volumes never move once mounted.
     -------------------------------------------------------------------------*/
-    Volume vol;
+    vol->clear();
+    vol->fsImpl      = intf;
+    vol->volDesc     = s_next_vol_id++;
+    vol->drivePrefix = drive.data();
+    vol->mounted     = true;
 
-    vol.fsImpl      = intf;
-    vol.volDesc     = s_next_vol_id++;
-    vol.drivePrefix = drive.data();
-
-    s_volumes.push_back( vol );
-    etl::shell_sort( s_volumes.begin(), s_volumes.end() );
-    return vol.volDesc;
+    return vol->volDesc;
   }
 
 
@@ -225,27 +456,23 @@ namespace Aurora::FileSystem
     /*-------------------------------------------------------------------------
     Close all files associated with this volume
     -------------------------------------------------------------------------*/
-    while ( true )
+    for ( File &f : s_files )
     {
-      auto iter = etl::find_if( s_files.begin(), s_files.end(), [ volume ]( const File &f ) { return f.volDesc == volume; } );
-      if ( iter == s_files.end() )
+      if ( f.fsImpl && ( f.volDesc == volume ) )
       {
-        break;
+        fclose( f.fileDesc );
       }
-
-      fclose( iter->fileDesc );
     }
 
     /*-------------------------------------------------------------------------
     Destroy the volume
     -------------------------------------------------------------------------*/
     auto iter = etl::find_if( s_volumes.begin(), s_volumes.end(),
-                              [ volume ]( const Volume &v ) { return v.volDesc == volume; } );
+                              [ volume ]( const Volume &v ) { return v.mounted && ( v.volDesc == volume ); } );
     if ( iter != s_volumes.end() )
     {
       iter->fsImpl.unmount( iter->volDesc );
-      s_volumes.erase( iter );
-      etl::shell_sort( s_volumes.begin(), s_volumes.end() );
+      iter->clear();
     }
   }
 
@@ -266,14 +493,23 @@ namespace Aurora::FileSystem
     Check if the file already exists. Let the underlying implementation handle
     any issues that arise from opening a file twice or with different modes.
     -------------------------------------------------------------------------*/
-    auto f_iter = etl::find_if( s_files.begin(), s_files.end(),
-                                [ filename ]( const File &f ) { return f.path.compare( filename ) == 0; } );
-    if ( f_iter != s_files.end() )
+    const uint32_t hash = path_hash( filename );
+    File          *slot = nullptr;
+
+    for ( File &f : s_files )
     {
-      file = f_iter->fileDesc;
-      return 0;
+      if ( !f.fsImpl )
+      {
+        slot = slot ? slot : &f;
+      }
+      else if ( ( f.pathHash == hash ) && ( f.path.compare( filename ) == 0 ) )
+      {
+        file = f.fileDesc;
+        return 0;
+      }
     }
-    else if ( s_files.full() )
+
+    if ( !slot )
     {
       return -1;
     }
@@ -282,39 +518,40 @@ namespace Aurora::FileSystem
     Check for a volume that's mapped to this filename
     -------------------------------------------------------------------------*/
     etl::string_view str( filename );
-    auto             v_iter = etl::find_if( s_volumes.begin(), s_volumes.end(),
-                                            [ str ]( const Volume &v ) { return str.starts_with( v.drivePrefix ); } );
+    auto             v_iter = etl::find_if( s_volumes.begin(), s_volumes.end(), [ str ]( const Volume &v ) {
+      return v.mounted && str.starts_with( v.drivePrefix );
+    } );
     if ( v_iter == s_volumes.end() )
     {
       return -1;
     }
 
     /*-------------------------------------------------------------------------
-    Invoke the interface's open call
+    Assign the next descriptor for this slot and invoke the interface's open
     -------------------------------------------------------------------------*/
-    int ret = v_iter->fsImpl.fopen( filename, mode, s_next_file_id, v_iter->volDesc );
-    if( ret != 0 )
+    const uint32_t generation = ( ( slot->generation + 1u ) & FILE_GEN_MSK ) ? ( slot->generation + 1u ) : 1u;
+    const FileId   stream     = static_cast<FileId>( ( generation << FILE_SLOT_BITS ) |
+                                                     static_cast<uint32_t>( slot - s_files.begin() ) );
+
+    int ret = v_iter->fsImpl.fopen( filename, mode, stream, v_iter->volDesc );
+    if ( ret != 0 )
     {
       return ret;
     }
 
     /*-------------------------------------------------------------------------
-    Create the new entry
+    Fill in the entry, then publish the descriptor
     -------------------------------------------------------------------------*/
-    File f;
-
-    f.clear();
-    f.path = filename;
-    f.volDesc  = v_iter->volDesc;
-    f.fileDesc = s_next_file_id++;
-
-    /*-------------------------------------------------------------------------
-    Update the system registry
-    -------------------------------------------------------------------------*/
-    file = f.fileDesc;
-    s_files.push_back( f );
-    etl::shell_sort( s_files.begin(), s_files.end() );
-
+    Chimera::Thread::LockGuard _slotLck( slot->lock );
+    slot->generation = generation;
+    slot->path       = filename;
+    slot->pathHash   = hash;
+    slot->volDesc    = v_iter->volDesc;
+    slot->fsImpl     = &v_iter->fsImpl;
+    std::atomic_thread_fence( std::memory_order_release );
+    slot->fileDesc = stream;
+
+    file = stream;
     return 0;
   }
 
@@ -324,107 +561,223 @@ namespace Aurora::FileSystem
     Chimera::Thread::LockGuard _lck( s_lock );
 
     /*-------------------------------------------------------------------------
-    Find the file and close the stream
+    Find the file and wait for any call in progress on it to finish
     -------------------------------------------------------------------------*/
-    auto impl = get_interface( stream );
-    if ( !impl )
+    File *file = get_file( stream );
+    if ( !file )
     {
       return -1;
     }
 
-    const int cached_close_result = impl->fclose( stream );
+    Chimera::Thread::LockGuard _fileLck( file->lock );
+    if ( ( file->fileDesc != stream ) || !file->fsImpl )
+    {
+      return -1;
+    }
 
     /*-------------------------------------------------------------------------
-    Remove the file from the open file list
+    Retract the descriptor before closing the stream. Like stdio, the stream
+    is closed even if buffered data couldn't be written, but the caller still
+    hears about the lost data.
     -------------------------------------------------------------------------*/
-    auto file = get_file( stream );
-    s_files.erase( file );
-    etl::shell_sort( s_files.begin(), s_files.end() );
+    const int buffered = buffer_flush( *file );
+
+    Interface *impl = file->fsImpl;
+    file->fileDesc  = -1;
+    std::atomic_thread_fence( std::memory_order_release );
 
-    return cached_close_result;
+    const int cached_close_result = impl->fclose( stream );
+
+    /*-------------------------------------------------------------------------
+    Release the slot
+    -------------------------------------------------------------------------*/
+    file->clear();
+    return ( buffered != 0 ) ? buffered : cached_close_result;
   }
 
 
   int fflush( const FileId stream )
   {
-    auto impl = get_interface( stream );
+    FileGuard file( stream );
+    auto      impl = file.impl();
     if ( !impl )
     {
       return -1;
     }
 
-    return impl->fflush( stream );
+    const int buffered = buffer_flush( *file.file() );
+    const int flushed  = impl->fflush( stream );
+    return ( buffered != 0 ) ? buffered : flushed;
   }
 
 
   size_t fread( void *const ptr, const size_t size, const size_t count, const FileId stream )
   {
-    auto impl = get_interface( stream );
+    FileGuard file( stream );
+    auto      impl = file.impl();
     if ( !impl )
     {
       return 0;
     }
 
+    File *f = file.file();
+    if ( f->buffer.mode != F_IONBF )
+    {
+      return buffer_read( *f, reinterpret_cast<uint8_t *>( ptr ), size * count );
+    }
+
     return impl->fread( ptr, size, count, stream );
   }
 
 
   size_t fwrite( const void *const ptr, const size_t size, const size_t count, const FileId stream )
   {
-    auto impl = get_interface( stream );
+    FileGuard file( stream );
+    auto      impl = file.impl();
     if ( !impl )
     {
       return 0;
     }
 
+    File *f = file.file();
+    if ( f->buffer.mode != F_IONBF )
+    {
+      return buffer_write( *f, reinterpret_cast<const uint8_t *>( ptr ), size * count );
+    }
+
     return impl->fwrite( ptr, size, count, stream );
   }
 
 
   int fseek( const FileId stream, const size_t offset, const WhenceFlags whence )
   {
-    auto impl = get_interface( stream );
+    FileGuard file( stream );
+    auto      impl = file.impl();
     if ( !impl )
     {
       return -1;
     }
 
+    if ( buffer_sync( *file.file() ) != 0 )
+    {
+      return -1;
+    }
+
     return impl->fseek( stream, offset, whence );
   }
 
 
   size_t ftell( const FileId stream )
   {
-    auto impl = get_interface( stream );
+    FileGuard file( stream );
+    auto      impl = file.impl();
     if ( !impl )
     {
       return 0;
     }
 
-    return impl->ftell( stream );
+    /*-------------------------------------------------------------------------
+    Account for data the driver hasn't seen yet, or has but the user hasn't
+    -------------------------------------------------------------------------*/
+    const StreamBuffer &buf      = file.file()->buffer;
+    const size_t        position = impl->ftell( stream );
+
+    switch ( buf.state )
+    {
+      case StreamBuffer::State::WRITING:
+        return position + buf.len;
+
+      case StreamBuffer::State::READING:
+        return position - ( buf.len - buf.pos );
+
+      default:
+        return position;
+    }
   }
 
 
   void frewind( const FileId stream )
   {
-    auto impl = get_interface( stream );
+    FileGuard file( stream );
+    auto      impl = file.impl();
     if ( !impl )
     {
       return;
     }
 
+    buffer_sync( *file.file() );
     impl->frewind( stream );
   }
 
 
   size_t fsize( const FileId stream )
   {
-    auto impl = get_interface( stream );
+    FileGuard file( stream );
+    auto      impl = file.impl();
     if ( !impl )
     {
-      return 0 ;
+      return 0;
+    }
+
+    if ( buffer_flush( *file.file() ) != 0 )
+    {
+      return 0;
     }
 
     return impl->fsize( stream );
   }
+
+
+  int setvbuf( const FileId stream, void *const buffer, const BufferMode mode, const size_t size )
+  {
+    FileGuard file( stream );
+    File     *f = file.file();
+
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( !f || ( mode > F_IOFBF ) || ( ( mode != F_IONBF ) && ( !buffer || !size ) ) )
+    {
+      return -1;
+    }
+
+    /*-------------------------------------------------------------------------
+    Drain the old buffer before switching over
+    -------------------------------------------------------------------------*/
+    if ( buffer_sync( *f ) != 0 )
+    {
+      return -1;
+    }
+
+    f->buffer.clear();
+    if ( mode != F_IONBF )
+    {
+      f->buffer.data = reinterpret_cast<uint8_t *>( buffer );
+      f->buffer.size = size;
+      f->buffer.mode = mode;
+    }
+
+    return 0;
+  }
+
+
+  VolumeId fvolume( const FileId stream )
+  {
+    /*-------------------------------------------------------------------------
+    No file lock here, a call in progress may hold it for a whole transfer.
+    The volume is published before the descriptor and retracted after it, so
+    a descriptor that matches on both sides of the read vouches for it.
+    -------------------------------------------------------------------------*/
+    const File *f = get_file( stream );
+    if ( !f )
+    {
+      return -1;
+    }
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+    const VolumeId volume = f->volDesc;
+    std::atomic_thread_fence( std::memory_order_acquire );
+
+    return ( f->fileDesc == stream ) ? volume : -1;
+  }
 }  // namespace Aurora::FileSystem
@@ -74,7 +74,8 @@ namespace Aurora::FileSystem
    * @brief Close a file stream
    *
    * @param stream    File stream being closed
-   * @return int      0 if all ok, negative otherwise
+   * @return int      0 if all ok, negative otherwise. The stream is closed
+   *                  even if flushing buffered data failed.
    */
   int fclose( const FileId stream );
 
@@ -144,13 +145,40 @@ namespace Aurora::FileSystem
   void frewind( const FileId stream );
 
   /**
-   * @brief Gets the size of the file in bytes
+   * @brief Gets the size of the file in bytes, including buffered writes
    *
    * @param stream    Stream to act on
-   * @return size_t
+   * @return size_t   Zero if the stream is invalid or its buffer can't be flushed
    */
   size_t fsize( const FileId stream );
 
+  /**
+   * @brief Assigns a user-space buffer to an open stream
+   *
+   * Works like the stdio function of the same name. Reads and writes smaller
+   * than the buffer are gathered into buffer sized driver calls. Any data
+   * already buffered is written out before the new settings take effect.
+   *
+   * @param stream    Stream to act on
+   * @param buffer    Buffer memory, which must stay valid until the stream is
+   *                  closed or reconfigured. Ignored for F_IONBF.
+   * @param mode      F_IONBF, F_IOLBF, or F_IOFBF
+   * @param size      Size of the buffer in bytes
+   * @return int      0 if all ok, negative otherwise
+   */
+  int setvbuf( const FileId stream, void *const buffer, const BufferMode mode, const size_t size );
+
+  /**
+   * @brief Gets the volume an open stream lives on
+   *
+   * Doesn't wait on the file's lock, so it's safe to call while another
+   * thread is in the middle of reading or writing the stream.
+   *
+   * @param stream    Stream to act on
+   * @return VolumeId Negative if the stream isn't open
+   */
+  VolumeId fvolume( const FileId stream );
+
 }  // namespace Aurora::FileSystem
 
 #endif /* !AURORA_FILESYSTEM_INTERFACE_HPP */
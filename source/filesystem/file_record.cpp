@@ -0,0 +1,675 @@
+/******************************************************************************
+ *  File Name:
+ *    file_record.cpp
+ *
+ *  Description:
+ *    Implementation of the append-only record log
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/filesystem>
+#include <etl/algorithm.h>
+#include <etl/crc32.h>
+#include <limits>
+
+namespace Aurora::FileSystem
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr uint32_t SEGMENT_MAGIC  = 0x5347454Cu; /**< "LEGS" on disk */
+  static constexpr uint32_t RECORD_MAGIC   = 0x4443524Cu; /**< "LRCD" on disk */
+  static constexpr uint32_t INDEX_MAGIC    = 0x5844494Cu; /**< "LIDX" on disk */
+  static constexpr uint32_t FORMAT_VERSION = 1u;
+  static constexpr size_t   FILL_SIZE      = 256;
+
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static const uint8_t s_fill[ FILL_SIZE ] = { 0 }; /**< Source for zero filling unused segment space */
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Adds the bytes of a header to a running CRC, leaving off the trailing CRC field
+   *
+   * @param crc       CRC to update
+   * @param header    Header to add
+   */
+  template<typename T>
+  static void add_header_crc( etl::crc32 &crc, const T &header )
+  {
+    auto bytes = reinterpret_cast<const uint8_t *>( &header );
+    crc.add( bytes, bytes + offsetof( T, crc ) );
+  }
+
+  /*---------------------------------------------------------------------------
+  Record Log
+  ---------------------------------------------------------------------------*/
+  RecordLog::RecordLog() :
+      mIsOpen( false ), mWritable( false ), mSealed( false ), mFileId( -1 ), mError( ERR_OK ), mSegmentSize( 0 ),
+      mSegmentLimit( 0 ), mSegmentCount( 0 ), mLastIndex( 0 ), mEnd( 0 ), mReadPos( 0 )
+  {
+  }
+
+
+  RecordLog::~RecordLog()
+  {
+    this->close();
+  }
+
+
+  bool RecordLog::open( const std::string_view &filename, const AccessFlags mode, const size_t segmentSize,
+                        const size_t segmentRecords )
+  {
+    this->close();
+
+    /*-------------------------------------------------------------------------
+    Input protection
+    -------------------------------------------------------------------------*/
+    const size_t minSize = sizeof( SegmentHeader ) + sizeof( RecordHeader ) + 1u;
+    if ( ( segmentSize < minSize ) || ( segmentSize > std::numeric_limits<uint32_t>::max() )
+         || ( segmentRecords > std::numeric_limits<uint32_t>::max() ) )
+    {
+      mError = this->ERR_BAD_ARG;
+      return false;
+    }
+
+    if ( fopen( filename.data(), mode, mFileId ) != 0 )
+    {
+      mFileId = -1;
+      mError  = this->ERR_NO_FILE;
+      return false;
+    }
+
+    mIsOpen       = true;
+    mWritable     = ( mode & O_WRONLY );
+    mEnd          = fsize( mFileId );
+    mReadPos      = 0;
+    mSegmentCount = 0;
+    mLastIndex    = 0;
+
+    /*-------------------------------------------------------------------------
+    Empty files become new logs with the caller's layout
+    -------------------------------------------------------------------------*/
+    if ( mEnd == 0 )
+    {
+      mSegmentSize  = segmentSize;
+      mSegmentLimit = segmentRecords;
+      mSealed       = false;
+      return true;
+    }
+
+    /*-------------------------------------------------------------------------
+    Existing logs describe their own layout in the first segment header, so
+    the file has to be readable even when opened to append.
+    -------------------------------------------------------------------------*/
+    SegmentHeader header;
+
+    if ( !( mode & O_RDONLY ) )
+    {
+      mError = this->ERR_BAD_ARG;
+      this->close();
+      return false;
+    }
+    else if ( !readSegmentHeader( 0, header ) || ( header.segmentSize < minSize ) )
+    {
+      mError = this->ERR_BAD_FORMAT;
+      this->close();
+      return false;
+    }
+
+    mSegmentSize  = header.segmentSize;
+    mSegmentLimit = header.segmentRecords;
+    scanTail();
+    return true;
+  }
+
+
+  void RecordLog::close()
+  {
+    if ( mIsOpen )
+    {
+      fclose( mFileId );
+      mFileId = -1;
+      mIsOpen = false;
+    }
+  }
+
+
+  bool RecordLog::append( const void *const data, const size_t size, const uint32_t timestamp )
+  {
+    /*-------------------------------------------------------------------------
+    Input protection
+    -------------------------------------------------------------------------*/
+    if ( !data || !size )
+    {
+      mError = this->ERR_BAD_ARG;
+      return false;
+    }
+    else if ( !mIsOpen || !mWritable )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return false;
+    }
+    else if ( size > ( mSegmentSize - sizeof( SegmentHeader ) - sizeof( RecordHeader ) ) )
+    {
+      mError = this->ERR_SIZING;
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Close out the last segment if the record, plus an index point if one is
+    due, won't fit
+    -------------------------------------------------------------------------*/
+    const size_t frameSize = sizeof( RecordHeader ) + size;
+    const bool   indexDue  = mSegmentLimit && ( mSegmentCount >= mSegmentLimit );
+    const size_t needed    = frameSize + ( indexDue ? sizeof( IndexHeader ) : 0u );
+    size_t       used      = mEnd % mSegmentSize;
+
+    if ( ( used != 0 ) && ( mSealed || ( ( mSegmentSize - used ) < needed ) ) )
+    {
+      if ( !padSegment() )
+      {
+        return false;
+      }
+
+      used = 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    New segments start with the index header for the record about to be added
+    -------------------------------------------------------------------------*/
+    if ( used == 0 )
+    {
+      SegmentHeader segment;
+      segment.magic          = SEGMENT_MAGIC;
+      segment.version        = FORMAT_VERSION;
+      segment.segmentSize    = static_cast<uint32_t>( mSegmentSize );
+      segment.segmentRecords = static_cast<uint32_t>( mSegmentLimit );
+      segment.sequence       = static_cast<uint32_t>( mEnd / mSegmentSize );
+      segment.firstTime      = timestamp;
+      segment.lastIndex      = static_cast<uint32_t>( mLastIndex % mSegmentSize );
+
+      etl::crc32 crc;
+      crc.reset();
+      add_header_crc( crc, segment );
+      segment.crc = crc.value();
+
+      if ( !writeAt( mEnd, &segment, sizeof( segment ) ) )
+      {
+        mEnd    = fsize( mFileId );
+        mSealed = true;
+        return false;
+      }
+
+      mLastIndex = mEnd;
+      mEnd += sizeof( segment );
+      mSegmentCount = 0;
+      mSealed       = false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Otherwise drop an index point in-line every N records
+    -------------------------------------------------------------------------*/
+    else if ( indexDue )
+    {
+      IndexHeader index;
+      index.magic     = INDEX_MAGIC;
+      index.firstTime = timestamp;
+      index.previous  = static_cast<uint32_t>( mLastIndex % mSegmentSize );
+
+      etl::crc32 crc;
+      crc.reset();
+      add_header_crc( crc, index );
+      index.crc = crc.value();
+
+      if ( !writeAt( mEnd, &index, sizeof( index ) ) )
+      {
+        mEnd    = fsize( mFileId );
+        mSealed = true;
+        return false;
+      }
+
+      mLastIndex = mEnd;
+      mEnd += sizeof( index );
+      mSegmentCount = 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    Write the record itself
+    -------------------------------------------------------------------------*/
+    RecordHeader record;
+    record.magic     = RECORD_MAGIC;
+    record.length    = static_cast<uint32_t>( size );
+    record.timestamp = timestamp;
+
+    auto       userData = reinterpret_cast<const uint8_t *const>( data );
+    etl::crc32 crc;
+    crc.reset();
+    add_header_crc( crc, record );
+    crc.add( userData, userData + size );
+    record.crc = crc.value();
+
+    if ( !writeAt( mEnd, &record, sizeof( record ) ) || !writeAt( mEnd + sizeof( record ), data, size ) )
+    {
+      /*-----------------------------------------------------------------------
+      Some of the record may have landed. Don't let anything else share its
+      segment, since readers can't see past it.
+      -----------------------------------------------------------------------*/
+      mEnd    = fsize( mFileId );
+      mSealed = true;
+      return false;
+    }
+
+    mEnd += frameSize;
+    mSegmentCount++;
+    return true;
+  }
+
+
+  bool RecordLog::read( void *const buffer, const size_t size, size_t &length, uint32_t &timestamp )
+  {
+    /*-------------------------------------------------------------------------
+    Input protection
+    -------------------------------------------------------------------------*/
+    if ( !buffer )
+    {
+      mError = this->ERR_BAD_ARG;
+      return false;
+    }
+    else if ( !mIsOpen )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Pull out the next record that checks out. Corrupt ones take the rest of
+    their segment with them, as the length can't be trusted to find the next.
+    -------------------------------------------------------------------------*/
+    RecordHeader record;
+    while ( nextRecord( record ) )
+    {
+      length    = record.length;
+      timestamp = record.timestamp;
+
+      if ( record.length > size )
+      {
+        mError = this->ERR_SIZING;
+        return false;
+      }
+
+      if ( !readAt( mReadPos + sizeof( record ), buffer, record.length ) )
+      {
+        return false;
+      }
+
+      auto       userData = reinterpret_cast<const uint8_t *const>( buffer );
+      etl::crc32 crc;
+      crc.reset();
+      add_header_crc( crc, record );
+      crc.add( userData, userData + record.length );
+
+      if ( crc.value() == record.crc )
+      {
+        mReadPos += sizeof( record ) + record.length;
+        return true;
+      }
+
+      mError   = this->ERR_CRC_FAIL;
+      mReadPos = ( ( mReadPos / mSegmentSize ) + 1u ) * mSegmentSize;
+    }
+
+    return false;
+  }
+
+
+  bool RecordLog::seek( const uint32_t timestamp )
+  {
+    if ( !mIsOpen )
+    {
+      mError = this->ERR_NOT_OPEN;
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Binary search for the last segment starting before the timestamp. Equal
+    timestamps may spill over from the segment before, so they don't count.
+    Segments with an unreadable header steer the search earlier, which only
+    costs a longer scan below.
+    -------------------------------------------------------------------------*/
+    const size_t segments = ( mEnd + mSegmentSize - 1u ) / mSegmentSize;
+    size_t       lo       = 0;
+    size_t       hi       = segments;
+
+    while ( ( hi - lo ) > 1u )
+    {
+      const size_t  mid = lo + ( ( hi - lo ) / 2u );
+      SegmentHeader header;
+
+      if ( readSegmentHeader( mid, header ) && ( header.firstTime < timestamp ) )
+      {
+        lo = mid;
+      }
+      else
+      {
+        hi = mid;
+      }
+    }
+
+    /*-------------------------------------------------------------------------
+    Narrow it down to the last index point in that segment before the
+    timestamp. The chain starts from the next segment's header, or from the
+    writer's own position in the last segment. A damaged index point falls
+    back to the start of the segment.
+    -------------------------------------------------------------------------*/
+    const size_t  base  = lo * mSegmentSize;
+    size_t        point = 0;
+    SegmentHeader next;
+    IndexHeader   index;
+
+    if ( readSegmentHeader( lo + 1u, next ) )
+    {
+      point = next.lastIndex;
+    }
+    else if ( ( lo + 1u ) == segments )
+    {
+      point = mLastIndex - base;
+    }
+
+    while ( point && ( point < mSegmentSize ) )
+    {
+      if ( !readIndexHeader( base + point, index ) )
+      {
+        point = 0;
+        break;
+      }
+
+      if ( index.firstTime < timestamp )
+      {
+        break;
+      }
+
+      point = index.previous;
+    }
+
+    /*-------------------------------------------------------------------------
+    Walk the record headers forward to the first one that's new enough
+    -------------------------------------------------------------------------*/
+    RecordHeader record;
+    mReadPos = ( point < mSegmentSize ) ? ( base + point ) : base;
+
+    while ( nextRecord( record ) )
+    {
+      if ( record.timestamp >= timestamp )
+      {
+        return true;
+      }
+
+      mReadPos += sizeof( record ) + record.length;
+    }
+
+    return false;
+  }
+
+
+  void RecordLog::rewind()
+  {
+    mReadPos = 0;
+  }
+
+
+  RecordLog::ECode RecordLog::getError()
+  {
+    return mError;
+  }
+
+
+  void RecordLog::clearErrors()
+  {
+    mError = ERR_OK;
+  }
+
+
+  /**
+   * @brief Reads from an absolute position in the file
+   *
+   * @param offset    Byte offset to read from
+   * @param data      Buffer to read into
+   * @param size      Number of bytes to read
+   * @return bool
+   */
+  bool RecordLog::readAt( const size_t offset, void *const data, const size_t size )
+  {
+    if ( ( fseek( mFileId, offset, F_SEEK_SET ) != 0 ) || ( fread( data, 1, size, mFileId ) != size ) )
+    {
+      mError = this->ERR_READ_FAIL;
+      return false;
+    }
+
+    return true;
+  }
+
+
+  /**
+   * @brief Writes to an absolute position in the file
+   *
+   * @param offset    Byte offset to write to
+   * @param data      Data to write
+   * @param size      Number of bytes to write
+   * @return bool
+   */
+  bool RecordLog::writeAt( const size_t offset, const void *const data, const size_t size )
+  {
+    if ( ( fseek( mFileId, offset, F_SEEK_SET ) != 0 ) || ( fwrite( data, 1, size, mFileId ) != size ) )
+    {
+      mError = this->ERR_WRITE_FAIL;
+      return false;
+    }
+
+    return true;
+  }
+
+
+  /**
+   * @brief Reads and validates the index header of a segment
+   *
+   * @param segment   Segment number
+   * @param header    Output for the header
+   * @return bool     True if the header is intact
+   */
+  bool RecordLog::readSegmentHeader( const size_t segment, SegmentHeader &header )
+  {
+    const size_t offset = segment * mSegmentSize;
+    if ( ( mEnd < sizeof( header ) ) || ( offset > ( mEnd - sizeof( header ) ) ) )
+    {
+      return false;
+    }
+
+    if ( ( fseek( mFileId, offset, F_SEEK_SET ) != 0 )
+         || ( fread( &header, 1, sizeof( header ), mFileId ) != sizeof( header ) ) )
+    {
+      return false;
+    }
+
+    etl::crc32 crc;
+    crc.reset();
+    add_header_crc( crc, header );
+
+    return ( header.magic == SEGMENT_MAGIC ) && ( header.version == FORMAT_VERSION ) && ( header.crc == crc.value() )
+           && ( header.sequence == segment );
+  }
+
+
+  /**
+   * @brief Moves the read position onto the next plausible record header
+   *
+   * Steps over segment headers and index points, and skips to the next segment
+   * on anything that isn't a record. The payload is not checked here.
+   *
+   * @param header    Output for the record header
+   * @return bool     False once the end of the log is reached
+   */
+  bool RecordLog::nextRecord( RecordHeader &header )
+  {
+    static_assert( sizeof( IndexHeader ) == sizeof( RecordHeader ) );
+
+    while ( ( mReadPos + sizeof( header ) ) <= mEnd )
+    {
+      const size_t used    = mReadPos % mSegmentSize;
+      const size_t nextSeg = mReadPos - used + mSegmentSize;
+
+      if ( used == 0 )
+      {
+        SegmentHeader segment;
+        mReadPos = readSegmentHeader( mReadPos / mSegmentSize, segment ) ? ( mReadPos + sizeof( segment ) ) : nextSeg;
+        continue;
+      }
+
+      if ( ( ( mSegmentSize - used ) < sizeof( header ) ) || !readAt( mReadPos, &header, sizeof( header ) ) )
+      {
+        mReadPos = nextSeg;
+        continue;
+      }
+
+      if ( header.magic == INDEX_MAGIC )
+      {
+        mReadPos += sizeof( IndexHeader );
+        continue;
+      }
+
+      if ( ( header.magic != RECORD_MAGIC ) || ( header.length > ( mSegmentSize - used - sizeof( header ) ) )
+           || ( ( mReadPos + sizeof( header ) + header.length ) > mEnd ) )
+      {
+        mReadPos = nextSeg;
+        continue;
+      }
+
+      return true;
+    }
+
+    mError = this->ERR_END_OF_LOG;
+    return false;
+  }
+
+
+  /**
+   * @brief Reads and validates an in-line index point
+   *
+   * @param offset    Byte offset of the index point
+   * @param header    Output for the header
+   * @return bool     True if the header is intact
+   */
+  bool RecordLog::readIndexHeader( const size_t offset, IndexHeader &header )
+  {
+    if ( ( ( offset + sizeof( header ) ) > mEnd ) || !readAt( offset, &header, sizeof( header ) ) )
+    {
+      return false;
+    }
+
+    etl::crc32 crc;
+    crc.reset();
+    add_header_crc( crc, header );
+
+    return ( header.magic == INDEX_MAGIC ) && ( header.crc == crc.value() )
+           && ( header.previous < ( offset % mSegmentSize ) );
+  }
+
+
+  /**
+   * @brief Zero fills the rest of the last segment so the next record starts a new one
+   *
+   * @return bool
+   */
+  bool RecordLog::padSegment()
+  {
+    size_t remaining = mSegmentSize - ( mEnd % mSegmentSize );
+
+    if ( fseek( mFileId, mEnd, F_SEEK_SET ) != 0 )
+    {
+      mError = this->ERR_WRITE_FAIL;
+      return false;
+    }
+
+    while ( remaining )
+    {
+      const size_t chunk = etl::min( remaining, FILL_SIZE );
+      if ( fwrite( s_fill, 1, chunk, mFileId ) != chunk )
+      {
+        mError = this->ERR_WRITE_FAIL;
+        mEnd   = fsize( mFileId );
+        return false;
+      }
+
+      mEnd += chunk;
+      remaining -= chunk;
+    }
+
+    return true;
+  }
+
+
+  /**
+   * @brief Works out where appending picks up in an existing log
+   *
+   * Walks the headers of the last segment. If they run cleanly up to the end
+   * of the file, appending continues in that segment. Otherwise it ends in a
+   * torn write and gets sealed. Either way, the last index point and the count
+   * of records since it are recovered.
+   */
+  void RecordLog::scanTail()
+  {
+    const size_t  start = ( ( mEnd - 1u ) / mSegmentSize ) * mSegmentSize;
+    size_t        pos   = start + sizeof( SegmentHeader );
+    SegmentHeader segment;
+
+    mSealed       = true;
+    mSegmentCount = 0;
+    mLastIndex    = start;
+
+    if ( !readSegmentHeader( start / mSegmentSize, segment ) )
+    {
+      return;
+    }
+
+    while ( pos < mEnd )
+    {
+      RecordHeader record;
+      IndexHeader  index;
+
+      if ( ( ( mEnd - pos ) < sizeof( record ) ) || !readAt( pos, &record, sizeof( record ) ) )
+      {
+        return;
+      }
+
+      if ( record.magic == INDEX_MAGIC )
+      {
+        if ( !readIndexHeader( pos, index ) )
+        {
+          return;
+        }
+
+        mLastIndex    = pos;
+        mSegmentCount = 0;
+        pos += sizeof( index );
+        continue;
+      }
+
+      if ( ( record.magic != RECORD_MAGIC ) || ( record.length > ( mEnd - pos - sizeof( record ) ) ) )
+      {
+        return;
+      }
+
+      pos += sizeof( record ) + record.length;
+      mSegmentCount++;
+    }
+
+    mSealed = false;
+  }
+}  // namespace Aurora::FileSystem
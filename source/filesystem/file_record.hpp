@@ -0,0 +1,199 @@
+/******************************************************************************
+ *  File Name:
+ *    file_record.hpp
+ *
+ *  Description:
+ *    Append-only record log with a sparse time index
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_RECORD_FILES_HPP
+#define AURORA_RECORD_FILES_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/filesystem/file_types.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/*-----------------------------------------------------------------------------
+Literal Constants
+-----------------------------------------------------------------------------*/
+#if !defined( AURORA_PRJ_FS_RECORD_SEGMENT_SIZE )
+#define AURORA_PRJ_FS_RECORD_SEGMENT_SIZE ( 64 * 1024 )
+#endif
+
+namespace Aurora::FileSystem
+{
+  /**
+   * @brief Context managed file interface to a log of timestamped records
+   *
+   * The file is split into fixed size segments. Every segment opens with an
+   * index header holding the timestamp of its first record, followed by as
+   * many records as fit. Each record has its own length, timestamp, and CRC.
+   * Records never straddle a segment boundary. Whatever space is left at the
+   * end of a segment is zero filled.
+   *
+   * With a record limit, a small index point is also written in-line every N
+   * records. Each one links back to the one before it, and the next segment
+   * header links to the last one, so no space is padded out to get them.
+   *
+   * Seeking to a point in time is a binary search over the segment headers,
+   * a walk back along the index points of one segment, and a scan of at most
+   * N records, rather than a scan of the whole file. Timestamps are expected
+   * to never decrease.
+   *
+   * Readers skip to the next segment whenever they hit something that isn't a
+   * valid record, so a torn write only costs the rest of its segment. A log
+   * reopened for writing keeps filling its last segment unless it ends in a
+   * torn record, in which case appending starts in a fresh segment.
+   */
+  class RecordLog
+  {
+  public:
+    enum ECode : uint8_t
+    {
+      ERR_OK,         /**< No error */
+      ERR_BAD_ARG,    /**< Invalid argument passed to function */
+      ERR_CRC_FAIL,   /**< A record was corrupted */
+      ERR_WRITE_FAIL, /**< Data write reported a failure */
+      ERR_READ_FAIL,  /**< Data failed to be read */
+      ERR_NO_FILE,    /**< The file doesn't exist */
+      ERR_NOT_OPEN,   /**< The file isn't open */
+      ERR_SIZING,     /**< Record doesn't fit the segment or the user's buffer */
+      ERR_BAD_FORMAT, /**< The file isn't a record log */
+      ERR_END_OF_LOG, /**< No more records to read */
+    };
+
+    RecordLog();
+    ~RecordLog();
+
+    /**
+     * @brief Opens a log, creating it if the file is empty
+     *
+     * The segment settings only apply to new logs. Existing logs keep the
+     * settings they were created with, which are read back from the file, so
+     * appending to an existing log needs O_RDWR. O_WRONLY is rejected.
+     *
+     * @param filename        Name of the file to open
+     * @param mode            Mode to open the file in
+     * @param segmentSize     Bytes per segment, which also bounds the record size
+     * @param segmentRecords  Records between index points, or zero for none
+     * @return true           File successfully opened
+     * @return false          An error occurred, see getError()
+     */
+    bool open( const std::string_view &filename, const AccessFlags mode,
+               const size_t segmentSize = AURORA_PRJ_FS_RECORD_SEGMENT_SIZE, const size_t segmentRecords = 0 );
+
+    /**
+     * @brief Closes the file
+     * @note If already closed, does nothing.
+     */
+    void close();
+
+    /**
+     * @brief Adds a record to the end of the log
+     *
+     * @param data            Record payload
+     * @param size            Payload size in bytes
+     * @param timestamp       Time the record was captured
+     * @return true           Write completed successfully
+     * @return false          An error occurred, see getError()
+     */
+    bool append( const void *const data, const size_t size, const uint32_t timestamp );
+
+    /**
+     * @brief Reads the next record and advances past it
+     *
+     * @param buffer          Buffer to read the payload into
+     * @param size            Size of the buffer
+     * @param length          Output for the payload size. Set even if the buffer is too small.
+     * @param timestamp       Output for the record timestamp
+     * @return true           A record was read
+     * @return false          An error occurred, see getError(). ERR_END_OF_LOG when done.
+     */
+    bool read( void *const buffer, const size_t size, size_t &length, uint32_t &timestamp );
+
+    /**
+     * @brief Positions the reader on the first record at or after a time
+     *
+     * @param timestamp       Time to search for
+     * @return true           A matching record exists
+     * @return false          Every record is older, or an error occurred
+     */
+    bool seek( const uint32_t timestamp );
+
+    /**
+     * @brief Positions the reader on the first record in the log
+     */
+    void rewind();
+
+    /**
+     * @brief Retrieves the last error that occurred
+     *
+     * @return ECode
+     */
+    ECode getError();
+
+    /**
+     * @brief Clears any set error codes
+     */
+    void clearErrors();
+
+  protected:
+    struct SegmentHeader
+    {
+      uint32_t magic;          /**< Marks the start of a segment */
+      uint32_t version;        /**< Log format version */
+      uint32_t segmentSize;    /**< Bytes per segment */
+      uint32_t segmentRecords; /**< Records between index points, zero if none */
+      uint32_t sequence;       /**< Segment number within the file */
+      uint32_t firstTime;      /**< Timestamp of the first record in the segment */
+      uint32_t lastIndex;      /**< Where the last index point of the previous segment sits within it */
+      uint32_t crc;            /**< CRC of the fields above */
+    };
+
+    struct IndexHeader
+    {
+      uint32_t magic;     /**< Marks an in-line index point */
+      uint32_t firstTime; /**< Timestamp of the record that follows */
+      uint32_t previous;  /**< Where the index point before this one sits within the segment */
+      uint32_t crc;       /**< CRC of the fields above */
+    };
+
+    struct RecordHeader
+    {
+      uint32_t magic;     /**< Marks the start of a record */
+      uint32_t length;    /**< Payload size in bytes */
+      uint32_t timestamp; /**< Time the record was captured */
+      uint32_t crc;       /**< CRC of the fields above and the payload */
+    };
+
+  private:
+    bool     mIsOpen;
+    bool     mWritable;
+    bool     mSealed;        /**< The last segment takes no more records */
+    FileId   mFileId;
+    ECode    mError;
+    size_t   mSegmentSize;   /**< Bytes per segment */
+    size_t   mSegmentLimit;  /**< Records between index points, zero if none */
+    size_t   mSegmentCount;  /**< Records since the last index point */
+    size_t   mLastIndex;     /**< Offset of the last index point or segment header */
+    size_t   mEnd;           /**< Size of the file */
+    size_t   mReadPos;       /**< Offset of the next byte to read */
+
+    bool readAt( const size_t offset, void *const data, const size_t size );
+    bool writeAt( const size_t offset, const void *const data, const size_t size );
+    bool readSegmentHeader( const size_t segment, SegmentHeader &header );
+    bool readIndexHeader( const size_t offset, IndexHeader &header );
+    bool nextRecord( RecordHeader &header );
+    bool padSegment();
+    void scanTail();
+  };
+}  // namespace Aurora::FileSystem
+
+#endif /* !AURORA_RECORD_FILES_HPP */
@@ -54,6 +54,33 @@ namespace Aurora::FileSystem
   using VolumeId = int;   /**< Identifier for a specific volume */
   using FileId   = int;   /**< Identifier for a specific file */
 
+  /*---------------------------------------------------------------------------
+  Descriptor Encoding
+  ---------------------------------------------------------------------------*/
+  /**
+   * A FileId holds the index of its slot in the open file table in the low
+   * bits, and a generation count above that. Reusing a slot bumps the
+   * generation, so a stale descriptor never aliases a newer file.
+   */
+  static constexpr FileId FILE_SLOT_BITS = 8;
+  static constexpr FileId FILE_SLOT_MSK  = ( 1 << FILE_SLOT_BITS ) - 1;
+  static constexpr FileId FILE_GEN_MSK   = 0x7FFFFF;
+
+  static_assert( MAX_OPEN_FILES <= ( FILE_SLOT_MSK + 1 ) );
+
+  /**
+   * @brief Gets the open file table slot a descriptor refers to
+   *
+   * Drivers may use this to index their own per-file tables directly.
+   *
+   * @param file    Descriptor to decode
+   * @return size_t
+   */
+  static constexpr size_t fileSlot( const FileId file )
+  {
+    return static_cast<size_t>( file & FILE_SLOT_MSK );
+  }
+
   /*---------------------------------------------------------------------------
   Enumerations
   ---------------------------------------------------------------------------*/
@@ -81,6 +108,13 @@ namespace Aurora::FileSystem
     F_SEEK_END
   };
 
+  enum BufferMode : uint32_t
+  {
+    F_IONBF, /**< Unbuffered, every call goes to the driver */
+    F_IOLBF, /**< Line buffered, writes are flushed on a newline */
+    F_IOFBF  /**< Fully buffered, the driver sees buffer sized transfers */
+  };
+
 #if defined( SIMULATOR )
   static_assert( F_SEEK_SET == SEEK_SET );
   static_assert( F_SEEK_CUR == SEEK_CUR );
@@ -3,45 +3,169 @@
  *    generic_driver.cpp
  *
  *  Description:
- *    A very thin wrapper around stdio file operations
+ *    Host filesystem driver built on POSIX file descriptors
  *
- *  2021-2022 | Brandon Braun | brandonbraun653@gmail.com
+ *  2021-2023 | Brandon Braun | brandonbraun653@gmail.com
  *****************************************************************************/
 
 /*-----------------------------------------------------------------------------
 Includes
 -----------------------------------------------------------------------------*/
-#include <cstdio>
-#include <string>
-#include <map>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*-----------------------------------------------------------------------------
+The POSIX open flags are macros that collide with AccessFlags. Keep their
+values, then get them out of the way before the Aurora headers are parsed.
+-----------------------------------------------------------------------------*/
+static constexpr int POSIX_O_RDONLY = O_RDONLY;
+static constexpr int POSIX_O_WRONLY = O_WRONLY;
+static constexpr int POSIX_O_RDWR   = O_RDWR;
+static constexpr int POSIX_O_CREAT  = O_CREAT;
+static constexpr int POSIX_O_EXCL   = O_EXCL;
+static constexpr int POSIX_O_TRUNC  = O_TRUNC;
+
+#undef O_RDONLY
+#undef O_WRONLY
+#undef O_RDWR
+#undef O_APPEND
+#undef O_CREAT
+#undef O_EXCL
+#undef O_TRUNC
+
 #include <Aurora/filesystem>
+#include <array>
 
 namespace Aurora::FileSystem::Generic
 {
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief An open host file
+   *
+   * The position is tracked here rather than in the kernel so every transfer
+   * is a single pread/pwrite.
+   */
+  struct File
+  {
+    int      fd;       /**< Host descriptor, negative if the slot is free */
+    FileId   fileDesc; /**< Aurora descriptor that owns the slot */
+    VolumeId volume;   /**< Volume the file was opened on */
+    off_t    position; /**< Current stream position */
+    bool     append;   /**< Every write goes to the end of the file */
+
+    inline void clear()
+    {
+      fd       = -1;
+      fileDesc = -1;
+      volume   = -1;
+      position = 0;
+      append   = false;
+    }
+  };
+
   /*---------------------------------------------------------------------------
   Static Data
   ---------------------------------------------------------------------------*/
-  static std::map<FileId, FILE *>        s_file_desc_map;
-  static std::map<uint32_t, std::string> s_mode_map;
+  static bool                             s_init;  /**< Module memory has been reset */
+  static std::array<File, MAX_OPEN_FILES> s_files; /**< Open files, indexed by descriptor slot */
 
   /*---------------------------------------------------------------------------
   Static Functions
   ---------------------------------------------------------------------------*/
-  static int initialize()
+  /**
+   * @brief Looks up the open file for a descriptor
+   *
+   * Each descriptor owns its slot while open, so lookups on different files
+   * never touch shared state and need no lock. A stale descriptor whose slot
+   * has since been reused by another file is rejected.
+   *
+   * @param stream    Descriptor to look up
+   * @return File*
+   */
+  static File *get_file( const FileId stream )
   {
+    const size_t slot = fileSlot( stream );
+    if ( ( stream < 0 ) || ( slot >= s_files.size() ) || ( s_files[ slot ].fd < 0 )
+         || ( s_files[ slot ].fileDesc != stream ) )
+    {
+      return nullptr;
+    }
+
+    return &s_files[ slot ];
+  }
+
+
+  /**
+   * @brief Translates Aurora access flags into POSIX open flags
+   *
+   * @param mode      Aurora flags
+   * @param flags     Output POSIX flags
+   * @return bool     False if the access mode is invalid
+   */
+  static bool to_posix_flags( const AccessFlags mode, int &flags )
+  {
+    switch ( mode & O_ACCESS_MSK )
+    {
+      case O_RDONLY:
+        flags = POSIX_O_RDONLY;
+        break;
+
+      case O_WRONLY:
+        flags = POSIX_O_WRONLY;
+        break;
+
+      case O_RDWR:
+        flags = POSIX_O_RDWR;
+        break;
+
+      default:
+        return false;
+    }
+
     /*-------------------------------------------------------------------------
-    Reset the module memory
+    O_APPEND is left out on purpose. Linux pwrite() ignores the offset on an
+    O_APPEND descriptor, so appending is handled in fwrite() instead.
     -------------------------------------------------------------------------*/
-    s_file_desc_map.clear();
-    s_mode_map.clear();
+    const uint32_t modifier = mode & O_MODIFY_MSK;
+    flags |= ( modifier & O_CREAT ) ? POSIX_O_CREAT : 0;
+    flags |= ( modifier & O_EXCL ) ? POSIX_O_EXCL : 0;
+    flags |= ( modifier & O_TRUNC ) ? POSIX_O_TRUNC : 0;
+
+    return true;
+  }
+
+
+  /**
+   * @brief Gets the current size of an open file
+   *
+   * @param file      File to inspect
+   * @return off_t    Size in bytes, negative on error
+   */
+  static off_t file_size( const File &file )
+  {
+    struct stat info;
+    return ( ::fstat( file.fd, &info ) == 0 ) ? info.st_size : -1;
+  }
+
 
+  static int initialize()
+  {
     /*-------------------------------------------------------------------------
-    Add the supported mode flag translations
+    Called on every mount, so keep files opened through other volumes
     -------------------------------------------------------------------------*/
-    s_mode_map.insert( std::pair( ( O_RDONLY ), "r" ) );
-    s_mode_map.insert( std::pair( ( O_WRONLY | O_CREAT ), "w" ) );
-    s_mode_map.insert( std::pair( ( O_APPEND | O_EXCL ), "w+" ) );
-    s_mode_map.insert( std::pair( ( O_WRONLY | O_EXCL ), "a" ) );
+    if ( !s_init )
+    {
+      for ( File &f : s_files )
+      {
+        f.clear();
+      }
+
+      s_init = true;
+    }
 
     return 0;
   }
@@ -55,11 +179,13 @@ namespace Aurora::FileSystem::Generic
 
   static int unmount( const VolumeId drive )
   {
-    while ( !s_file_desc_map.empty() )
+    for ( File &f : s_files )
     {
-      auto iter = s_file_desc_map.begin();
-      ::fclose( iter->second );
-      s_file_desc_map.erase( iter );
+      if ( ( f.fd >= 0 ) && ( f.volume == drive ) )
+      {
+        ::close( f.fd );
+        f.clear();
+      }
     }
 
     return 0;
@@ -68,107 +194,196 @@ namespace Aurora::FileSystem::Generic
 
   static int fopen( const char *filename, const AccessFlags mode, const FileId file, const VolumeId vol )
   {
-    auto mode_string = s_mode_map.at( mode );
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    const size_t slot  = fileSlot( file );
+    int          flags = 0;
+
+    if ( ( file < 0 ) || ( slot >= s_files.size() ) || ( s_files[ slot ].fd >= 0 ) || !to_posix_flags( mode, flags ) )
+    {
+      return -1;
+    }
 
-    FILE *f = ::fopen( filename, mode_string.data() );
-    s_file_desc_map.insert( std::pair( file, f ) );
+    /*-------------------------------------------------------------------------
+    Open the file
+    -------------------------------------------------------------------------*/
+    const int fd = ::open( filename, flags | O_CLOEXEC, 0644 );
+    if ( fd < 0 )
+    {
+      return -1;
+    }
 
+    File &f    = s_files[ slot ];
+    f.fd       = fd;
+    f.fileDesc = file;
+    f.volume   = vol;
+    f.append   = ( mode & O_APPEND );
     return 0;
   }
 
 
   static int fclose( FileId stream )
   {
-    auto iter = s_file_desc_map.find( stream );
-    if ( iter != s_file_desc_map.end() )
-    {
-      s_file_desc_map.erase( iter );
-      return ::fclose( iter->second );
-    }
-    else
+    File *f = get_file( stream );
+    if ( !f )
     {
       return -1;
     }
+
+    const int result = ::close( f->fd );
+    f->clear();
+    return ( result == 0 ) ? 0 : -1;
   }
 
 
   static int fflush( FileId stream )
   {
-    auto iter = s_file_desc_map.find( stream );
-    if ( iter != s_file_desc_map.end() )
-    {
-      return ::fflush( iter->second );
-    }
-    else
-    {
-      return -1;
-    }
+    /*-------------------------------------------------------------------------
+    Writes go straight to the OS, so there is nothing held back to push out
+    -------------------------------------------------------------------------*/
+    return get_file( stream ) ? 0 : -1;
   }
 
 
   static size_t fread( void *ptr, size_t size, size_t count, FileId stream )
   {
-    auto iter = s_file_desc_map.find( stream );
-    if ( iter != s_file_desc_map.end() )
+    File *f = get_file( stream );
+    if ( !f )
     {
-      return ::fread( ptr, size, count, iter->second );
+      return 0;
     }
-    else
+
+    uint8_t     *dst   = reinterpret_cast<uint8_t *>( ptr );
+    const size_t total = size * count;
+    size_t       done  = 0;
+
+    while ( done < total )
     {
-      return 0;
+      const ssize_t bytes = ::pread( f->fd, dst + done, total - done, f->position );
+      if ( ( bytes < 0 ) && ( errno == EINTR ) )
+      {
+        continue;
+      }
+      else if ( bytes <= 0 )
+      {
+        break;
+      }
+
+      done += static_cast<size_t>( bytes );
+      f->position += bytes;
     }
+
+    return done;
   }
 
 
   static size_t fwrite( const void *ptr, size_t size, size_t count, FileId stream )
   {
-    auto iter = s_file_desc_map.find( stream );
-    if ( iter != s_file_desc_map.end() )
+    File *f = get_file( stream );
+    if ( !f )
     {
-      return ::fwrite( ptr, size, count, iter->second );
+      return 0;
     }
-    else
+
+    if ( f->append )
     {
-      return 0;
+      const off_t end = file_size( *f );
+      if ( end < 0 )
+      {
+        return 0;
+      }
+
+      f->position = end;
+    }
+
+    const uint8_t *src   = reinterpret_cast<const uint8_t *>( ptr );
+    const size_t   total = size * count;
+    size_t         done  = 0;
+
+    while ( done < total )
+    {
+      const ssize_t bytes = ::pwrite( f->fd, src + done, total - done, f->position );
+      if ( ( bytes < 0 ) && ( errno == EINTR ) )
+      {
+        continue;
+      }
+      else if ( bytes <= 0 )
+      {
+        break;
+      }
+
+      done += static_cast<size_t>( bytes );
+      f->position += bytes;
     }
+
+    return done;
   }
 
 
   static int fseek( FileId stream, size_t offset, const WhenceFlags whence )
   {
-    auto iter = s_file_desc_map.find( stream );
-    if ( iter != s_file_desc_map.end() )
+    File *f = get_file( stream );
+    if ( !f )
     {
-      return ::fseek( iter->second, offset, whence );
+      return -1;
     }
-    else
+
+    off_t base = 0;
+    switch ( whence )
     {
-      return 0;
+      case F_SEEK_SET:
+        break;
+
+      case F_SEEK_CUR:
+        base = f->position;
+        break;
+
+      case F_SEEK_END:
+        base = file_size( *f );
+        break;
+
+      default:
+        return -1;
+    }
+
+    if ( base < 0 )
+    {
+      return -1;
     }
+
+    f->position = base + static_cast<off_t>( offset );
+    return 0;
   }
 
 
   static size_t ftell( FileId stream )
   {
-    auto iter = s_file_desc_map.find( stream );
-    if ( iter != s_file_desc_map.end() )
-    {
-      return ::ftell( iter->second );
-    }
-    else
+    File *f = get_file( stream );
+    return f ? static_cast<size_t>( f->position ) : 0;
+  }
+
+
+  static void frewind( FileId stream )
+  {
+    File *f = get_file( stream );
+    if ( f )
     {
-      return 0;
+      f->position = 0;
     }
   }
 
 
-  static void frewind( FileId stream )
+  static size_t fsize( const FileId stream )
   {
-    auto iter = s_file_desc_map.find( stream );
-    if ( iter != s_file_desc_map.end() )
+    File *f = get_file( stream );
+    if ( !f )
     {
-      ::rewind( iter->second );
+      return 0;
     }
+
+    const off_t size = file_size( *f );
+    return ( size < 0 ) ? 0 : static_cast<size_t>( size );
   }
 
   /*---------------------------------------------------------------------------
@@ -190,6 +405,7 @@ namespace Aurora::FileSystem::Generic
     intf.fseek      = ::Aurora::FileSystem::Generic::fseek;
     intf.ftell      = ::Aurora::FileSystem::Generic::ftell;
     intf.frewind    = ::Aurora::FileSystem::Generic::frewind;
+    intf.fsize      = ::Aurora::FileSystem::Generic::fsize;
 
     return intf;
   }
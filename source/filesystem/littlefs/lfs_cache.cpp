@@ -0,0 +1,288 @@
+/******************************************************************************
+ *  File Name:
+ *    lfs_cache.cpp
+ *
+ *  Description:
+ *    Write-through LRU block cache implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/filesystem/littlefs/lfs_cache.hpp>
+#include <cstring>
+#include <etl/algorithm.h>
+
+namespace Aurora::FileSystem::LFS
+{
+  /*---------------------------------------------------------------------------
+  Aliases
+  ---------------------------------------------------------------------------*/
+  namespace AM = Aurora::Memory;
+
+  /*---------------------------------------------------------------------------
+  Class Implementation
+  ---------------------------------------------------------------------------*/
+  BlockCache::BlockCache() : mPool( nullptr ), mNumLines( 0 ), mLineSize( 0 ), mTick( 0 )
+  {
+    invalidate();
+    resetStats();
+  }
+
+
+  bool BlockCache::configure( void *const pool, const size_t poolSize, const size_t lineSize, const size_t blockSize )
+  {
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( !pool || !lineSize || !blockSize || ( blockSize % lineSize ) || ( poolSize < lineSize ) )
+    {
+      return false;
+    }
+
+    mPool      = reinterpret_cast<uint8_t *>( pool );
+    mNumLines  = etl::min( poolSize / lineSize, mLines.size() );
+    mLineSize  = lineSize;
+
+    invalidate();
+    resetStats();
+    return true;
+  }
+
+
+  bool BlockCache::enabled() const
+  {
+    return mPool && mNumLines;
+  }
+
+
+  void BlockCache::invalidate()
+  {
+    for ( Line &line : mLines )
+    {
+      line.valid   = false;
+      line.lastUse = 0;
+    }
+
+    mTick = 0;
+  }
+
+
+  void BlockCache::invalidate( const size_t block )
+  {
+    for ( Line &line : mLines )
+    {
+      if ( line.valid && ( line.block == block ) )
+      {
+        line.valid   = false;
+        line.lastUse = 0;
+      }
+    }
+  }
+
+
+  AM::Status BlockCache::read( AM::IGenericDevice &device, const size_t block, const size_t offset, void *const data,
+                               const size_t length )
+  {
+    /*-------------------------------------------------------------------------
+    Large reads would only flush out the useful lines, so send them straight
+    to the device instead.
+    -------------------------------------------------------------------------*/
+    if ( !enabled() || ( length > ( mNumLines * mLineSize ) ) )
+    {
+      mStats.bypassed += enabled() ? 1u : 0u;
+      return device.read( block, offset, data, length );
+    }
+
+    /*-------------------------------------------------------------------------
+    Copy out one line at a time, filling any that are missing
+    -------------------------------------------------------------------------*/
+    uint8_t *dst       = reinterpret_cast<uint8_t *>( data );
+    size_t   position  = offset;
+    size_t   remaining = length;
+
+    while ( remaining )
+    {
+      const size_t index   = position / mLineSize;
+      const size_t lineOff = position % mLineSize;
+      const size_t chunk   = etl::min( remaining, mLineSize - lineOff );
+
+      Line *line = find( block, index );
+      if ( line )
+      {
+        mStats.hits++;
+      }
+      else
+      {
+        mStats.misses++;
+        line        = replace();
+        line->valid = false;
+
+        auto result = device.read( block, index * mLineSize, lineData( line - mLines.begin() ), mLineSize );
+        if ( result != AM::Status::ERR_OK )
+        {
+          return result;
+        }
+
+        line->block = static_cast<uint32_t>( block );
+        line->index = static_cast<uint32_t>( index );
+        line->valid = true;
+      }
+
+      touch( *line );
+      memcpy( dst, lineData( line - mLines.begin() ) + lineOff, chunk );
+
+      dst += chunk;
+      position += chunk;
+      remaining -= chunk;
+    }
+
+    return AM::Status::ERR_OK;
+  }
+
+
+  void BlockCache::program( const size_t block, const size_t offset, const void *const data, const size_t length )
+  {
+    if ( !enabled() )
+    {
+      return;
+    }
+
+    const uint8_t *src = reinterpret_cast<const uint8_t *>( data );
+    for ( size_t x = 0; x < mNumLines; x++ )
+    {
+      Line &line = mLines[ x ];
+      if ( !line.valid || ( line.block != block ) )
+      {
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Copy whatever part of the write overlaps this line
+      -----------------------------------------------------------------------*/
+      const size_t lineStart = line.index * mLineSize;
+      const size_t start     = etl::max( lineStart, offset );
+      const size_t end       = etl::min( lineStart + mLineSize, offset + length );
+
+      if ( start < end )
+      {
+        memcpy( lineData( x ) + ( start - lineStart ), src + ( start - offset ), end - start );
+      }
+    }
+  }
+
+
+  void BlockCache::erase( const size_t block )
+  {
+    if ( !enabled() )
+    {
+      return;
+    }
+
+    /*-------------------------------------------------------------------------
+    Erased NOR reads back as all ones, so the lines stay valid
+    -------------------------------------------------------------------------*/
+    for ( size_t x = 0; x < mNumLines; x++ )
+    {
+      if ( mLines[ x ].valid && ( mLines[ x ].block == block ) )
+      {
+        memset( lineData( x ), 0xFF, mLineSize );
+      }
+    }
+  }
+
+
+  CacheStats BlockCache::getStats() const
+  {
+    return mStats;
+  }
+
+
+  void BlockCache::resetStats()
+  {
+    memset( &mStats, 0, sizeof( mStats ) );
+  }
+
+
+  /**
+   * @brief Marks a line as the most recently used
+   *
+   * @param line      Line that was accessed
+   */
+  void BlockCache::touch( Line &line )
+  {
+    /*-------------------------------------------------------------------------
+    Restart the ordering if the tick wraps, rather than evicting hot lines
+    -------------------------------------------------------------------------*/
+    if ( ++mTick == 0 )
+    {
+      for ( Line &iter : mLines )
+      {
+        iter.lastUse = 0;
+      }
+
+      mTick = 1;
+    }
+
+    line.lastUse = mTick;
+  }
+
+
+  uint8_t *BlockCache::lineData( const size_t line ) const
+  {
+    return mPool + ( line * mLineSize );
+  }
+
+
+  /**
+   * @brief Looks up the line holding part of a block
+   *
+   * @param block     Device block
+   * @param index     Line number within the block
+   * @return Line*    The line, or nullptr if not cached
+   */
+  BlockCache::Line *BlockCache::find( const size_t block, const size_t index )
+  {
+    for ( size_t x = 0; x < mNumLines; x++ )
+    {
+      Line &line = mLines[ x ];
+      if ( line.valid && ( line.block == block ) && ( line.index == index ) )
+      {
+        return &line;
+      }
+    }
+
+    return nullptr;
+  }
+
+
+  /**
+   * @brief Picks the line to fill next: an empty one if available, otherwise
+   * the least recently used.
+   *
+   * @return Line*
+   */
+  BlockCache::Line *BlockCache::replace()
+  {
+    Line *victim = &mLines[ 0 ];
+
+    for ( size_t x = 0; x < mNumLines; x++ )
+    {
+      Line &line = mLines[ x ];
+      if ( !line.valid )
+      {
+        return &line;
+      }
+
+      if ( line.lastUse < victim->lastUse )
+      {
+        victim = &line;
+      }
+    }
+
+    mStats.evictions++;
+    return victim;
+  }
+}  // namespace Aurora::FileSystem::LFS
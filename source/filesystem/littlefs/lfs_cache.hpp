@@ -0,0 +1,163 @@
+/******************************************************************************
+ *  File Name:
+ *    lfs_cache.hpp
+ *
+ *  Description:
+ *    Write-through LRU block cache between LittleFS and a memory device
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef LFS_CACHE_HPP
+#define LFS_CACHE_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/memory/generic/generic_intf.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <etl/array.h>
+
+/*-----------------------------------------------------------------------------
+Literal Constants
+-----------------------------------------------------------------------------*/
+#if !defined( AURORA_PRJ_FS_LFS_CACHE_LINES )
+#define AURORA_PRJ_FS_LFS_CACHE_LINES ( 16 )
+#endif
+
+namespace Aurora::FileSystem::LFS
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t MAX_CACHE_LINES = AURORA_PRJ_FS_LFS_CACHE_LINES;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  struct CacheStats
+  {
+    uint32_t hits;      /**< Line accesses served from RAM */
+    uint32_t misses;    /**< Line accesses that went to the device */
+    uint32_t evictions; /**< Valid lines replaced to make room */
+    uint32_t bypassed;  /**< Reads too large to cache */
+  };
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Caches fixed size lines of device blocks in user supplied RAM
+   *
+   * Reads are served from the cache when possible and fill a line from the
+   * device otherwise, evicting the least recently used line. Programs and
+   * erases always go to the device first, then the cached copy is updated, so
+   * the device never holds stale data.
+   *
+   * The cache has no lock of its own. Callers must hold the device lock,
+   * which the LFS driver already does for every block operation.
+   */
+  class BlockCache
+  {
+  public:
+    BlockCache();
+
+    /**
+     * @brief Assigns memory for the cache lines and enables the cache
+     *
+     * @param pool        Memory to hold the cached data
+     * @param poolSize    Size of the pool in bytes
+     * @param lineSize    Bytes per cache line. Must evenly divide the block size.
+     * @param blockSize   Size of a device block in bytes
+     * @return bool
+     */
+    bool configure( void *const pool, const size_t poolSize, const size_t lineSize, const size_t blockSize );
+
+    /**
+     * @brief Checks if the cache has memory assigned
+     * @return bool
+     */
+    bool enabled() const;
+
+    /**
+     * @brief Drops all cached data
+     */
+    void invalidate();
+
+    /**
+     * @brief Drops cached data for a single block
+     *
+     * Use when an operation on the block failed part way, leaving its device
+     * contents unknown.
+     *
+     * @param block       Block to forget
+     */
+    void invalidate( const size_t block );
+
+    /**
+     * @brief Reads from a block, going to the device only on a miss
+     *
+     * @param device      Device holding the block
+     * @param block       Block to read from
+     * @param offset      Offset within the block
+     * @param data        Buffer to read into
+     * @param length      Number of bytes to read
+     * @return Aurora::Memory::Status
+     */
+    Aurora::Memory::Status read( Aurora::Memory::IGenericDevice &device, const size_t block, const size_t offset,
+                                 void *const data, const size_t length );
+
+    /**
+     * @brief Updates cached lines after a successful program operation
+     *
+     * @param block       Block that was written
+     * @param offset      Offset within the block
+     * @param data        Data that was written
+     * @param length      Number of bytes written
+     */
+    void program( const size_t block, const size_t offset, const void *const data, const size_t length );
+
+    /**
+     * @brief Updates cached lines after a successful erase operation
+     *
+     * @param block       Block that was erased
+     */
+    void erase( const size_t block );
+
+    /**
+     * @brief Gets the hit/miss counters
+     * @return CacheStats
+     */
+    CacheStats getStats() const;
+
+    /**
+     * @brief Zeroes the hit/miss counters
+     */
+    void resetStats();
+
+  private:
+    struct Line
+    {
+      uint32_t block;   /**< Device block the line belongs to */
+      uint32_t index;   /**< Line number within the block */
+      uint32_t lastUse; /**< Access tick, for LRU replacement */
+      bool     valid;   /**< Line holds device data */
+    };
+
+    etl::array<Line, MAX_CACHE_LINES> mLines;     /**< Line bookkeeping */
+    uint8_t                          *mPool;      /**< Line data storage */
+    size_t                            mNumLines;  /**< Lines that fit in the pool */
+    size_t                            mLineSize;  /**< Bytes per line */
+    uint32_t                          mTick;      /**< Access counter */
+    CacheStats                        mStats;     /**< Performance counters */
+
+    void     touch( Line &line );
+    uint8_t *lineData( const size_t line ) const;
+    Line    *find( const size_t block, const size_t index );
+    Line    *replace();
+  };
+}  // namespace Aurora::FileSystem::LFS
+
+#endif /* !LFS_CACHE_HPP */
@@ -20,13 +20,15 @@ Includes
 #include <Chimera/thread>
 #include <cstdint>
 #include <etl/algorithm.h>
+#include <etl/array.h>
 #include <etl/flat_map.h>
 #include <etl/vector.h>
 
 #if defined( SIMULATOR )
 #include <cstdio>
-#include <fstream>
-#include <iostream>
+#include <filesystem>
+#include <sys/mman.h>
+#include <unistd.h>
 #endif
 
 namespace Aurora::FileSystem::LFS
@@ -57,11 +59,6 @@ namespace Aurora::FileSystem::LFS
     lfs_file_config lfsCfg;            /**< LFS config data due to not allowing malloc */
     uint8_t         lfsCfgBuff[ 256 ]; /**< Static buffer for config structure */
 
-    bool operator<( const File &rhs ) const
-    {
-      return fileDesc < rhs.fileDesc;
-    }
-
     inline void clear()
     {
       fileDesc = -1;
@@ -99,9 +96,9 @@ namespace Aurora::FileSystem::LFS
   Static Data
   ---------------------------------------------------------------------------*/
   static uint32_t                           s_init;    /**< Initialized key */
-  static Chimera::Thread::RecursiveMutex    s_lock;    /**< Module lock */
+  static Chimera::Thread::RecursiveMutex    s_lock;    /**< Guards the volume registry. Each volume has its own lock. */
   static etl::vector<Volume *, MAX_VOLUMES> s_volumes; /**< Registered volumes */
-  static etl::vector<File, MAX_OPEN_FILES>  s_files;   /**< Currently open files */
+  static etl::array<File, MAX_OPEN_FILES>   s_files;   /**< Open files, indexed by descriptor slot */
 
 
   /*---------------------------------------------------------------------------
@@ -115,6 +112,8 @@ namespace Aurora::FileSystem::LFS
    */
   static Volume *get_volume( VolumeId id )
   {
+    Chimera::Thread::LockGuard _lck( s_lock );
+
     for ( Volume *iter : s_volumes )
     {
       if ( iter->_volumeID == id )
@@ -134,15 +133,13 @@ namespace Aurora::FileSystem::LFS
    */
   static File *get_file( FileId stream )
   {
-    for ( File &f : s_files )
+    const size_t slot = fileSlot( stream );
+    if ( ( stream < 0 ) || ( slot >= s_files.size() ) || !s_files[ slot ].pVolume || ( s_files[ slot ].fileDesc != stream ) )
     {
-      if ( f.fileDesc == stream )
-      {
-        return &f;
-      }
+      return nullptr;
     }
 
-    return nullptr;
+    return &s_files[ slot ];
   }
 
 
@@ -161,127 +158,163 @@ namespace Aurora::FileSystem::LFS
 
 
 #if defined( SIMULATOR )
-  static int lfs_safe_read( const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size )
+  /**
+   * @brief Maps the volume's backing file into memory, creating it if needed
+   *
+   * The file is sized to match the simulated NOR device and filled with the
+   * erased state on creation. Block operations then become plain memory
+   * accesses on the shared mapping, which the kernel writes back to disk.
+   *
+   * @param vol     The volume to map
+   * @return uint8_t*   Start of the image, or nullptr on failure
+   */
+  static uint8_t *sim_map_image( Volume *const vol )
   {
-    RT_HARD_ASSERT( c->context );
-    Volume *vol = reinterpret_cast<Volume *>( c->context );
+    if ( vol->_image )
+    {
+      return vol->_image;
+    }
+
+    auto props = Aurora::Memory::Flash::NOR::getProperties( vol->flash.deviceType() );
+    RT_HARD_ASSERT( props );
 
     /*-------------------------------------------------------------------------
-    Calculate the absolute offset required to read from
+    Ensure the backing file exists with the expected properties
     -------------------------------------------------------------------------*/
-    size_t address = 0;
-    if ( !Aurora::Memory::Flash::NOR::block2Address( vol->flash.deviceType(), block, &address ) )
+    const size_t size   = props->endAddress;
+    bool         create = true;
+
+    if ( std::filesystem::exists( vol->_dataFile ) )
     {
-      LOG_TRACE( "Bad flash address\r\n" );
-      return LFS_ERR_INVAL;
+      const size_t actual = std::filesystem::file_size( vol->_dataFile );
+      if ( actual != size )
+      {
+        LOG_ERROR( "File size didn't match [%d != %d]. Destroying %s\r\n", size, actual, vol->_dataFile.c_str() );
+        std::filesystem::remove( vol->_dataFile );
+      }
+      else
+      {
+        create = false;
+      }
+    }
+    else
+    {
+      std::filesystem::create_directories( vol->_dataFile.parent_path() );
     }
-
-    address += off;
 
     /*-------------------------------------------------------------------------
-    Read from the file
+    Size the file in one step and map it. The mapping stays valid after the
+    stream is closed.
     -------------------------------------------------------------------------*/
-    FILE *file = ::fopen( vol->_dataFile.c_str(), "rb" );
-    RT_HARD_ASSERT( file );
+    FILE *file = ::fopen( vol->_dataFile.c_str(), create ? "wb+" : "rb+" );
+    if ( !file )
+    {
+      LOG_ERROR( "Unable to open %s\r\n", vol->_dataFile.c_str() );
+      return nullptr;
+    }
 
-    ::fseek( file, address, SEEK_SET );
-    RT_HARD_ASSERT( ::ftell( file ) == address );
+    void *image = MAP_FAILED;
+    if ( !create || ( ::ftruncate( ::fileno( file ), size ) == 0 ) )
+    {
+      image = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, ::fileno( file ), 0 );
+    }
 
-    size_t bytes_read = ::fread( buffer, 1, size, file );
     ::fclose( file );
 
-    if ( bytes_read != size )
+    if ( image == MAP_FAILED )
     {
-      LOG_TRACE( "Error reading from file: %d\r\n" );
-      return LFS_ERR_IO;
+      LOG_ERROR( "Unable to map %s\r\n", vol->_dataFile.c_str() );
+      return nullptr;
     }
 
-    return LFS_ERR_OK;
+    vol->_image     = reinterpret_cast<uint8_t *>( image );
+    vol->_imageSize = size;
+
+    if ( create )
+    {
+      memset( vol->_image, 0xFF, vol->_imageSize );
+    }
+
+    return vol->_image;
   }
 
 
-  static int lfs_safe_prog( const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size )
+  /**
+   * @brief Translates a block/offset pair into a pointer within the image
+   *
+   * @param c       LFS configuration holding the volume context
+   * @param block   Block being accessed
+   * @param off     Offset within the block
+   * @param size    Number of bytes being accessed
+   * @return uint8_t*   Location in the image, or nullptr if out of range
+   */
+  static uint8_t *sim_image_addr( const struct lfs_config *c, lfs_block_t block, lfs_off_t off, lfs_size_t size )
   {
     RT_HARD_ASSERT( c->context );
     Volume *vol = reinterpret_cast<Volume *>( c->context );
 
-    /*-------------------------------------------------------------------------
-    Calculate the absolute offset required to read from
-    -------------------------------------------------------------------------*/
     size_t address = 0;
     if ( !Aurora::Memory::Flash::NOR::block2Address( vol->flash.deviceType(), block, &address ) )
     {
       LOG_TRACE( "Bad flash address\r\n" );
-      return LFS_ERR_INVAL;
+      return nullptr;
     }
 
     address += off;
 
-    /*-------------------------------------------------------------------------
-    Write the file
-    -------------------------------------------------------------------------*/
-    FILE *file = ::fopen( vol->_dataFile.c_str(), "rb+" );
-    RT_HARD_ASSERT( file );
-    ::fseek( file, address, SEEK_SET );
+    uint8_t *image = sim_map_image( vol );
+    if ( !image || ( ( address + size ) > vol->_imageSize ) )
+    {
+      LOG_TRACE( "Access outside of image: %d\r\n", address );
+      return nullptr;
+    }
 
-    size_t bytes_written = ::fwrite( buffer, 1, size, file );
+    return image + address;
+  }
 
-    ::fflush( file );
-    ::fclose( file );
 
-    if ( bytes_written != size )
+  static int lfs_safe_read( const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer, lfs_size_t size )
+  {
+    const uint8_t *src = sim_image_addr( c, block, off, size );
+    if ( !src )
     {
-      LOG_TRACE( "Error writing to file: %d\r\n" );
       return LFS_ERR_IO;
     }
 
+    memcpy( buffer, src, size );
     return LFS_ERR_OK;
   }
 
 
-  static int lfs_safe_erase( const struct lfs_config *c, lfs_block_t block )
+  static int lfs_safe_prog( const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer, lfs_size_t size )
   {
-    RT_HARD_ASSERT( c->context );
-    Volume *vol = reinterpret_cast<Volume *>( c->context );
-
-    /*-------------------------------------------------------------------------
-    Calculate the absolute offset required to read from
-    -------------------------------------------------------------------------*/
-    size_t address = 0;
-    if ( !Aurora::Memory::Flash::NOR::block2Address( vol->flash.deviceType(), block, &address ) )
+    uint8_t *dst = sim_image_addr( c, block, off, size );
+    if ( !dst )
     {
-      LOG_TRACE( "Bad flash address\r\n" );
-      return LFS_ERR_INVAL;
+      return LFS_ERR_IO;
     }
 
-    /*-------------------------------------------------------------------------
-    Open the file
-    -------------------------------------------------------------------------*/
-    FILE *file = ::fopen( vol->_dataFile.c_str(), "rb+" );
-    ::fseek( file, address, SEEK_SET );
-
-    const uint8_t data          = 0xFF;
-    size_t        bytes_written = 0;
-    for ( size_t x = 0; x < c->block_size; x++ )
-    {
-      bytes_written += ::fwrite( &data, 1, sizeof( data ), file );
-    }
+    memcpy( dst, buffer, size );
+    return LFS_ERR_OK;
+  }
 
-    ::fflush( file );
-    ::fclose( file );
 
-    if ( bytes_written != c->block_size )
+  static int lfs_safe_erase( const struct lfs_config *c, lfs_block_t block )
+  {
+    uint8_t *dst = sim_image_addr( c, block, 0, c->block_size );
+    if ( !dst )
     {
-      LOG_TRACE( "Error erasing file: %d\r\n" );
       return LFS_ERR_IO;
     }
 
+    memset( dst, 0xFF, c->block_size );
     return LFS_ERR_OK;
   }
 
 
   static int lfs_safe_sync( const struct lfs_config *c )
   {
+    /* The kernel writes the shared mapping back to the file on its own */
     return LFS_ERR_OK;
   }
 
@@ -301,7 +334,7 @@ namespace Aurora::FileSystem::LFS
     RT_DBG_ASSERT( vol->flash.getAttr().readSize == vol->cfg.block_size );
 
     auto lfs_err   = LFS_ERR_IO;
-    auto flash_err = vol->flash.read( block, off, buffer, size );
+    auto flash_err = vol->cache.read( vol->flash, block, off, buffer, size );
 
     if ( flash_err == AM::Status::ERR_OK )
     {
@@ -335,10 +368,20 @@ namespace Aurora::FileSystem::LFS
       flash_err = vol->flash.pendEvent( AM::Event::MEM_WRITE_COMPLETE, Chimera::Thread::TIMEOUT_BLOCK );
       if ( flash_err == AM::Status::ERR_OK )
       {
+        vol->cache.program( block, off, buffer, size );
         lfs_err = LFS_ERR_OK;
       }
     }
 
+    /*-------------------------------------------------------------------------
+    A failed program may have changed part of the block, so any cached copy
+    can no longer be trusted
+    -------------------------------------------------------------------------*/
+    if ( lfs_err != LFS_ERR_OK )
+    {
+      vol->cache.invalidate( block );
+    }
+
     LOG_TRACE_IF( flash_err != AM::Status::ERR_OK, "NOR write error: %d\r\n", flash_err );
     return lfs_err;
   }
@@ -366,10 +409,20 @@ namespace Aurora::FileSystem::LFS
       flash_err = vol->flash.pendEvent( AM::Event::MEM_ERASE_COMPLETE, Chimera::Thread::TIMEOUT_BLOCK );
       if ( flash_err == AM::Status::ERR_OK )
       {
+        vol->cache.erase( block );
         lfs_err = LFS_ERR_OK;
       }
     }
 
+    /*-------------------------------------------------------------------------
+    A failed erase may have changed part of the block, so any cached copy
+    can no longer be trusted
+    -------------------------------------------------------------------------*/
+    if ( lfs_err != LFS_ERR_OK )
+    {
+      vol->cache.invalidate( block );
+    }
+
     LOG_TRACE_IF( flash_err != AM::Status::ERR_OK, "NOR erase error: %d\r\n", flash_err );
     return lfs_err;
   }
@@ -412,8 +465,6 @@ namespace Aurora::FileSystem::LFS
 
   static int mount( const VolumeId drive, void *context )
   {
-    Chimera::Thread::LockGuard _lck( s_lock );
-
     /*-------------------------------------------------------------------------
     Update the drive number for the Volume object passed in. If the drive is
     already registered, this will reveal itself in the "get_volume" call.
@@ -428,50 +479,15 @@ namespace Aurora::FileSystem::LFS
       return -1;
     }
 
+    Chimera::Thread::LockGuard _lck( vol->_lock );
+
     /*-------------------------------------------------------------------------
-    Ensure the backing file exists with the expected properties
+    Ensure the backing file exists and is mapped into memory
     -------------------------------------------------------------------------*/
 #if defined( SIMULATOR )
-    bool create = true;
-    auto props  = Aurora::Memory::Flash::NOR::getProperties( vol->flash.deviceType() );
-    assert( props );
-
-    if ( std::filesystem::exists( vol->_dataFile ) )
+    if ( !sim_map_image( vol ) )
     {
-      const size_t size = std::filesystem::file_size( vol->_dataFile );
-      if ( props->endAddress != size )
-      {
-        LOG_ERROR( "File size didn't match [%d != %d]. Destroying %s\r\n", props->endAddress, size, vol->_dataFile.c_str() );
-        std::filesystem::remove( vol->_dataFile );
-      }
-      else
-      {
-        create = false;
-      }
-    }
-
-    if ( create )
-    {
-      /*-----------------------------------------------------------------------
-      Create the parent directories
-      -----------------------------------------------------------------------*/
-      auto parent_dir = vol->_dataFile.parent_path();
-      std::filesystem::create_directories( parent_dir );
-      assert( std::filesystem::exists( parent_dir ) );
-
-      /*-----------------------------------------------------------------------
-      Fill the file with empty NOR memory all the way up to the device size
-      -----------------------------------------------------------------------*/
-      std::ofstream file;
-      file.open( vol->_dataFile, std::ios::app | std::ios::binary );
-
-      uint8_t data = 0xff;
-      for ( size_t idx = 0; idx < props->endAddress; idx++ )
-      {
-        file.write( reinterpret_cast<const char *>( &data ), sizeof( data ) );
-      }
-
-      file.close();
+      return LFS_ERR_IO;
     }
 #endif /* SIMULATOR */
 
@@ -486,8 +502,6 @@ namespace Aurora::FileSystem::LFS
 
   static int unmount( const VolumeId drive )
   {
-    Chimera::Thread::LockGuard _lck( s_lock );
-
     /*-------------------------------------------------------------------------
     Only attempt an unmount if the volume actually exists
     -------------------------------------------------------------------------*/
@@ -497,24 +511,29 @@ namespace Aurora::FileSystem::LFS
       return -1;
     }
 
+    Chimera::Thread::LockGuard _lck( vol->_lock );
+
     /*-------------------------------------------------------------------------
     Perform the unmount, but don't destroy the volume registration. That is a
     separate (lower layer) task not related to mounting/unmounting.
     -------------------------------------------------------------------------*/
     auto lfs_err = lfs_unmount( &( vol->fs ) );
     LOG_TRACE_IF( lfs_err != LFS_ERR_OK, "Unmount error: %s\r\n", get_error_str( lfs_err ).data() );
+
+#if defined( SIMULATOR )
+    vol->releaseImage();
+#endif
+
     return lfs_err;
   }
 
 
   static int fopen( const char *filename, const AccessFlags mode, const FileId stream, const VolumeId vol )
   {
-    Chimera::Thread::LockGuard _lck( s_lock );
-
     /*-------------------------------------------------------------------------
     Input Protections
     -------------------------------------------------------------------------*/
-    if ( s_files.full() )
+    if ( ( stream < 0 ) || ( fileSlot( stream ) >= s_files.size() ) )
     {
       return -1;
     }
@@ -529,7 +548,12 @@ namespace Aurora::FileSystem::LFS
     }
 
     Volume *volume = get_volume( vol );
-    RT_DBG_ASSERT( volume );
+    if ( !volume )
+    {
+      return -1;
+    }
+
+    Chimera::Thread::LockGuard _lck( volume->_lock );
 
     /*-------------------------------------------------------------------------
     Translate the mode flags to the LFS flags
@@ -577,19 +601,18 @@ namespace Aurora::FileSystem::LFS
     }
 
     /*-------------------------------------------------------------------------
-    Allocate the file in the vector. LFS needs file control data to be static.
+    Claim the slot assigned to this descriptor. LFS keeps open files in a
+    linked list, so the control data must never move while the file is open.
     -------------------------------------------------------------------------*/
-    /* Create the file on the stack with some basic information */
-    File new_file;
-    new_file.clear();
-    new_file.fileDesc = stream;
-    new_file.pVolume  = volume;
+    file = &s_files[ fileSlot( stream ) ];
+    if ( file->pVolume )
+    {
+      return -1;
+    }
 
-    /* Re-find the file in it's new (static) memory location*/
-    s_files.push_back( new_file );
-    etl::shell_sort( s_files.begin(), s_files.end() );
-    file = get_file( stream );
-    RT_DBG_ASSERT( file );
+    file->clear();
+    file->fileDesc = stream;
+    file->pVolume  = volume;
 
     /* Point the cfg buffer to the new address. Validate size requirements. */
     file->lfsCfg.buffer = file->lfsCfgBuff;
@@ -601,8 +624,7 @@ namespace Aurora::FileSystem::LFS
     int lfs_err = lfs_file_opencfg( &( volume->fs ), &file->lfsFile, filename, flags, &file->lfsCfg );
     if ( lfs_err != LFS_ERR_OK )
     {
-      s_files.erase( file );
-      etl::shell_sort( s_files.begin(), s_files.end() );
+      file->clear();
     }
 
     LOG_TRACE_IF( lfs_err != LFS_ERR_OK, "Open error: %s\r\n", get_error_str( lfs_err ).data() );
@@ -612,8 +634,6 @@ namespace Aurora::FileSystem::LFS
 
   static int fclose( FileId stream )
   {
-    Chimera::Thread::LockGuard _lck( s_lock );
-
     /*-------------------------------------------------------------------------
     Look up the file in the registry
     -------------------------------------------------------------------------*/
@@ -623,22 +643,19 @@ namespace Aurora::FileSystem::LFS
       return 0;
     }
 
+    Chimera::Thread::LockGuard _lck( file->pVolume->_lock );
+
     /*-------------------------------------------------------------------------
     Perform the LFS operation
     -------------------------------------------------------------------------*/
     int lfs_err = lfs_file_close( &( file->pVolume->fs ), &( file->lfsFile ) );
-    if ( lfs_err < 0 )
-    {
-      LOG_TRACE( "Close error: %s\r\n", get_error_str( lfs_err ).data() );
-      return lfs_err;
-    }
+    LOG_TRACE_IF( lfs_err < 0, "Close error: %s\r\n", get_error_str( lfs_err ).data() );
 
     /*-------------------------------------------------------------------------
-    Remove the file from the registry
+    Release the slot. LFS drops the file from its open list even on error.
     -------------------------------------------------------------------------*/
-    s_files.erase( file );
-    etl::shell_sort( s_files.begin(), s_files.end() );
-    return 0;
+    file->clear();
+    return ( lfs_err < 0 ) ? lfs_err : 0;
   }
 
 
@@ -653,6 +670,8 @@ namespace Aurora::FileSystem::LFS
       return 0;
     }
 
+    Chimera::Thread::LockGuard _lck( file->pVolume->_lock );
+
     /*-------------------------------------------------------------------------
     Perform the LFS operation
     -------------------------------------------------------------------------*/
@@ -673,6 +692,8 @@ namespace Aurora::FileSystem::LFS
       return 0;
     }
 
+    Chimera::Thread::LockGuard _lck( file->pVolume->_lock );
+
     /*-------------------------------------------------------------------------
     Perform the LFS operation
     -------------------------------------------------------------------------*/
@@ -698,6 +719,8 @@ namespace Aurora::FileSystem::LFS
       return 0;
     }
 
+    Chimera::Thread::LockGuard _lck( file->pVolume->_lock );
+
     /*-------------------------------------------------------------------------
     Perform the LFS operation
     -------------------------------------------------------------------------*/
@@ -723,6 +746,8 @@ namespace Aurora::FileSystem::LFS
       return 0;
     }
 
+    Chimera::Thread::LockGuard _lck( file->pVolume->_lock );
+
     /*-------------------------------------------------------------------------
     Perform the LFS operation. This returns the new offset if successful, which
     is a breaking change from the standard fseek. Override it.
@@ -744,6 +769,8 @@ namespace Aurora::FileSystem::LFS
       return 0;
     }
 
+    Chimera::Thread::LockGuard _lck( file->pVolume->_lock );
+
     /*-------------------------------------------------------------------------
     Perform the LFS operation
     -------------------------------------------------------------------------*/
@@ -769,6 +796,8 @@ namespace Aurora::FileSystem::LFS
       return;
     }
 
+    Chimera::Thread::LockGuard _lck( file->pVolume->_lock );
+
     /*-------------------------------------------------------------------------
     Perform the LFS operation
     -------------------------------------------------------------------------*/
@@ -788,6 +817,8 @@ namespace Aurora::FileSystem::LFS
       return 0;
     }
 
+    Chimera::Thread::LockGuard _lck( file->pVolume->_lock );
+
     /*-------------------------------------------------------------------------
     Perform the LFS operation
     -------------------------------------------------------------------------*/
@@ -809,7 +840,10 @@ namespace Aurora::FileSystem::LFS
     {
       s_lock.unlock();
       s_volumes.clear();
-      s_files.clear();
+      for ( File &f : s_files )
+      {
+        f.clear();
+      }
       s_init = Chimera::DRIVER_INITIALIZED_KEY;
     }
   }
@@ -851,6 +885,7 @@ namespace Aurora::FileSystem::LFS
     /*-------------------------------------------------------------------------
     Ensure we can store the new volume and it hasn't already been registered.
     -------------------------------------------------------------------------*/
+    Chimera::Thread::LockGuard _lck( s_lock );
     if ( s_volumes.full() || get_volume( vol->_volumeID ) )
     {
       return false;
@@ -859,6 +894,7 @@ namespace Aurora::FileSystem::LFS
     /*-------------------------------------------------------------------------
     Register the IO callbacks & context pointer
     -------------------------------------------------------------------------*/
+
     vol->cfg.read    = lfs_safe_read;
     vol->cfg.prog    = lfs_safe_prog;
     vol->cfg.erase   = lfs_safe_erase;
@@ -883,7 +919,8 @@ namespace Aurora::FileSystem::LFS
     /*-------------------------------------------------------------------------
     Invoke the format command, assuming the configuration is OK
     -------------------------------------------------------------------------*/
-    auto lfs_err = lfs_format( &( vol->fs ), &( vol->cfg ) );
+    Chimera::Thread::LockGuard _lck( vol->_lock );
+    auto                       lfs_err = lfs_format( &( vol->fs ), &( vol->cfg ) );
     LOG_TRACE_IF( lfs_err != LFS_ERR_OK, "Format error: %s\r\n", get_error_str( lfs_err ).data() );
     return lfs_err == LFS_ERR_OK;
   }
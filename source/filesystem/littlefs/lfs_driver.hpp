@@ -17,11 +17,17 @@ Includes
 -----------------------------------------------------------------------------*/
 #include "lfs.h"
 #include <Aurora/source/filesystem/file_types.hpp>
+#include <Aurora/source/filesystem/littlefs/lfs_cache.hpp>
 #include <Aurora/source/memory/flash/nor/nor_generic_driver.hpp>
 #include <Chimera/spi>
 #include <Chimera/thread>
 #include <etl/string.h>
 
+#if defined( SIMULATOR )
+#include <filesystem>
+#include <sys/mman.h>
+#endif
+
 namespace Aurora::FileSystem::LFS
 {
   /*---------------------------------------------------------------------------
@@ -34,9 +40,27 @@ namespace Aurora::FileSystem::LFS
     Aurora::Memory::Flash::NOR::Driver flash;     /**< Flash memory driver */
     VolumeId                           _volumeID; /**< Mapped volume ID */
     Chimera::Thread::RecursiveMutex    _lock;     /**< Multi-threaded access protection */
+    BlockCache                         cache;     /**< Optional read cache, see BlockCache::configure() */
 
 #if defined( SIMULATOR )
-    std::filesystem::path _dataFile; /**< Backing file for a fake NOR chip */
+    std::filesystem::path _dataFile;            /**< Backing file for a fake NOR chip */
+    uint8_t              *_image     = nullptr; /**< Backing file mapped into memory */
+    size_t                _imageSize = 0;       /**< Size of the mapping in bytes */
+
+    /**
+     * @brief Writes back and unmaps the backing file, if it's mapped
+     */
+    void releaseImage()
+    {
+      if ( _image )
+      {
+        ::msync( _image, _imageSize, MS_SYNC );
+        ::munmap( _image, _imageSize );
+      }
+
+      _image     = nullptr;
+      _imageSize = 0;
+    }
 #endif
 
     void clear()
@@ -45,6 +69,11 @@ namespace Aurora::FileSystem::LFS
       memset( &cfg, 0, sizeof( cfg ) );
       _volumeID = -1;
       _lock.unlock();
+      cache.invalidate();
+
+#if defined( SIMULATOR )
+      releaseImage();
+#endif
     }
   };
 
@@ -0,0 +1,401 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_benchmark.cpp
+ *
+ *  Description:
+ *    Host benchmark measuring throughput and caller side latency of the
+ *    logging pipeline across thread counts, message sizes, levels and sinks.
+ *
+ *    Usage: aurora_logging_benchmark [max_threads] [messages_per_thread]
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Every statement in this file must be live and unthrottled to measure anything
+-----------------------------------------------------------------------------*/
+#define AURORA_LOG_MODULE_LEVEL ULOG_LEVEL_TRACE
+#define AURORA_LOG_MODULE_RATE_BURST ( 0u )
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/logging>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Aurora::Logging::Benchmark
+{
+  /*---------------------------------------------------------------------------
+  Aliases
+  ---------------------------------------------------------------------------*/
+  using Clock = std::chrono::steady_clock;
+
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr std::array<size_t, 3> MessageSizes = { 16, 64, 160 };
+  static constexpr size_t                MemorySinkSize = 64 * 1024;
+
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  enum class SinkKind : size_t
+  {
+    NULL_SINK,
+    MEMORY_SINK,
+    COUT_SINK,
+
+    NUM_OPTIONS
+  };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  struct Scenario
+  {
+    SinkKind sink;     /**< Where messages end up */
+    size_t   threads;  /**< Number of concurrent producers */
+    size_t   size;     /**< User payload length in bytes */
+    Level    level;    /**< Level the messages are logged at */
+    size_t   messages; /**< Messages logged by each thread */
+    bool     async;    /**< Route through the async queue */
+  };
+
+  struct Report
+  {
+    double p50;       /**< Median caller latency, ns */
+    double p90;       /**< 90th percentile caller latency, ns */
+    double p99;       /**< 99th percentile caller latency, ns */
+    double p999;      /**< 99.9th percentile caller latency, ns */
+    double max;       /**< Worst caller latency, ns */
+    double rate;      /**< Messages issued per second */
+    size_t issued;    /**< Messages the producers attempted to log */
+    size_t delivered; /**< Messages that reached the sink */
+    size_t dropped;   /**< Messages rejected or lost along the way */
+  };
+
+  /*---------------------------------------------------------------------------
+  Sinks
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Discards everything. Measures the cost of the pipeline itself.
+   */
+  class NullSink : public SinkInterface
+  {
+  public:
+    std::atomic<size_t> count{ 0 };
+
+    Result open() final override
+    {
+      enabled = true;
+      return Result::RESULT_SUCCESS;
+    }
+
+    Result close() final override
+    {
+      enabled = false;
+      return Result::RESULT_SUCCESS;
+    }
+
+    Result flush() final override
+    {
+      return Result::RESULT_SUCCESS;
+    }
+
+    IOType getIOType() final override
+    {
+      return IOType::CONSOLE_SINK;
+    }
+
+    Result log( const Level level, const void *const message, const size_t length ) final override
+    {
+      count++;
+      return Result::RESULT_SUCCESS;
+    }
+  };
+
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static const char *sinkName( const SinkKind kind )
+  {
+    switch ( kind )
+    {
+      case SinkKind::NULL_SINK:
+        return "null";
+      case SinkKind::MEMORY_SINK:
+        return "memory";
+      case SinkKind::COUT_SINK:
+        return "cout";
+      default:
+        return "?";
+    }
+  }
+
+
+  static double percentile( const std::vector<uint64_t> &sorted, const double pct )
+  {
+    if ( sorted.empty() )
+    {
+      return 0.0;
+    }
+
+    const size_t idx = static_cast<size_t>( pct * static_cast<double>( sorted.size() - 1 ) );
+    return static_cast<double>( sorted[ idx ] );
+  }
+
+
+  /**
+   *  Logs the requested number of messages, recording how long each call
+   *  blocked the producer.
+   *
+   *  @param[in]  scenario  Test being run
+   *  @param[in]  payload   Text to log
+   *  @param[out] latency   Per call latency in ns
+   *  @param[out] failures  Calls that were rejected by the logger
+   *  @return void
+   */
+  static void producer( const Scenario &scenario, const std::string &payload, std::vector<uint64_t> &latency,
+                        size_t &failures )
+  {
+    const char *const text = payload.c_str();
+    latency.reserve( scenario.messages );
+    failures = 0;
+
+    for ( size_t i = 0; i < scenario.messages; i++ )
+    {
+      Result     result = Result::RESULT_SUCCESS;
+      const auto start  = Clock::now();
+
+      if ( scenario.level == Level::LVL_DEBUG )
+      {
+        result = LOG_DEBUG( "%lu %s\r\n", static_cast<unsigned long>( i ), text );
+      }
+      else
+      {
+        result = LOG_INFO( "%lu %s\r\n", static_cast<unsigned long>( i ), text );
+      }
+
+      const auto stop = Clock::now();
+      latency.push_back( std::chrono::duration_cast<std::chrono::nanoseconds>( stop - start ).count() );
+
+      if ( ( result != Result::RESULT_SUCCESS ) && ( scenario.level >= Level::LVL_INFO ) )
+      {
+        failures++;
+      }
+    }
+  }
+
+
+  /**
+   *  Runs a single scenario from a clean logger state
+   *
+   *  @param[in]  scenario  Test to run
+   *  @return Report
+   */
+  static Report run( const Scenario &scenario )
+  {
+    NullSink             nullSink;
+    MemorySink           memorySink;
+    CoutSink             coutSink;
+    std::vector<uint8_t> memoryPool( MemorySinkSize );
+
+    memorySink.assignCoreMemory( memoryPool.data(), memoryPool.size() );
+
+    SinkHandle_rPtr sink = nullptr;
+    switch ( scenario.sink )
+    {
+      case SinkKind::MEMORY_SINK:
+        sink = &memorySink;
+        break;
+
+      case SinkKind::COUT_SINK:
+        sink = &coutSink;
+        break;
+
+      case SinkKind::NULL_SINK:
+      default:
+        sink = &nullSink;
+        break;
+    }
+
+    /*-------------------------------------------------------------------------
+    Configure the logger. Messages at DEBUG are filtered out by the global
+    level, measuring the cost of a disabled statement.
+    -------------------------------------------------------------------------*/
+    sink->enabled  = true;
+    sink->logLevel = Level::LVL_INFO;
+    setGlobalLogLevel( Level::LVL_INFO );
+    registerSink( sink );
+
+    std::atomic<bool> draining{ true };
+    std::thread       drain;
+    const size_t      droppedBefore = getAsyncStats().dropped;
+
+    if ( scenario.async )
+    {
+      AsyncConfig cfg;
+      cfg.policy       = OverflowPolicy::DROP_NEWEST;
+      cfg.blockTimeout = 0;
+      cfg.pollPeriod   = 0;
+      cfg.reportPeriod = 0;
+      enableAsync( cfg );
+
+      drain = std::thread( [ &draining ]() {
+        while ( draining.load() )
+        {
+          if ( !processAsync( ULOG_ASYNC_QUEUE_DEPTH ) )
+          {
+            std::this_thread::yield();
+          }
+        }
+      } );
+    }
+
+    /*-------------------------------------------------------------------------
+    Spin up the producers and let them go all at once
+    -------------------------------------------------------------------------*/
+    const std::string                  payload( scenario.size, 'x' );
+    std::vector<std::vector<uint64_t>> latency( scenario.threads );
+    std::vector<size_t>                failures( scenario.threads, 0 );
+    std::vector<std::thread>           producers;
+
+    const auto start = Clock::now();
+    for ( size_t t = 0; t < scenario.threads; t++ )
+    {
+      producers.emplace_back( producer, std::cref( scenario ), std::cref( payload ), std::ref( latency[ t ] ),
+                              std::ref( failures[ t ] ) );
+    }
+
+    for ( auto &thread : producers )
+    {
+      thread.join();
+    }
+    const auto stop = Clock::now();
+
+    /*-------------------------------------------------------------------------
+    Let the async queue empty out before tearing down
+    -------------------------------------------------------------------------*/
+    size_t asyncDropped = 0;
+    if ( scenario.async )
+    {
+      while ( processAsync( ULOG_ASYNC_QUEUE_DEPTH ) )
+      {
+        continue;
+      }
+
+      draining = false;
+      drain.join();
+      asyncDropped = getAsyncStats().dropped - droppedBefore;
+      disableAsync();
+    }
+
+    /* Removing by value only works for a null handle, which clears every sink */
+    SinkHandle_rPtr everySink = nullptr;
+    removeSink( everySink );
+
+    /*-------------------------------------------------------------------------
+    Crunch the numbers
+    -------------------------------------------------------------------------*/
+    std::vector<uint64_t> all;
+    size_t                rejected = 0;
+    for ( size_t t = 0; t < scenario.threads; t++ )
+    {
+      all.insert( all.end(), latency[ t ].begin(), latency[ t ].end() );
+      rejected += failures[ t ];
+    }
+    std::sort( all.begin(), all.end() );
+
+    const double seconds = std::chrono::duration<double>( stop - start ).count();
+
+    /*-------------------------------------------------------------------------
+    Only the null sink counts what it receives. For the others, infer it from
+    the failures. A message dropped from the queue is also rejected back to
+    its caller, so the two counts overlap rather than add.
+    -------------------------------------------------------------------------*/
+    Report report;
+    report.p50       = percentile( all, 0.50 );
+    report.p90       = percentile( all, 0.90 );
+    report.p99       = percentile( all, 0.99 );
+    report.p999      = percentile( all, 0.999 );
+    report.max       = all.empty() ? 0.0 : static_cast<double>( all.back() );
+    report.issued    = all.size();
+    report.rate      = ( seconds > 0.0 ) ? ( static_cast<double>( report.issued ) / seconds ) : 0.0;
+    report.delivered = ( scenario.sink == SinkKind::NULL_SINK ) ? nullSink.count.load()
+                                                                : ( report.issued - std::max( rejected, asyncDropped ) );
+    report.dropped   = ( scenario.level >= Level::LVL_INFO ) ? ( report.issued - report.delivered ) : 0;
+
+    return report;
+  }
+
+
+  static void print( const Scenario &scenario, const Report &report )
+  {
+    const double dropRate =
+        report.issued ? ( 100.0 * static_cast<double>( report.dropped ) / static_cast<double>( report.issued ) ) : 0.0;
+
+    fprintf( stderr, "%-6s %-5s %-5s %7zu %5zu %10.0f %9.0f %9.0f %9.0f %9.0f %10.0f %7.3f%%\n", sinkName( scenario.sink ),
+             scenario.async ? "async" : "sync", levelString( scenario.level ).data(), scenario.threads, scenario.size,
+             report.rate, report.p50, report.p90, report.p99, report.p999, report.max, dropRate );
+  }
+
+}  // namespace Aurora::Logging::Benchmark
+
+
+int main( int argc, char **argv )
+{
+  using namespace Aurora::Logging;
+  using namespace Aurora::Logging::Benchmark;
+
+  const size_t maxThreads = ( argc > 1 ) ? std::strtoul( argv[ 1 ], nullptr, 0 ) : std::thread::hardware_concurrency();
+  const size_t messages   = ( argc > 2 ) ? std::strtoul( argv[ 2 ], nullptr, 0 ) : 20000;
+
+  initialize();
+
+  /*---------------------------------------------------------------------------
+  Results go to stderr so they aren't mixed in with the cout sink output
+  ---------------------------------------------------------------------------*/
+  fprintf( stderr, "%-6s %-5s %-5s %7s %5s %10s %9s %9s %9s %9s %10s %8s\n", "sink", "mode", "level", "threads", "size",
+           "msg/s", "p50(ns)", "p90(ns)", "p99(ns)", "p99.9(ns)", "max(ns)", "dropped" );
+
+  for ( size_t kind = 0; kind < static_cast<size_t>( SinkKind::NUM_OPTIONS ); kind++ )
+  {
+    for ( const bool async : { false, true } )
+    {
+      if ( async && !ULOG_ASYNC_ENABLED )
+      {
+        continue;
+      }
+
+      for ( const Level level : { Level::LVL_INFO, Level::LVL_DEBUG } )
+      {
+        for ( size_t threads = 1; threads <= std::max<size_t>( maxThreads, 1 ); threads *= 2 )
+        {
+          for ( const size_t size : MessageSizes )
+          {
+            Scenario scenario;
+            scenario.sink     = static_cast<SinkKind>( kind );
+            scenario.threads  = threads;
+            scenario.size     = size;
+            scenario.level    = level;
+            scenario.async    = async;
+            scenario.messages = ( scenario.sink == SinkKind::COUT_SINK ) ? std::max<size_t>( messages / 100, 1 ) : messages;
+
+            print( scenario, run( scenario ) );
+          }
+        }
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,274 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_async.cpp
+ *
+ *  Description:
+ *    Asynchronous logging pipeline implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/container>
+#include <Aurora/logging>
+#include <Chimera/common>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static AsyncConfig s_async_cfg;
+
+#if ULOG_ASYNC_ENABLED
+  static std::atomic<bool>                                                     s_async_enabled     = false;
+  static Aurora::Container::LockFreeQueue<AsyncRecord, ULOG_ASYNC_QUEUE_DEPTH> s_async_queue;
+  static std::atomic<size_t>                                                   s_queued            = 0;
+  static std::atomic<size_t>                                                   s_dropped           = 0;
+  static std::atomic<size_t>                                                   s_truncated         = 0;
+  static std::atomic<size_t>                                                   s_high_water        = 0;
+  static std::atomic<size_t>                                                   s_last_report_time  = 0;
+  static std::atomic<size_t>                                                   s_last_report_count = 0;
+
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Tracks the deepest the queue has ever been
+   *
+   *  @return void
+   */
+  static void updateHighWater()
+  {
+    const size_t depth = s_async_queue.size();
+    size_t       prev  = s_high_water.load( std::memory_order_relaxed );
+
+    while ( ( depth > prev ) && !s_high_water.compare_exchange_weak( prev, depth, std::memory_order_relaxed ) )
+    {
+      /* Another producer raced us. prev has been reloaded, so try again. */
+    }
+  }
+
+
+  /**
+   *  Emits a message listing how many logs have been lost since the last report
+   *
+   *  @return void
+   */
+  static void reportDrops()
+  {
+    const size_t now     = Chimera::millis();
+    const size_t dropped = s_dropped.load( std::memory_order_relaxed );
+    size_t       last    = s_last_report_count.load( std::memory_order_relaxed );
+
+    if ( !s_async_cfg.reportPeriod || ( dropped == last )
+         || ( ( now - s_last_report_time.load( std::memory_order_relaxed ) ) < s_async_cfg.reportPeriod ) )
+    {
+      return;
+    }
+
+    /*-------------------------------------------------------------------------
+    Several consumers may drain at once. Only the one that claims the count
+    gets to report it.
+    -------------------------------------------------------------------------*/
+    if ( !s_last_report_count.compare_exchange_strong( last, dropped, std::memory_order_relaxed ) )
+    {
+      return;
+    }
+
+    s_last_report_time.store( now, std::memory_order_relaxed );
+
+    char      msg[ 64 ];
+    const int len = npf_snprintf( msg, sizeof( msg ), "[%lu][ulog] -- Dropped %lu messages\r\n",
+                                  static_cast<unsigned long>( now ), static_cast<unsigned long>( dropped - last ) );
+
+    if ( len > 0 )
+    {
+      dispatch( Level::LVL_WARN, msg, std::min<size_t>( static_cast<size_t>( len ), sizeof( msg ) - 1u ) );
+    }
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  Result enableAsync( const AsyncConfig &cfg )
+  {
+    s_async_cfg         = cfg;
+    s_last_report_time  = Chimera::millis();
+    s_last_report_count = s_dropped.load();
+    s_async_enabled     = true;
+
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  Result disableAsync()
+  {
+    s_async_enabled = false;
+    processAsync( std::numeric_limits<size_t>::max() );
+
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  bool isAsyncEnabled()
+  {
+    return s_async_enabled.load( std::memory_order_relaxed );
+  }
+
+
+  Result enqueue( const Level level, const void *const message, const size_t length, const bool binary )
+  {
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( !message || !length )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    /*-------------------------------------------------------------------------
+    Build the record and queue it
+    -------------------------------------------------------------------------*/
+    AsyncRecord record;
+    const bool  truncated = packRecord( level, message, length, record );
+    record.binary         = binary;
+
+    return enqueue( record, truncated );
+  }
+
+
+  Result enqueue( const AsyncRecord &record, const bool truncated )
+  {
+    if ( truncated )
+    {
+      s_truncated++;
+    }
+
+    if ( !pushRecord( s_async_queue, record, s_async_cfg.policy, s_async_cfg.blockTimeout, s_dropped ) )
+    {
+      return Result::RESULT_FULL;
+    }
+
+    s_queued++;
+    updateHighWater();
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  size_t processAsync( const size_t limit )
+  {
+    AsyncRecord record;
+    size_t      count = 0;
+
+    while ( ( count < limit ) && s_async_queue.pop( record ) )
+    {
+      if ( record.binary )
+      {
+        dispatchBinary( record.level, record.data, record.length );
+      }
+      else
+      {
+        dispatch( record.level, record.data, record.length );
+      }
+
+      count++;
+    }
+
+    reportDrops();
+    return count;
+  }
+
+
+  AsyncStats getAsyncStats()
+  {
+    AsyncStats stats;
+    stats.queued    = s_queued.load();
+    stats.dropped   = s_dropped.load();
+    stats.truncated = s_truncated.load();
+    stats.highWater = s_high_water.load();
+
+    return stats;
+  }
+
+#else  /* !ULOG_ASYNC_ENABLED */
+
+  /*---------------------------------------------------------------------------
+  Public Functions: the pipeline isn't built, so log() always stays synchronous
+  ---------------------------------------------------------------------------*/
+  Result enableAsync( const AsyncConfig &cfg )
+  {
+    ( void )cfg;
+    return Result::RESULT_FAIL;
+  }
+
+
+  Result disableAsync()
+  {
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  bool isAsyncEnabled()
+  {
+    return false;
+  }
+
+
+  Result enqueue( const Level level, const void *const message, const size_t length, const bool binary )
+  {
+    ( void )level;
+    ( void )message;
+    ( void )length;
+    ( void )binary;
+    return Result::RESULT_FAIL;
+  }
+
+
+  Result enqueue( const AsyncRecord &record, const bool truncated )
+  {
+    ( void )record;
+    ( void )truncated;
+    return Result::RESULT_FAIL;
+  }
+
+
+  size_t processAsync( const size_t limit )
+  {
+    ( void )limit;
+    return 0;
+  }
+
+
+  AsyncStats getAsyncStats()
+  {
+    return AsyncStats{};
+  }
+
+#endif /* ULOG_ASYNC_ENABLED */
+
+
+  void asyncDrainThread( void *arg )
+  {
+    ( void )arg;
+
+    while ( true )
+    {
+      flushSummaries();
+
+      const size_t isrCount = processISRLogs( ULOG_ISR_QUEUE_DEPTH );
+      if ( !processAsync( ULOG_ASYNC_QUEUE_DEPTH ) && !isrCount )
+      {
+        Chimera::delayMilliseconds( s_async_cfg.pollPeriod );
+      }
+    }
+  }
+
+}  // namespace Aurora::Logging
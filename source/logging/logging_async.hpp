@@ -0,0 +1,230 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_async.hpp
+ *
+ *  Description:
+ *    Asynchronous logging pipeline. Log calls copy their message into a lock
+ *    free queue and a dedicated thread drains it out to the sinks.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_ASYNC_HPP
+#define AURORA_LOGGING_ASYNC_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_types.hpp>
+#include <Chimera/common>
+#include <Chimera/system>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  /**
+   *  What to do with a new message when the queue is full
+   */
+  enum class OverflowPolicy : uint8_t
+  {
+    DROP_NEWEST, /**< Discard the new message */
+    DROP_OLDEST, /**< Discard the oldest queued message to make room */
+    BLOCK,       /**< Wait for room, up to a timeout, then discard the new message */
+  };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  A single queued message. Sized to hold anything the formatter produces,
+   *  so only oversized log() calls get truncated.
+   */
+  struct AsyncRecord
+  {
+    Level    level;                           /**< Severity level of the message */
+    uint16_t length;                          /**< Number of valid bytes in data */
+    bool     binary;                          /**< Data is a binary record, not text */
+    uint8_t  data[ ULOG_MAX_MESSAGE_LENGTH ]; /**< Message contents */
+  };
+
+  static_assert( ULOG_MAX_MESSAGE_LENGTH <= UINT16_MAX, "AsyncRecord length can't describe a full message" );
+
+  struct AsyncConfig
+  {
+    OverflowPolicy policy;       /**< Behavior when the queue is full */
+    size_t         blockTimeout; /**< Max time to wait for room with the BLOCK policy, in ms */
+    size_t         pollPeriod;   /**< How often the drain thread checks an empty queue, in ms */
+    size_t         reportPeriod; /**< How often dropped messages are reported, in ms. Zero disables. */
+
+    AsyncConfig() : policy( OverflowPolicy::DROP_NEWEST ), blockTimeout( 10 ), pollPeriod( 5 ), reportPeriod( 1000 )
+    {
+    }
+  };
+
+  struct AsyncStats
+  {
+    size_t queued;    /**< Messages accepted into the queue */
+    size_t dropped;   /**< Messages lost to overflow */
+    size_t truncated; /**< Messages cut short to fit a record */
+    size_t highWater; /**< Largest observed queue depth */
+  };
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Packs a message into a queue record, truncating it if needed
+   *
+   *  @param[in]  level     The severity level of the message
+   *  @param[in]  message   Raw message bytes
+   *  @param[in]  length    Number of bytes in the message
+   *  @param[out] record    Record to fill
+   *  @return bool          True if the message was truncated
+   */
+  static inline bool packRecord( const Level level, const void *const message, const size_t length, AsyncRecord &record )
+  {
+    record.level  = level;
+    record.binary = false;
+    record.length = static_cast<uint16_t>( std::min<size_t>( length, sizeof( record.data ) ) );
+    memcpy( record.data, message, record.length );
+
+    return record.length < length;
+  }
+
+  /**
+   *  Pushes a record into a queue, applying an overflow policy if it's full.
+   *  The BLOCK policy degrades to DROP_NEWEST when called from an ISR. Callers
+   *  must not hold locks other loggers need, since BLOCK may sleep.
+   *
+   *  @param[in]  queue     Queue to push into
+   *  @param[in]  record    Record to push
+   *  @param[in]  policy    What to do if the queue is full
+   *  @param[in]  timeout   Max time to wait with the BLOCK policy, in ms
+   *  @param[out] dropped   Incremented for every record lost
+   *  @return bool          True if the record was queued
+   */
+  template<typename Queue>
+  bool pushRecord( Queue &queue, const AsyncRecord &record, const OverflowPolicy policy, const size_t timeout,
+                   std::atomic<size_t> &dropped )
+  {
+    bool queued = queue.push( record );
+
+    if ( !queued && ( policy == OverflowPolicy::DROP_OLDEST ) )
+    {
+      /*-----------------------------------------------------------------------
+      Other producers can refill the slot between the pop and the push. Give
+      up after a full queue's worth of evictions rather than spin forever.
+      -----------------------------------------------------------------------*/
+      AsyncRecord discard;
+      for ( size_t attempt = 0; !queued && ( attempt < queue.capacity() ); attempt++ )
+      {
+        if ( queue.pop( discard ) )
+        {
+          dropped++;
+        }
+
+        queued = queue.push( record );
+      }
+    }
+    else if ( !queued && ( policy == OverflowPolicy::BLOCK ) && !Chimera::System::inISR() )
+    {
+      const size_t start = Chimera::millis();
+      while ( !queued && ( ( Chimera::millis() - start ) < timeout ) )
+      {
+        Chimera::delayMilliseconds( 1 );
+        queued = queue.push( record );
+      }
+    }
+
+    if ( !queued )
+    {
+      dropped++;
+    }
+
+    return queued;
+  }
+
+  /**
+   *  Switches log() over to the asynchronous pipeline. From this point on, all
+   *  messages are queued and nothing reaches the sinks until the queue is
+   *  drained by asyncDrainThread() or processAsync().
+   *
+   *  @param[in]  cfg       Pipeline configuration
+   *  @return Result        RESULT_FAIL if built without ULOG_ASYNC_ENABLED
+   */
+  Result enableAsync( const AsyncConfig &cfg );
+
+  /**
+   *  Switches log() back to synchronous dispatch, after flushing anything
+   *  still in the queue out to the sinks.
+   *
+   *  @return Result
+   */
+  Result disableAsync();
+
+  /**
+   *  Checks if the asynchronous pipeline is active
+   *
+   *  @return bool
+   */
+  bool isAsyncEnabled();
+
+  /**
+   *  Queues a message according to the configured overflow policy
+   *
+   *  @param[in]  level     The severity level of the message
+   *  @param[in]  message   Raw message bytes
+   *  @param[in]  length    Number of bytes in the message
+   *  @param[in]  binary    Message is a binary record, only for binary capable sinks
+   *  @return Result        RESULT_FULL if the message was dropped
+   */
+  Result enqueue( const Level level, const void *const message, const size_t length, const bool binary = false );
+
+  /**
+   *  Queues an already packed record according to the configured overflow
+   *  policy. Lets callers pack under a lock and push after releasing it.
+   *
+   *  @param[in]  record    Record to queue
+   *  @param[in]  truncated Whether packing the record truncated the message
+   *  @return Result        RESULT_FULL if the message was dropped
+   */
+  Result enqueue( const AsyncRecord &record, const bool truncated );
+
+  /**
+   *  Moves queued messages out to the sinks from the calling context
+   *
+   *  @param[in]  limit     Max number of messages to process
+   *  @return size_t        Number of messages processed
+   */
+  size_t processAsync( const size_t limit );
+
+  /**
+   *  Thread entry point that drains the queue forever. Create a low priority
+   *  thread with this as its function once enableAsync() has been called.
+   *  Records from LOG_ISR are rendered here as well, and pending duplicate
+   *  summaries are flushed.
+   *
+   *  @param[in]  arg       Unused
+   *  @return void
+   */
+  void asyncDrainThread( void *arg );
+
+  /**
+   *  Gets a snapshot of the pipeline statistics
+   *
+   *  @return AsyncStats
+   */
+  AsyncStats getAsyncStats();
+
+}  // namespace Aurora::Logging
+
+#endif /* !AURORA_LOGGING_ASYNC_HPP */
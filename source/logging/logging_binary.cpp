@@ -0,0 +1,506 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_binary.cpp
+ *
+ *  Description:
+ *    Binary log record emission and host side decoding
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/logging>
+#include <Chimera/common>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+/*-----------------------------------------------------------------------------
+Linker Symbols
+-----------------------------------------------------------------------------*/
+extern "C"
+{
+  extern const Aurora::Logging::Site __start_aurora_log_sites[] __attribute__( ( weak ) );
+  extern const Aurora::Logging::Site __stop_aurora_log_sites[] __attribute__( ( weak ) );
+}
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  const Site *getSiteTable( size_t &count )
+  {
+    if ( !__start_aurora_log_sites || !__stop_aurora_log_sites )
+    {
+      count = 0;
+      return nullptr;
+    }
+
+    count = static_cast<size_t>( __stop_aurora_log_sites - __start_aurora_log_sites );
+    return __start_aurora_log_sites;
+  }
+}  // namespace Aurora::Logging
+
+
+namespace Aurora::Logging::Binary
+{
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Appends formatted text to an output buffer, clamping on overflow
+   *
+   *  @param[in]  out       Output buffer
+   *  @param[in]  size      Size of the output buffer
+   *  @param[in]  pos       Current write offset. Updated on return.
+   *  @param[in]  fmt       Format string
+   *  @return void
+   */
+  static void append( char *const out, const size_t size, size_t &pos, const char *fmt, ... )
+  {
+    if ( pos >= ( size - 1u ) )
+    {
+      return;
+    }
+
+    va_list argptr;
+    va_start( argptr, fmt );
+    const int written = vsnprintf( out + pos, size - pos, fmt, argptr );
+    va_end( argptr );
+
+    if ( written > 0 )
+    {
+      pos = std::min<size_t>( pos + static_cast<size_t>( written ), size - 1u );
+    }
+  }
+
+
+  /**
+   *  Gets the size of an argument's payload, not including the type tag
+   *
+   *  @param[in]  data      Start of the argument, pointing at the type tag
+   *  @param[in]  avail     Bytes available
+   *  @return size_t        Zero if the argument is malformed
+   */
+  static size_t argSize( const uint8_t *const data, const size_t avail )
+  {
+    if ( avail < 1u )
+    {
+      return 0;
+    }
+
+    switch ( data[ 0 ] )
+    {
+      case ARG_INT32:
+      case ARG_UINT32:
+        return ( avail >= 5u ) ? 4u : 0u;
+
+      case ARG_INT64:
+      case ARG_UINT64:
+      case ARG_DOUBLE:
+      case ARG_POINTER:
+        return ( avail >= 9u ) ? 8u : 0u;
+
+      case ARG_STRING:
+        return ( ( avail >= 2u ) && ( avail >= ( 2u + data[ 1 ] ) ) ) ? ( 1u + data[ 1 ] ) : 0u;
+
+      default:
+        return 0;
+    }
+  }
+
+
+  /**
+   *  Consumes an integer argument, as used by a '*' width or precision
+   *
+   *  @param[in]  args      Next argument. Advanced past it on success.
+   *  @param[in]  argsEnd   End of the encoded arguments
+   *  @param[out] value     The integer value
+   *  @return bool          False if the argument is missing or not an integer
+   */
+  static bool takeInt( const uint8_t *&args, const uint8_t *const argsEnd, int &value )
+  {
+    const size_t len = argSize( args, static_cast<size_t>( argsEnd - args ) );
+    if ( !len || ( ( args[ 0 ] != ARG_INT32 ) && ( args[ 0 ] != ARG_UINT32 ) ) )
+    {
+      return false;
+    }
+
+    int32_t tmp;
+    memcpy( &tmp, args + 1u, sizeof( tmp ) );
+    value = static_cast<int>( tmp );
+    args += 1u + len;
+    return true;
+  }
+
+
+  /**
+   *  Formats a single argument using the flags, width, and precision the user
+   *  asked for. Length modifiers are replaced with ones matching how the value
+   *  was actually encoded, so a "%lu" from a 32-bit target decodes correctly on
+   *  a 64-bit host.
+   *
+   *  @param[in]  spec      User specifier without the length modifier or conversion
+   *  @param[in]  conv      User conversion character
+   *  @param[in]  arg       Argument, pointing at the type tag
+   *  @param[in]  out       Output buffer
+   *  @param[in]  size      Size of the output buffer
+   *  @param[in]  pos       Current write offset. Updated on return.
+   *  @return void
+   */
+  static void formatArg( const char *const spec, const char conv, const uint8_t *const arg, char *const out, const size_t size,
+                         size_t &pos )
+  {
+    char fmt[ 32 ];
+    const uint8_t *payload = arg + 1u;
+
+    switch ( arg[ 0 ] )
+    {
+      case ARG_INT32: {
+        int32_t val;
+        memcpy( &val, payload, sizeof( val ) );
+        snprintf( fmt, sizeof( fmt ), "%s%c", spec, strchr( "cdiouxX", conv ) ? conv : 'd' );
+        append( out, size, pos, fmt, static_cast<int>( val ) );
+      }
+      break;
+
+      case ARG_UINT32: {
+        uint32_t val;
+        memcpy( &val, payload, sizeof( val ) );
+        snprintf( fmt, sizeof( fmt ), "%s%c", spec, strchr( "cdiouxX", conv ) ? conv : 'u' );
+        append( out, size, pos, fmt, static_cast<unsigned int>( val ) );
+      }
+      break;
+
+      case ARG_INT64: {
+        int64_t val;
+        memcpy( &val, payload, sizeof( val ) );
+        snprintf( fmt, sizeof( fmt ), "%sll%c", spec, strchr( "diouxX", conv ) ? conv : 'd' );
+        append( out, size, pos, fmt, static_cast<long long>( val ) );
+      }
+      break;
+
+      case ARG_UINT64: {
+        uint64_t val;
+        memcpy( &val, payload, sizeof( val ) );
+        snprintf( fmt, sizeof( fmt ), "%sll%c", spec, strchr( "diouxX", conv ) ? conv : 'u' );
+        append( out, size, pos, fmt, static_cast<unsigned long long>( val ) );
+      }
+      break;
+
+      case ARG_DOUBLE: {
+        double val;
+        memcpy( &val, payload, sizeof( val ) );
+        snprintf( fmt, sizeof( fmt ), "%s%c", spec, strchr( "fFeEgGaA", conv ) ? conv : 'f' );
+        append( out, size, pos, fmt, val );
+      }
+      break;
+
+      case ARG_POINTER: {
+        uint64_t val;
+        memcpy( &val, payload, sizeof( val ) );
+        append( out, size, pos, "0x%llx", static_cast<unsigned long long>( val ) );
+      }
+      break;
+
+      case ARG_STRING: {
+        char str[ 256 ];
+        memcpy( str, payload + 1u, payload[ 0 ] );
+        str[ payload[ 0 ] ] = '\0';
+
+        snprintf( fmt, sizeof( fmt ), "%ss", spec );
+        append( out, size, pos, fmt, str );
+      }
+      break;
+
+      default:
+        break;
+    }
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  Result emit( const Site &site, uint8_t *const record, const ArgWriter &args )
+  {
+    return emit( site, static_cast<uint32_t>( Chimera::millis() ), record, args );
+  }
+
+
+  Result emit( const Site &site, const uint32_t timestamp, uint8_t *const record, const ArgWriter &args )
+  {
+    RecordHeader hdr;
+    hdr.id        = site.id;
+    hdr.timestamp = timestamp;
+    hdr.level     = static_cast<uint8_t>( site.level );
+    hdr.nargs     = args.count();
+    hdr.size      = static_cast<uint16_t>( args.size() );
+
+    memcpy( record, &hdr, sizeof( hdr ) );
+    return logBinary( site.level, record, sizeof( hdr ) + args.size() );
+  }
+
+
+  bool exportSiteTable( const TableWriter &writer )
+  {
+    static constexpr char terminator = '\0';
+
+    if ( !writer.is_valid() )
+    {
+      return false;
+    }
+
+    size_t      count = 0;
+    const Site *table = getSiteTable( count );
+
+    SiteTableHeader hdr;
+    hdr.magic    = SITE_TABLE_MAGIC;
+    hdr.version  = SITE_TABLE_VERSION;
+    hdr.reserved = 0;
+    hdr.count    = static_cast<uint32_t>( count );
+
+    if ( !writer( &hdr, sizeof( hdr ) ) )
+    {
+      return false;
+    }
+
+    for ( size_t i = 0; i < count; i++ )
+    {
+      const Site &site = table[ i ];
+      const char *file = site.file ? site.file : "";
+      const char *fmt  = site.fmt ? site.fmt : "";
+
+      SiteTableEntry entry;
+      entry.id       = site.id;
+      entry.line     = site.line;
+      entry.level    = static_cast<uint8_t>( site.level );
+      entry.reserved = 0;
+      entry.fileLen  = static_cast<uint16_t>( std::min<size_t>( strlen( file ), UINT16_MAX ) );
+      entry.fmtLen   = static_cast<uint16_t>( std::min<size_t>( strlen( fmt ), UINT16_MAX ) );
+
+      if ( !writer( &entry, sizeof( entry ) ) || !writer( file, entry.fileLen ) || !writer( &terminator, 1u )
+           || !writer( fmt, entry.fmtLen ) || !writer( &terminator, 1u ) )
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Decoder Implementation
+  ---------------------------------------------------------------------------*/
+  Decoder::Decoder() : mTable( nullptr ), mCount( 0 )
+  {
+  }
+
+
+  void Decoder::assignTable( const Site *const table, const size_t count )
+  {
+    mTable = table;
+    mCount = table ? count : 0;
+  }
+
+
+  size_t Decoder::loadTable( const void *const blob, const size_t size, Site *const storage, const size_t capacity )
+  {
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( !blob || !storage || ( size < sizeof( SiteTableHeader ) ) )
+    {
+      return 0;
+    }
+
+    SiteTableHeader hdr;
+    memcpy( &hdr, blob, sizeof( hdr ) );
+
+    if ( ( hdr.magic != SITE_TABLE_MAGIC ) || ( hdr.version != SITE_TABLE_VERSION ) || ( hdr.count > capacity ) )
+    {
+      return 0;
+    }
+
+    /*-------------------------------------------------------------------------
+    Parse each entry, pointing the strings back into the blob
+    -------------------------------------------------------------------------*/
+    const char *data = reinterpret_cast<const char *>( blob );
+    size_t      pos  = sizeof( hdr );
+
+    for ( size_t i = 0; i < hdr.count; i++ )
+    {
+      SiteTableEntry entry;
+      if ( ( size - pos ) < sizeof( entry ) )
+      {
+        return 0;
+      }
+
+      memcpy( &entry, data + pos, sizeof( entry ) );
+      pos += sizeof( entry );
+
+      const size_t strings = entry.fileLen + entry.fmtLen + 2u;
+      if ( ( ( size - pos ) < strings ) || ( data[ pos + entry.fileLen ] != '\0' )
+           || ( data[ pos + entry.fileLen + 1u + entry.fmtLen ] != '\0' ) )
+      {
+        return 0;
+      }
+
+      Site &site  = storage[ i ];
+      site.id     = entry.id;
+      site.level  = static_cast<Level>( entry.level );
+      site.file   = data + pos;
+      site.line   = entry.line;
+      site.fmt    = data + pos + entry.fileLen + 1u;
+      site.prefix = nullptr;
+      site.state  = nullptr;
+
+      pos += strings;
+    }
+
+    assignTable( storage, hdr.count );
+    return hdr.count;
+  }
+
+
+  const Site *Decoder::lookup( const uint32_t id ) const
+  {
+    for ( size_t i = 0; i < mCount; i++ )
+    {
+      if ( mTable[ i ].id == id )
+      {
+        return &mTable[ i ];
+      }
+    }
+
+    return nullptr;
+  }
+
+
+  size_t Decoder::decode( const void *const record, const size_t length, char *const out, const size_t outSize ) const
+  {
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( !record || !out || !outSize || ( length < sizeof( RecordHeader ) ) )
+    {
+      return 0;
+    }
+
+    RecordHeader hdr;
+    memcpy( &hdr, record, sizeof( hdr ) );
+
+    const size_t total = sizeof( RecordHeader ) + hdr.size;
+    if ( total > length )
+    {
+      return 0;
+    }
+
+    if ( hdr.id == KV::RECORD_ID )
+    {
+      return KV::render( record, length, KV::Format::TEXT, out, outSize );
+    }
+
+    /*-------------------------------------------------------------------------
+    Render the same header that flog() would have produced
+    -------------------------------------------------------------------------*/
+    const uint8_t *args    = reinterpret_cast<const uint8_t *>( record ) + sizeof( RecordHeader );
+    const uint8_t *argsEnd = args + hdr.size;
+    const Site    *site    = lookup( hdr.id );
+    size_t         pos     = 0;
+
+    out[ 0 ] = '\0';
+    if ( !site )
+    {
+      append( out, outSize, pos, "[%lu][unknown site 0x%08lx] -- ", static_cast<unsigned long>( hdr.timestamp ),
+              static_cast<unsigned long>( hdr.id ) );
+      return total;
+    }
+
+    append( out, outSize, pos, "[%lu][%s:%lu][%s] -- ", static_cast<unsigned long>( hdr.timestamp ), site->file,
+            static_cast<unsigned long>( site->line ), levelString( site->level ).data() );
+
+    /*-------------------------------------------------------------------------
+    Walk the format string, substituting each specifier with the next argument
+    -------------------------------------------------------------------------*/
+    const char *fmt = site->fmt;
+    while ( *fmt != '\0' )
+    {
+      if ( *fmt != '%' )
+      {
+        const char *next = strchr( fmt, '%' );
+        const size_t run = next ? static_cast<size_t>( next - fmt ) : strlen( fmt );
+
+        append( out, outSize, pos, "%.*s", static_cast<int>( run ), fmt );
+        fmt += run;
+        continue;
+      }
+
+      if ( fmt[ 1 ] == '%' )
+      {
+        append( out, outSize, pos, "%%" );
+        fmt += 2;
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Split the specifier into the parts we keep and the parts we replace
+      -----------------------------------------------------------------------*/
+      char   spec[ 16 ];
+      size_t specLen = 0;
+
+      spec[ specLen++ ] = *fmt++;
+      while ( ( *fmt != '\0' ) && strchr( "-+ #0123456789.*", *fmt ) && ( specLen < ( sizeof( spec ) - 1u ) ) )
+      {
+        /*---------------------------------------------------------------------
+        A '*' width or precision was passed as its own argument. Bake the
+        value into the specifier so the argument after it lines up.
+        ---------------------------------------------------------------------*/
+        if ( *fmt == '*' )
+        {
+          int value = 0;
+          takeInt( args, argsEnd, value );
+
+          const int len = snprintf( spec + specLen, sizeof( spec ) - specLen, "%d", value );
+          specLen       = std::min<size_t>( specLen + static_cast<size_t>( std::max( len, 0 ) ), sizeof( spec ) - 1u );
+          fmt++;
+          continue;
+        }
+
+        spec[ specLen++ ] = *fmt++;
+      }
+      spec[ specLen ] = '\0';
+
+      while ( ( *fmt != '\0' ) && strchr( "hljztL", *fmt ) )
+      {
+        fmt++;
+      }
+
+      const char conv = *fmt;
+      if ( conv != '\0' )
+      {
+        fmt++;
+      }
+
+      /*-----------------------------------------------------------------------
+      Consume the next argument
+      -----------------------------------------------------------------------*/
+      const size_t argLen = argSize( args, static_cast<size_t>( argsEnd - args ) );
+      if ( !argLen )
+      {
+        append( out, outSize, pos, "<?>" );
+        continue;
+      }
+
+      formatArg( spec, conv, args, out, outSize, pos );
+      args += 1u + argLen;
+    }
+
+    return total;
+  }
+
+}  // namespace Aurora::Logging::Binary
@@ -0,0 +1,392 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_binary.hpp
+ *
+ *  Description:
+ *    Deferred binary logging. Call sites emit an ID and raw argument values,
+ *    which are turned back into text later by a host side decoder.
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_BINARY_HPP
+#define AURORA_LOGGING_BINARY_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_driver.hpp>
+#include <Aurora/source/logging/logging_limiter.hpp>
+#include <Aurora/source/logging/logging_site.hpp>
+#include <Aurora/source/logging/logging_types.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <etl/delegate.h>
+#include <type_traits>
+
+namespace Aurora::Logging::Binary
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr uint32_t SITE_TABLE_MAGIC   = 0x54534C41; /**< "ALST" on disk */
+  static constexpr uint16_t SITE_TABLE_VERSION = 1;
+
+  /*---------------------------------------------------------------------------
+  Aliases
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Receives the serialized site table in pieces
+   *
+   *  @param[in]  data      Next piece of the table
+   *  @param[in]  size      Number of bytes in the piece
+   *  @return bool          False to abort the export
+   */
+  using TableWriter = etl::delegate<bool( const void *const, const size_t )>;
+
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Tags describing how an argument was encoded. Every argument on the wire is
+   *  prefixed by one of these.
+   */
+  enum ArgType : uint8_t
+  {
+    ARG_INT32,   /**< int32_t, little endian */
+    ARG_UINT32,  /**< uint32_t, little endian */
+    ARG_INT64,   /**< int64_t, little endian */
+    ARG_UINT64,  /**< uint64_t, little endian */
+    ARG_DOUBLE,  /**< IEEE-754 double */
+    ARG_POINTER, /**< Address stored as a uint64_t */
+    ARG_STRING,  /**< uint8_t length followed by the characters, no terminator */
+
+    ARG_NUM_OPTIONS
+  };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+#pragma pack( push, 1 )
+  /**
+   *  Prefix of every binary log record. The encoded arguments immediately follow.
+   */
+  struct RecordHeader
+  {
+    uint32_t id;        /**< Site::id of the statement that logged */
+    uint32_t timestamp; /**< System time in milliseconds */
+    uint8_t  level;     /**< Severity level */
+    uint8_t  nargs;     /**< Number of encoded arguments */
+    uint16_t size;      /**< Number of argument bytes following the header */
+  };
+
+  /**
+   *  Start of a serialized site table
+   */
+  struct SiteTableHeader
+  {
+    uint32_t magic;    /**< SITE_TABLE_MAGIC */
+    uint16_t version;  /**< SITE_TABLE_VERSION */
+    uint16_t reserved; /**< Always zero */
+    uint32_t count;    /**< Number of entries that follow */
+  };
+
+  /**
+   *  A single serialized site. The file name and format string follow, each
+   *  with a null terminator that isn't counted in its length.
+   */
+  struct SiteTableEntry
+  {
+    uint32_t id;       /**< Site::id */
+    uint32_t line;     /**< Site::line */
+    uint8_t  level;    /**< Site::level */
+    uint8_t  reserved; /**< Always zero */
+    uint16_t fileLen;  /**< Length of the file name */
+    uint16_t fmtLen;   /**< Length of the format string */
+  };
+#pragma pack( pop )
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Serializes log arguments into a caller supplied buffer. Argument types are
+   *  resolved at compile time, so the runtime cost is a handful of stores.
+   */
+  class ArgWriter
+  {
+  public:
+    ArgWriter( uint8_t *const buffer, const size_t size ) :
+        mBuffer( buffer ), mSize( size ), mPos( 0 ), mCount( 0 ), mOverflow( false )
+    {
+    }
+
+    /**
+     *  Encodes a single argument. Once an argument fails to fit, all following
+     *  arguments are discarded so the decoder never sees a partial argument.
+     *
+     *  @param[in]  arg       Argument to encode
+     *  @return void
+     */
+    template<typename T>
+    void write( const T arg )
+    {
+      if constexpr ( std::is_same_v<T, const char *> || std::is_same_v<T, char *> )
+      {
+        putString( arg );
+      }
+      else if constexpr ( std::is_pointer_v<T> )
+      {
+        const uint64_t tmp = static_cast<uint64_t>( reinterpret_cast<uintptr_t>( arg ) );
+        put( ARG_POINTER, &tmp, sizeof( tmp ) );
+      }
+      else if constexpr ( std::is_enum_v<T> )
+      {
+        write( static_cast<std::underlying_type_t<T>>( arg ) );
+      }
+      else if constexpr ( std::is_floating_point_v<T> )
+      {
+        const double tmp = static_cast<double>( arg );
+        put( ARG_DOUBLE, &tmp, sizeof( tmp ) );
+      }
+      else if constexpr ( std::is_integral_v<T> && ( sizeof( T ) <= sizeof( uint32_t ) ) )
+      {
+        if constexpr ( std::is_signed_v<T> )
+        {
+          const int32_t tmp = static_cast<int32_t>( arg );
+          put( ARG_INT32, &tmp, sizeof( tmp ) );
+        }
+        else
+        {
+          const uint32_t tmp = static_cast<uint32_t>( arg );
+          put( ARG_UINT32, &tmp, sizeof( tmp ) );
+        }
+      }
+      else if constexpr ( std::is_integral_v<T> )
+      {
+        if constexpr ( std::is_signed_v<T> )
+        {
+          const int64_t tmp = static_cast<int64_t>( arg );
+          put( ARG_INT64, &tmp, sizeof( tmp ) );
+        }
+        else
+        {
+          const uint64_t tmp = static_cast<uint64_t>( arg );
+          put( ARG_UINT64, &tmp, sizeof( tmp ) );
+        }
+      }
+      else
+      {
+        static_assert( !std::is_same_v<T, T>, "Unsupported binary log argument type" );
+      }
+    }
+
+    /**
+     *  @return size_t  Number of encoded bytes
+     */
+    size_t size() const
+    {
+      return mPos;
+    }
+
+    /**
+     *  @return uint8_t Number of encoded arguments
+     */
+    uint8_t count() const
+    {
+      return mCount;
+    }
+
+    /**
+     *  @return bool    True if any argument was discarded
+     */
+    bool overflow() const
+    {
+      return mOverflow;
+    }
+
+  private:
+    uint8_t *const mBuffer;
+    const size_t   mSize;
+    size_t         mPos;
+    uint8_t        mCount;
+    bool           mOverflow;
+
+    void put( const ArgType type, const void *const data, const size_t size )
+    {
+      if ( mOverflow || ( ( mPos + 1u + size ) > mSize ) )
+      {
+        mOverflow = true;
+        return;
+      }
+
+      mBuffer[ mPos ] = type;
+      memcpy( mBuffer + mPos + 1u, data, size );
+      mPos += 1u + size;
+      mCount++;
+    }
+
+    void putString( const char *const str )
+    {
+      const char *src = str ? str : "(null)";
+      size_t      len = strlen( src );
+
+      if ( mOverflow || ( ( mPos + 2u ) > mSize ) )
+      {
+        mOverflow = true;
+        return;
+      }
+
+      /*-----------------------------------------------------------------------
+      Strings are the one argument type allowed to be truncated to fit
+      -----------------------------------------------------------------------*/
+      len = std::min<size_t>( { len, 255u, mSize - mPos - 2u } );
+
+      mBuffer[ mPos ]      = ARG_STRING;
+      mBuffer[ mPos + 1u ] = static_cast<uint8_t>( len );
+      memcpy( mBuffer + mPos + 2u, src, len );
+      mPos += 2u + len;
+      mCount++;
+    }
+  };
+
+
+  /**
+   *  Turns binary log records back into the same text flog() would have
+   *  produced. Needs the site table from the image that generated the records.
+   *
+   *  Inside that image, the table can be assigned straight from getSiteTable().
+   *  Anywhere else, like a host tool, the image has to export its table with
+   *  exportSiteTable() first and the decoder loads it with loadTable(). There
+   *  is no extractor that reads the table out of an ELF file.
+   */
+  class Decoder
+  {
+  public:
+    Decoder();
+
+    /**
+     *  Assigns the table used to resolve site IDs into format strings
+     *
+     *  @param[in]  table     Site table, usually from getSiteTable()
+     *  @param[in]  count     Number of entries in the table
+     *  @return void
+     */
+    void assignTable( const Site *const table, const size_t count );
+
+    /**
+     *  Loads a table serialized by exportSiteTable() and assigns it. No memory
+     *  is allocated. The sites point into the blob, so both the blob and the
+     *  storage must outlive the decoder's use of the table.
+     *
+     *  @param[in]  blob      Serialized site table
+     *  @param[in]  size      Number of bytes in the blob
+     *  @param[in]  storage   Sites to parse the table into
+     *  @param[in]  capacity  Number of entries in storage
+     *  @return size_t        Number of sites loaded, zero if the blob is invalid or doesn't fit
+     */
+    size_t loadTable( const void *const blob, const size_t size, Site *const storage, const size_t capacity );
+
+    /**
+     *  Looks up a call site by its ID
+     *
+     *  @param[in]  id        ID to look up
+     *  @return const Site*   nullptr if not found
+     */
+    const Site *lookup( const uint32_t id ) const;
+
+    /**
+     *  Renders a single record as text
+     *
+     *  @param[in]  record    Start of the record
+     *  @param[in]  length    Bytes available at the record pointer
+     *  @param[out] out       Buffer to render into. Always null terminated.
+     *  @param[in]  outSize   Size of the output buffer
+     *  @return size_t        Number of record bytes consumed, or zero if invalid
+     */
+    size_t decode( const void *const record, const size_t length, char *const out, const size_t outSize ) const;
+
+  private:
+    const Site *mTable;
+    size_t      mCount;
+  };
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Stamps the record header in front of already encoded arguments and sends
+   *  the record to every registered sink.
+   *
+   *  @param[in]  site      Call site that logged
+   *  @param[in]  record    Buffer with space for the header, then the arguments
+   *  @param[in]  args      Writer that encoded the arguments
+   *  @return Result
+   */
+  Result emit( const Site &site, uint8_t *const record, const ArgWriter &args );
+
+  /**
+   *  Same as above, but stamps the record with a time captured earlier
+   *
+   *  @param[in]  site      Call site that logged
+   *  @param[in]  timestamp Time the statement executed, in ms
+   *  @param[in]  record    Buffer with space for the header, then the arguments
+   *  @param[in]  args      Writer that encoded the arguments
+   *  @return Result
+   */
+  Result emit( const Site &site, const uint32_t timestamp, uint8_t *const record, const ArgWriter &args );
+
+  /**
+   *  Serializes this image's site table so a decoder outside of the image can
+   *  use it. The table is streamed out one piece at a time, so it can go to a
+   *  file or a debug channel without staging the whole thing in RAM.
+   *
+   *  @param[in]  writer    Receives the serialized table
+   *  @return bool          True if every piece was accepted
+   */
+  bool exportSiteTable( const TableWriter &writer );
+
+}  // namespace Aurora::Logging::Binary
+
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Binary equivalent of flog(). Nothing is formatted on the device, only the
+   *  site ID, a timestamp, and the raw argument values are recorded.
+   *
+   *  @param[in]  site      Call site that is logging
+   *  @param[in]  args      Arguments matching the site format string
+   *  @return Result
+   */
+  template<typename... Args>
+  Result blog( const Site &site, const Args... args )
+  {
+    if ( !isEnabled( site.level ) )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    if ( !admit( &site, argHash( args... ) ) )
+    {
+      return Result::RESULT_IGNORE;
+    }
+
+    std::array<uint8_t, sizeof( Binary::RecordHeader ) + ULOG_BINARY_MAX_ARG_BYTES> record;
+    Binary::ArgWriter writer( record.data() + sizeof( Binary::RecordHeader ), ULOG_BINARY_MAX_ARG_BYTES );
+
+    ( writer.write( args ), ... );
+    return Binary::emit( site, record.data(), writer );
+  }
+
+}  // namespace Aurora::Logging
+
+#endif /* !AURORA_LOGGING_BINARY_HPP */
@@ -28,6 +28,158 @@ Aurora Configuration
  */
 #define ULOG_MAX_SNPRINTF_BUFFER_LENGTH ( 256u )
 
+/**
+ *  Size of the buffer each LOG_* message is formatted into, timestamp and
+ *  prefix included. This is the longest text message a sink will be given.
+ */
+#if !defined( ULOG_MAX_MESSAGE_LENGTH )
+#define ULOG_MAX_MESSAGE_LENGTH ( 512u )
+#endif
+
+/**
+ *  Default token bucket applied to every LOG_* statement. Each statement may
+ *  burst up to ULOG_RATE_LIMIT_BURST messages, then gets one more per
+ *  ULOG_RATE_LIMIT_PERIOD milliseconds. A burst of zero disables limiting.
+ *  A translation unit may override these by defining AURORA_LOG_MODULE_RATE_BURST
+ *  and AURORA_LOG_MODULE_RATE_PERIOD before including any logging headers.
+ */
+#if !defined( ULOG_RATE_LIMIT_BURST )
+#define ULOG_RATE_LIMIT_BURST ( 0u )
+#endif
+
+#if !defined( ULOG_RATE_LIMIT_PERIOD )
+#define ULOG_RATE_LIMIT_PERIOD ( 100u )
+#endif
+
+/**
+ *  Collapses back to back identical messages from the same statement into a
+ *  single "repeated N times" summary. The summary is emitted when the statement
+ *  logs a different message, or every ULOG_DUPLICATE_REPORT_PERIOD milliseconds
+ *  while the repetition continues. flushSummaries() reports runs that have
+ *  stopped once that period has passed.
+ */
+#if !defined( ULOG_COLLAPSE_DUPLICATES )
+#define ULOG_COLLAPSE_DUPLICATES ( 0 )
+#endif
+
+#if !defined( ULOG_DUPLICATE_REPORT_PERIOD )
+#define ULOG_DUPLICATE_REPORT_PERIOD ( 1000u )
+#endif
+
+/**
+ *  Numeric equivalents of Logging::Level for use with the preprocessor
+ */
+#define ULOG_LEVEL_TRACE ( 0 )
+#define ULOG_LEVEL_DEBUG ( 1 )
+#define ULOG_LEVEL_INFO ( 2 )
+#define ULOG_LEVEL_WARN ( 3 )
+#define ULOG_LEVEL_ERROR ( 4 )
+#define ULOG_LEVEL_FATAL ( 5 )
+#define ULOG_LEVEL_OFF ( 6 )
+
+/**
+ *  Lowest level that gets compiled into the image. LOG_* statements below
+ *  this level expand to nothing, so they cost no code space or cycles. A
+ *  translation unit may override this by defining AURORA_LOG_MODULE_LEVEL
+ *  before including any Aurora logging headers.
+ */
+#if !defined( ULOG_COMPILE_LEVEL )
+#define ULOG_COMPILE_LEVEL ULOG_LEVEL_TRACE
+#endif
+
+/**
+ *  Builds the asynchronous logging pipeline behind enableAsync(). Its queue
+ *  is static RAM that's reserved whether or not the pipeline is used, so it
+ *  stays out of the image unless asked for. enableAsync() fails without it.
+ */
+#if !defined( ULOG_ASYNC_ENABLED )
+#define ULOG_ASYNC_ENABLED ( 0 )
+#endif
+
+/**
+ *  Number of messages the asynchronous logging queue can hold. Each entry
+ *  consumes a little over ULOG_MAX_MESSAGE_LENGTH bytes. Must be a power of
+ *  two. Only used when ULOG_ASYNC_ENABLED is set.
+ */
+#if !defined( ULOG_ASYNC_QUEUE_DEPTH )
+#define ULOG_ASYNC_QUEUE_DEPTH ( 16u )
+#endif
+
+/**
+ *  Number of messages each AsyncSink can buffer for its wrapped sink. Must be
+ *  a power of two.
+ */
+#if !defined( ULOG_ASYNC_SINK_QUEUE_DEPTH )
+#define ULOG_ASYNC_SINK_QUEUE_DEPTH ( 8u )
+#endif
+
+/**
+ *  How long AsyncSink::drainThread() sleeps when it finds its queue empty, in
+ *  milliseconds. Shorter periods deliver messages sooner at the cost of more
+ *  wakeups.
+ */
+#if !defined( ULOG_ASYNC_SINK_POLL_PERIOD_MS )
+#define ULOG_ASYNC_SINK_POLL_PERIOD_MS ( 5u )
+#endif
+
+/**
+ *  Enables binary logging mode. Instead of formatting text on the device,
+ *  each LOG_* statement emits its call site ID, a timestamp, and the raw
+ *  argument values. Text is reconstructed later by Binary::Decoder.
+ */
+#if !defined( ULOG_BINARY_MODE )
+#define ULOG_BINARY_MODE ( 0 )
+#endif
+
+/**
+ *  Max number of bytes the encoded arguments of a single binary log
+ *  statement may consume. Arguments that don't fit are dropped.
+ */
+#if !defined( ULOG_BINARY_MAX_ARG_BYTES )
+#define ULOG_BINARY_MAX_ARG_BYTES ( 128u )
+#endif
+
+/**
+ *  Number of LOG_ISR records that can be waiting to be rendered. Must be a
+ *  power of two.
+ */
+#if !defined( ULOG_ISR_QUEUE_DEPTH )
+#define ULOG_ISR_QUEUE_DEPTH ( 32u )
+#endif
+
+/**
+ *  Linker section for RAM that survives a warm reset, used to place the
+ *  PersistentSink buffer with AURORA_LOG_NOINIT_ATTR
+ */
+#if !defined( ULOG_NOINIT_SECTION )
+#define ULOG_NOINIT_SECTION ".noinit"
+#endif
+
+/**
+ *  How LOG_KV records are handed to the sinks. Binary sends the protobuf
+ *  encoded record as is, leaving rendering to the host. Text and JSON render
+ *  on the device first.
+ */
+#define ULOG_KV_FORMAT_BINARY ( 0 )
+#define ULOG_KV_FORMAT_TEXT ( 1 )
+#define ULOG_KV_FORMAT_JSON ( 2 )
+
+#if !defined( ULOG_KV_FORMAT )
+#if ULOG_BINARY_MODE
+#define ULOG_KV_FORMAT ULOG_KV_FORMAT_BINARY
+#else
+#define ULOG_KV_FORMAT ULOG_KV_FORMAT_TEXT
+#endif
+#endif
+
+/**
+ *  Max size of an encoded LOG_KV record, including its header. Fields that
+ *  don't fit are dropped.
+ */
+#if !defined( ULOG_KV_MAX_RECORD_BYTES )
+#define ULOG_KV_MAX_RECORD_BYTES ( 128u )
+#endif
+
 
 /*-----------------------------------------------------------------------------
 NanoPrintf Configuration:
@@ -11,6 +11,7 @@
 /*-----------------------------------------------------------------------------
 Includes
 -----------------------------------------------------------------------------*/
+#include <algorithm>
 #include <array>
 #include <cstdarg>
 #include <cstdint>
@@ -26,7 +27,14 @@ namespace Aurora::Logging
   /*---------------------------------------------------------------------------
   Constants
   ---------------------------------------------------------------------------*/
-  static constexpr size_t LOG_BUF_SIZE = 512;
+  static constexpr size_t LOG_BUF_SIZE = ULOG_MAX_MESSAGE_LENGTH;
+
+  static_assert( static_cast<size_t>( Level::LVL_TRACE ) == ULOG_LEVEL_TRACE );
+  static_assert( static_cast<size_t>( Level::LVL_DEBUG ) == ULOG_LEVEL_DEBUG );
+  static_assert( static_cast<size_t>( Level::LVL_INFO ) == ULOG_LEVEL_INFO );
+  static_assert( static_cast<size_t>( Level::LVL_WARN ) == ULOG_LEVEL_WARN );
+  static_assert( static_cast<size_t>( Level::LVL_ERROR ) == ULOG_LEVEL_ERROR );
+  static_assert( static_cast<size_t>( Level::LVL_FATAL ) == ULOG_LEVEL_FATAL );
 
   /*---------------------------------------------------------------------------
   Static Data
@@ -52,6 +60,32 @@ namespace Aurora::Logging
    */
   static size_t getSinkOffsetIndex( const SinkHandle_rPtr &sinkHandle );
 
+  /**
+   *  Sends a message to every registered sink that can take it
+   *
+   *  @param[in]  level       The severity level of the message
+   *  @param[in]  message     Raw message bytes
+   *  @param[in]  length      Number of bytes in the message
+   *  @param[in]  binary      Message is a binary record, skip text only sinks
+   *  @return Result
+   */
+  static Result sendToSinks( const Level level, const void *const message, const size_t length, const bool binary );
+
+  /**
+   *  Formats a message into the shared log buffer and sends it off
+   *
+   *  @param[in]  lvl         The severity level of the message
+   *  @param[in]  timestamp   Time the message was generated, in ms
+   *  @param[in]  prefix      Prebuilt "[file:line][LEVEL] -- " text, or null to render one from file and line
+   *  @param[in]  file        File the message came from, used when there's no prefix
+   *  @param[in]  line        Line the message came from, used when there's no prefix
+   *  @param[in]  fmt         Format string
+   *  @param[in]  args        Format arguments
+   *  @return Result
+   */
+  static Result vflog( const Level lvl, const size_t timestamp, const Prefix *const prefix, const char *const file,
+                       const size_t line, const char *fmt, va_list args );
+
 
   /*---------------------------------------------------------------------------
   Public Functions
@@ -77,6 +111,18 @@ namespace Aurora::Logging
   }
 
 
+  bool isEnabled( const Level lvl )
+  {
+    return lvl >= globalLogLevel;
+  }
+
+
+  std::string_view levelString( const Level lvl )
+  {
+    return levelName( lvl );
+  }
+
+
   Result registerSink( SinkHandle_rPtr &sink, const Config options )
   {
     constexpr size_t invalidIndex = std::numeric_limits<size_t>::max();
@@ -223,32 +269,45 @@ namespace Aurora::Logging
 
   Result log( const Level level, const void *const message, const size_t length )
   {
-    /*-------------------------------------------------------------------------
-    Input boundary checking
-    -------------------------------------------------------------------------*/
-    Chimera::Thread::TimedLockGuard x( threadLock );
-    if ( !x.try_lock_for( defaultLockTimeout ) )
+    if ( isAsyncEnabled() )
     {
-      return Result::RESULT_LOCKED;
-    }
-    else if ( ( level < globalLogLevel ) || !message || !length )
-    {
-      return Result::RESULT_FAIL;
+      if ( ( level < globalLogLevel ) || !message || !length )
+      {
+        return Result::RESULT_FAIL;
+      }
+
+      return enqueue( level, message, length );
     }
 
-    /*-------------------------------------------------------------------------
-    Process the message through each sink. At the moment
-    we won't concern ourselves if a sink failed to log.
-    -------------------------------------------------------------------------*/
-    for ( size_t i = 0; i < sinkRegistry.size(); i++ )
+    return dispatch( level, message, length );
+  }
+
+
+  Result dispatch( const Level level, const void *const message, const size_t length )
+  {
+    return sendToSinks( level, message, length, false );
+  }
+
+
+  Result logBinary( const Level level, const void *const message, const size_t length )
+  {
+    if ( isAsyncEnabled() )
     {
-      if ( sinkRegistry[ i ] && ( sinkRegistry[ i ]->logLevel >= globalLogLevel ) )
+      if ( ( level < globalLogLevel ) || !message || !length )
       {
-        sinkRegistry[ i ]->log( level, message, length );
+        return Result::RESULT_FAIL;
       }
+
+      return enqueue( level, message, length, true );
     }
 
-    return Result::RESULT_SUCCESS;
+    return dispatchBinary( level, message, length );
+  }
+
+
+  Result dispatchBinary( const Level level, const void *const message, const size_t length )
+  {
+    return sendToSinks( level, message, length, true );
   }
 
 
@@ -263,63 +322,161 @@ namespace Aurora::Logging
     }
 
     /*-------------------------------------------------------------------------
-    Create the logging level
+    Make sure the level has a name to print
     -------------------------------------------------------------------------*/
-    std::string_view str_level = "";
-    switch ( lvl )
+    if ( levelString( lvl ).empty() )
     {
-      case Level::LVL_TRACE:
-        str_level = "TRACE";
-        break;
-
-      case Level::LVL_DEBUG:
-        str_level = "DEBUG";
-        break;
-
-      case Level::LVL_INFO:
-        str_level = "INFO";
-        break;
+      return Result::RESULT_INVALID_LEVEL;
+    }
 
-      case Level::LVL_WARN:
-        str_level = "WARN";
-        break;
+    /*-------------------------------------------------------------------------
+    Call sites without a descriptor have their prefix rendered at runtime
+    -------------------------------------------------------------------------*/
+    va_list argptr;
+    va_start( argptr, fmt );
+    const Result result = vflog( lvl, Chimera::millis(), nullptr, file, line, fmt, argptr );
+    va_end( argptr );
 
-      case Level::LVL_ERROR:
-        str_level = "ERROR";
-        break;
+    return result;
+  }
 
-      case Level::LVL_FATAL:
-        str_level = "FATAL";
-        break;
 
-      default:
-        return Result::RESULT_INVALID_LEVEL;
-    };
+  Result flog( const Site *const site, ... )
+  {
+    /*-------------------------------------------------------------------------
+    Input boundary checking
+    -------------------------------------------------------------------------*/
+    if ( !site || !site->prefix || !site->fmt || ( site->level < globalLogLevel ) )
+    {
+      return Result::RESULT_FAIL;
+    }
 
     /*-------------------------------------------------------------------------
-    Format the message header
+    Everything but the timestamp and user arguments was rendered at compile time
     -------------------------------------------------------------------------*/
-    RT_DBG_ASSERT( Chimera::System::inISR() == false );
-    Chimera::Thread::LockGuard _lock( s_format_lock );
+    va_list argptr;
+    va_start( argptr, site );
+    const Result result = vflog( site->level, Chimera::millis(), site->prefix, site->file, site->line, site->fmt, argptr );
+    va_end( argptr );
 
-    memset( s_log_buffer, 0, LOG_BUF_SIZE );
-    npf_snprintf( s_log_buffer, LOG_BUF_SIZE, "[%lu][%s:%lu][%s] -- ",
-                  Chimera::millis(), file, line, str_level.data() );
+    return result;
+  }
 
+
+  Result flogAt( const size_t timestamp, const Site *const site, ... )
+  {
     /*-------------------------------------------------------------------------
-    Format the user message
+    Input boundary checking
     -------------------------------------------------------------------------*/
-    const size_t offset = strlen( s_log_buffer );
+    if ( !site || !site->prefix || !site->fmt || ( site->level < globalLogLevel ) )
+    {
+      return Result::RESULT_FAIL;
+    }
 
     va_list argptr;
-    va_start( argptr, fmt );
-    npf_vsnprintf( s_log_buffer + offset, LOG_BUF_SIZE - offset, fmt, argptr );
+    va_start( argptr, site );
+    const Result result = vflog( site->level, timestamp, site->prefix, site->file, site->line, site->fmt, argptr );
     va_end( argptr );
 
+    return result;
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static Result sendToSinks( const Level level, const void *const message, const size_t length, const bool binary )
+  {
+    /*-------------------------------------------------------------------------
+    Input boundary checking
+    -------------------------------------------------------------------------*/
+    Chimera::Thread::TimedLockGuard x( threadLock );
+    if ( !x.try_lock_for( defaultLockTimeout ) )
+    {
+      return Result::RESULT_LOCKED;
+    }
+    else if ( ( level < globalLogLevel ) || !message || !length )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    /*-------------------------------------------------------------------------
+    Process the message through each sink. At the moment
+    we won't concern ourselves if a sink failed to log.
+    -------------------------------------------------------------------------*/
+    for ( size_t i = 0; i < sinkRegistry.size(); i++ )
+    {
+      if ( sinkRegistry[ i ] && ( sinkRegistry[ i ]->logLevel >= globalLogLevel )
+           && ( !binary || sinkRegistry[ i ]->acceptsBinary() ) )
+      {
+        sinkRegistry[ i ]->log( level, message, length );
+      }
+    }
+
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  static Result vflog( const Level lvl, const size_t timestamp, const Prefix *const prefix, const char *const file,
+                       const size_t line, const char *fmt, va_list args )
+  {
+    RT_DBG_ASSERT( Chimera::System::inISR() == false );
+
+#if ULOG_ASYNC_ENABLED
+    AsyncRecord record;
+    bool        truncated = false;
+#endif
+    {
+      Chimera::Thread::LockGuard _lock( s_format_lock );
+
+      /*-----------------------------------------------------------------------
+      Format the timestamp, then copy in the prebuilt prefix or render it
+      straight into the buffer so long file names don't crowd out the level.
+      -----------------------------------------------------------------------*/
+      const int ts_len = npf_snprintf( s_log_buffer, LOG_BUF_SIZE, "[%lu]", static_cast<unsigned long>( timestamp ) );
+      size_t    offset = std::min<size_t>( std::max( ts_len, 0 ), LOG_BUF_SIZE - 1u );
+
+      if ( prefix )
+      {
+        const size_t copy = std::min<size_t>( prefix->length, LOG_BUF_SIZE - 1u - offset );
+        memcpy( s_log_buffer + offset, prefix->text, copy );
+        offset += copy;
+      }
+      else
+      {
+        const int len = npf_snprintf( s_log_buffer + offset, LOG_BUF_SIZE - offset, "[%s:%lu][%s] -- ", file,
+                                      static_cast<unsigned long>( line ), levelName( lvl ) );
+        offset += std::min<size_t>( std::max( len, 0 ), LOG_BUF_SIZE - 1u - offset );
+      }
+
+      /*-----------------------------------------------------------------------
+      Format the user message
+      -----------------------------------------------------------------------*/
+      const int msg_len = npf_vsnprintf( s_log_buffer + offset, LOG_BUF_SIZE - offset, fmt, args );
+      offset += std::min<size_t>( std::max( msg_len, 0 ), LOG_BUF_SIZE - 1u - offset );
+
+      /*-----------------------------------------------------------------------
+      Synchronous logging goes straight out through the standard method
+      -----------------------------------------------------------------------*/
+      if ( !isAsyncEnabled() )
+      {
+        return log( lvl, s_log_buffer, offset );
+      }
+
+#if ULOG_ASYNC_ENABLED
+      truncated = packRecord( lvl, s_log_buffer, offset, record );
+#endif
+    }
+
     /*-------------------------------------------------------------------------
-    Log through the standard method
+    Queue outside the format lock. The BLOCK policy may sleep waiting for room
+    and that shouldn't stall every other logger.
     -------------------------------------------------------------------------*/
-    return log( lvl, s_log_buffer, strlen( s_log_buffer ) );
+#if ULOG_ASYNC_ENABLED
+    return enqueue( record, truncated );
+#else
+    return Result::RESULT_FAIL;
+#endif
   }
 
 }  // namespace Aurora::Logging
\ No newline at end of file
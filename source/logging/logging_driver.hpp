@@ -16,11 +16,13 @@
 Includes
 -----------------------------------------------------------------------------*/
 #include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_site.hpp>
 #include <Aurora/source/logging/logging_types.hpp>
 #include <array>
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <string_view>
 
 namespace Aurora::Logging
 {
@@ -43,6 +45,22 @@ namespace Aurora::Logging
    */
   Result setGlobalLogLevel( const Level level );
 
+  /**
+   *  Checks if a message at the given level would be emitted at all
+   *
+   *  @param[in]  lvl        The level to check
+   *  @return bool
+   */
+  bool isEnabled( const Level lvl );
+
+  /**
+   *  Gets the printable name of a logging level
+   *
+   *  @param[in]  lvl        The level to convert
+   *  @return std::string_view  Empty if the level is invalid
+   */
+  std::string_view levelString( const Level lvl );
+
   /**
    *  Registers a sink with the back end driver
    *
@@ -87,6 +105,39 @@ namespace Aurora::Logging
    */
   Result log( const Level lvl, const void *const msg, const size_t length );
 
+  /**
+   *  Sends a message straight to every registered sink from the calling
+   *  context, bypassing the asynchronous queue even if it's enabled.
+   *
+   *  @param[in]  lvl       The severity level of the message to be logged
+   *  @param[in]  msg       Raw byte message to be logged
+   *  @param[in]  length    Length of the log message
+   *  @return Result
+   */
+  Result dispatch( const Level lvl, const void *const msg, const size_t length );
+
+  /**
+   *  Same as log(), but for raw binary records. Only sinks that accept binary
+   *  data receive them, text sinks are skipped.
+   *
+   *  @param[in]  lvl       The severity level of the record
+   *  @param[in]  msg       Encoded record
+   *  @param[in]  length    Length of the record in bytes
+   *  @return Result
+   */
+  Result logBinary( const Level lvl, const void *const msg, const size_t length );
+
+  /**
+   *  Same as dispatch(), but for raw binary records. Only sinks that accept
+   *  binary data receive them, text sinks are skipped.
+   *
+   *  @param[in]  lvl       The severity level of the record
+   *  @param[in]  msg       Encoded record
+   *  @param[in]  length    Length of the record in bytes
+   *  @return Result
+   */
+  Result dispatchBinary( const Level lvl, const void *const msg, const size_t length );
+
   /**
    *  Logs a formatted string to every registered sink that is listening to the
    *  requested logging level.
@@ -99,6 +150,26 @@ namespace Aurora::Logging
    */
   Result flog( const Level lvl, const char *const file, const size_t line, const char *fmt, ... );
 
+  /**
+   *  Logs a formatted string using a call site descriptor built at compile
+   *  time. Only the timestamp and user arguments are formatted at runtime.
+   *
+   *  @param[in]  site      Descriptor of the statement doing the logging
+   *  @return Result
+   */
+  Result flog( const Site *const site, ... );
+
+  /**
+   *  Same as flog() with a call site descriptor, but stamps the message with a
+   *  time captured earlier instead of the current time. Used when rendering
+   *  messages that were recorded in a context that couldn't format them.
+   *
+   *  @param[in]  timestamp Time the message was recorded, in ms
+   *  @param[in]  site      Descriptor of the statement doing the logging
+   *  @return Result
+   */
+  Result flogAt( const size_t timestamp, const Site *const site, ... );
+
 }  // namespace Aurora::Logging
 
 #endif /* AURORA_LOGGING_DRIVER_HPP */
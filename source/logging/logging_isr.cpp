@@ -0,0 +1,98 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_isr.cpp
+ *
+ *  Description:
+ *    Interrupt safe logging queue and its thread side renderer
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/container>
+#include <Aurora/logging>
+#include <array>
+#include <atomic>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static Aurora::Container::LockFreeQueue<ISRRecord, ULOG_ISR_QUEUE_DEPTH> s_isr_queue;
+  static std::atomic<size_t>                                              s_isr_dropped = 0;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Renders a single record through whichever backend is active
+   *
+   *  @param[in]  record    Record to render
+   *  @return void
+   */
+  static void render( const ISRRecord &record )
+  {
+#if ULOG_BINARY_MODE
+    std::array<uint8_t, sizeof( Binary::RecordHeader ) + ULOG_BINARY_MAX_ARG_BYTES> buffer;
+    Binary::ArgWriter writer( buffer.data() + sizeof( Binary::RecordHeader ), ULOG_BINARY_MAX_ARG_BYTES );
+
+    for ( size_t i = 0; i < record.nargs; i++ )
+    {
+      if ( record.signedMask & ( 1u << i ) )
+      {
+        writer.write( static_cast<int32_t>( record.args[ i ] ) );
+      }
+      else
+      {
+        writer.write( record.args[ i ] );
+      }
+    }
+
+    Binary::emit( *record.site, record.timestamp, buffer.data(), writer );
+#else
+    /*-------------------------------------------------------------------------
+    Unused arguments are zeroed and ignored by the formatter, so pass them all
+    -------------------------------------------------------------------------*/
+    flogAt( record.timestamp, record.site, record.args[ 0 ], record.args[ 1 ], record.args[ 2 ], record.args[ 3 ] );
+#endif
+  }
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  bool pushISR( const ISRRecord &record )
+  {
+    if ( !s_isr_queue.push( record ) )
+    {
+      s_isr_dropped.fetch_add( 1, std::memory_order_relaxed );
+      return false;
+    }
+
+    return true;
+  }
+
+
+  size_t processISRLogs( const size_t limit )
+  {
+    ISRRecord record;
+    size_t    count = 0;
+
+    while ( ( count < limit ) && s_isr_queue.pop( record ) )
+    {
+      render( record );
+      count++;
+    }
+
+    return count;
+  }
+
+
+  size_t getISRDropped()
+  {
+    return s_isr_dropped.load();
+  }
+
+}  // namespace Aurora::Logging
@@ -0,0 +1,112 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_isr.hpp
+ *
+ *  Description:
+ *    Interrupt safe logging that defers formatting to thread context
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_ISR_HPP
+#define AURORA_LOGGING_ISR_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_driver.hpp>
+#include <Aurora/source/logging/logging_site.hpp>
+#include <Aurora/source/logging/logging_types.hpp>
+#include <Chimera/common>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t ISR_MAX_ARGS = 4;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Everything needed to render a LOG_ISR statement later on
+   */
+  struct ISRRecord
+  {
+    const Site *site;                 /**< Statement that logged */
+    uint32_t    timestamp;            /**< Time of the log call in ms */
+    uint8_t     nargs;                /**< Number of valid arguments */
+    uint8_t     signedMask;           /**< Bit N set if argument N is signed */
+    uint32_t    args[ ISR_MAX_ARGS ]; /**< Raw argument values */
+  };
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Places a record into the ISR queue without blocking or taking locks
+   *
+   *  @param[in]  record    Record to queue
+   *  @return bool          False if the queue was full and the record dropped
+   */
+  bool pushISR( const ISRRecord &record );
+
+  /**
+   *  Renders queued ISR records and sends them to the registered sinks. Must
+   *  be called from thread context. asyncDrainThread() does this automatically.
+   *
+   *  @param[in]  limit     Max number of records to process
+   *  @return size_t        Number of records processed
+   */
+  size_t processISRLogs( const size_t limit );
+
+  /**
+   *  Number of ISR records lost because the queue was full
+   *
+   *  @return size_t
+   */
+  size_t getISRDropped();
+
+  /**
+   *  Backend for LOG_ISR. Captures the raw argument values and queues them,
+   *  which costs a timestamp read, a few stores, and one compare-exchange.
+   *
+   *  @param[in]  site      Call site that is logging
+   *  @param[in]  args      Up to ISR_MAX_ARGS integer arguments, 32 bits or narrower
+   *  @return void
+   */
+  template<typename... Args>
+  void isrLog( const Site &site, const Args... args )
+  {
+    static_assert( sizeof...( Args ) <= ISR_MAX_ARGS, "Too many arguments for LOG_ISR" );
+    static_assert( ( ( std::is_integral_v<Args> || std::is_enum_v<Args> ) && ... ), "LOG_ISR only supports integers" );
+    static_assert( ( ( sizeof( Args ) <= sizeof( uint32_t ) ) && ... ), "LOG_ISR arguments must fit in 32 bits" );
+
+    if ( !isEnabled( site.level ) )
+    {
+      return;
+    }
+
+    ISRRecord record{};
+    record.site       = &site;
+    record.timestamp  = static_cast<uint32_t>( Chimera::millis() );
+    record.nargs      = static_cast<uint8_t>( sizeof...( Args ) );
+    record.signedMask = 0;
+
+    size_t idx = 0;
+    ( ( record.signedMask |= static_cast<uint8_t>( std::is_signed_v<Args> << idx ),
+        record.args[ idx++ ] = static_cast<uint32_t>( args ) ),
+      ... );
+
+    pushISR( record );
+  }
+
+}  // namespace Aurora::Logging
+
+#endif /* !AURORA_LOGGING_ISR_HPP */
@@ -0,0 +1,464 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_kv.cpp
+ *
+ *  Description:
+ *    Key/value record encoding and rendering
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/logging>
+#include <Chimera/common>
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+
+#include "pb_decode.h"
+#include "pb_encode.h"
+
+namespace Aurora::Logging::KV
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  /* KVRecord field numbers */
+  static constexpr uint32_t RECORD_EVENT  = 1;
+  static constexpr uint32_t RECORD_FIELDS = 2;
+
+  /* KVField field numbers */
+  static constexpr uint32_t FIELD_KEY  = 1;
+  static constexpr uint32_t FIELD_SINT = 2;
+  static constexpr uint32_t FIELD_UINT = 3;
+  static constexpr uint32_t FIELD_REAL = 4;
+  static constexpr uint32_t FIELD_TEXT = 5;
+  static constexpr uint32_t FIELD_FLAG = 6;
+
+  /* Longest key, event, or string value that gets rendered */
+  static constexpr size_t MAX_STRING = 64;
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static bool encodeString( pb_ostream_t *stream, const uint32_t field, const char *const str )
+  {
+    const char *src = str ? str : "";
+    return pb_encode_tag( stream, PB_WT_STRING, field ) &&
+           pb_encode_string( stream, reinterpret_cast<const pb_byte_t *>( src ), strlen( src ) );
+  }
+
+
+  /**
+   *  Appends a length delimited KVField. The field is sized first so that it
+   *  is either written completely or not at all.
+   *
+   *  @param[in]  buffer    Record buffer
+   *  @param[in]  size      Size of the record buffer
+   *  @param[in]  pos       Write position, advanced on success
+   *  @param[in]  body      Encodes the field contents into a stream
+   *  @return bool
+   */
+  template<typename Body>
+  static bool appendField( uint8_t *const buffer, const size_t size, size_t &pos, const Body &body )
+  {
+    pb_ostream_t sizing = PB_OSTREAM_SIZING;
+    if ( !body( &sizing ) )
+    {
+      return false;
+    }
+
+    pb_ostream_t stream = pb_ostream_from_buffer( buffer + pos, size - pos );
+    if ( !pb_encode_tag( &stream, PB_WT_STRING, RECORD_FIELDS ) || !pb_encode_varint( &stream, sizing.bytes_written ) ||
+         !body( &stream ) )
+    {
+      return false;
+    }
+
+    pos += stream.bytes_written;
+    return true;
+  }
+
+
+  static void append( char *const out, const size_t outSize, size_t &pos, const char *fmt, ... )
+  {
+    if ( pos >= ( outSize - 1u ) )
+    {
+      return;
+    }
+
+    va_list args;
+    va_start( args, fmt );
+    const int len = npf_vsnprintf( out + pos, outSize - pos, fmt, args );
+    va_end( args );
+
+    pos += std::min<size_t>( std::max( len, 0 ), outSize - 1u - pos );
+  }
+
+
+  static void appendQuoted( char *const out, const size_t outSize, size_t &pos, const char *str, const bool json )
+  {
+    if ( !json )
+    {
+      append( out, outSize, pos, "\"%s\"", str );
+      return;
+    }
+
+    append( out, outSize, pos, "\"" );
+    for ( ; *str != '\0'; str++ )
+    {
+      const unsigned char c = static_cast<unsigned char>( *str );
+      if ( ( c == '"' ) || ( c == '\\' ) )
+      {
+        append( out, outSize, pos, "\\%c", c );
+      }
+      else if ( c < 0x20 )
+      {
+        append( out, outSize, pos, "\\u%04x", c );
+      }
+      else
+      {
+        append( out, outSize, pos, "%c", c );
+      }
+    }
+    append( out, outSize, pos, "\"" );
+  }
+
+
+  /**
+   *  Renders a 64-bit integer in decimal. Done by hand since the printf
+   *  family can't be relied on for 64-bit conversions on every target.
+   */
+  static void appendDecimal( char *const out, const size_t outSize, size_t &pos, uint64_t magnitude, const bool negative )
+  {
+    char   digits[ 21 ];
+    size_t idx = sizeof( digits );
+
+    digits[ --idx ] = '\0';
+    do
+    {
+      digits[ --idx ] = static_cast<char>( '0' + ( magnitude % 10u ) );
+      magnitude /= 10u;
+    } while ( magnitude );
+
+    append( out, outSize, pos, "%s%s", negative ? "-" : "", &digits[ idx ] );
+  }
+
+
+  /**
+   *  Reads a string field, truncating it to fit and skipping the remainder
+   */
+  static bool decodeString( pb_istream_t *stream, char *const out, const size_t outSize )
+  {
+    uint32_t len = 0;
+    if ( !pb_decode_varint32( stream, &len ) )
+    {
+      return false;
+    }
+
+    const size_t keep = std::min<size_t>( len, outSize - 1u );
+    if ( !pb_read( stream, reinterpret_cast<pb_byte_t *>( out ), keep ) || !pb_read( stream, nullptr, len - keep ) )
+    {
+      return false;
+    }
+
+    out[ keep ] = '\0';
+    return true;
+  }
+
+
+  /**
+   *  Decodes a single KVField and renders it as "key=value" or "key":value
+   */
+  static bool renderField( pb_istream_t *stream, const bool json, const bool first, char *const out, const size_t outSize,
+                           size_t &pos )
+  {
+    char           key[ MAX_STRING ] = { 0 };
+    char           text[ MAX_STRING ];
+    pb_wire_type_t type;
+    uint32_t       tag   = 0;
+    bool           eof   = false;
+    uint32_t       which = 0;
+    int64_t        sint  = 0;
+    uint64_t       uint  = 0;
+    double         real  = 0.0;
+
+    while ( pb_decode_tag( stream, &type, &tag, &eof ) )
+    {
+      bool ok = true;
+      switch ( tag )
+      {
+        case FIELD_KEY:
+          ok = decodeString( stream, key, sizeof( key ) );
+          break;
+
+        case FIELD_SINT:
+          ok = pb_decode_svarint( stream, &sint );
+          break;
+
+        case FIELD_UINT:
+        case FIELD_FLAG:
+          ok = pb_decode_varint( stream, &uint );
+          break;
+
+        case FIELD_REAL:
+          ok = pb_decode_fixed64( stream, &real );
+          break;
+
+        case FIELD_TEXT:
+          ok = decodeString( stream, text, sizeof( text ) );
+          break;
+
+        default:
+          ok  = pb_skip_field( stream, type );
+          tag = 0;
+          break;
+      }
+
+      if ( !ok )
+      {
+        return false;
+      }
+
+      which = ( tag > FIELD_KEY ) ? tag : which;
+    }
+
+    if ( !eof )
+    {
+      return false;
+    }
+
+    /*-------------------------------------------------------------------------
+    Render the key
+    -------------------------------------------------------------------------*/
+    if ( json )
+    {
+      append( out, outSize, pos, first ? "" : "," );
+      appendQuoted( out, outSize, pos, key, true );
+      append( out, outSize, pos, ":" );
+    }
+    else
+    {
+      append( out, outSize, pos, " %s=", key );
+    }
+
+    /*-------------------------------------------------------------------------
+    Render the value
+    -------------------------------------------------------------------------*/
+    switch ( which )
+    {
+      case FIELD_SINT:
+        appendDecimal( out, outSize, pos, ( sint < 0 ) ? ( 0u - static_cast<uint64_t>( sint ) ) : static_cast<uint64_t>( sint ),
+                       sint < 0 );
+        break;
+
+      case FIELD_UINT:
+        appendDecimal( out, outSize, pos, uint, false );
+        break;
+
+      case FIELD_REAL:
+        append( out, outSize, pos, "%f", real );
+        break;
+
+      case FIELD_TEXT:
+        appendQuoted( out, outSize, pos, text, json );
+        break;
+
+      case FIELD_FLAG:
+        append( out, outSize, pos, "%s", uint ? "true" : "false" );
+        break;
+
+      default:
+        append( out, outSize, pos, "null" );
+        break;
+    }
+
+    return true;
+  }
+
+  /*---------------------------------------------------------------------------
+  Writer Implementation
+  ---------------------------------------------------------------------------*/
+  Writer::Writer( const char *const event ) : mPos( sizeof( Binary::RecordHeader ) ), mCount( 0 ), mDropped( 0 )
+  {
+    pb_ostream_t stream = pb_ostream_from_buffer( mBuffer.data() + mPos, mBuffer.size() - mPos );
+    if ( encodeString( &stream, RECORD_EVENT, event ) )
+    {
+      mPos += stream.bytes_written;
+    }
+  }
+
+
+  void Writer::add( const char *const key, const int64_t value )
+  {
+    const bool ok = appendField( mBuffer.data(), mBuffer.size(), mPos, [ & ]( pb_ostream_t *s ) {
+      return encodeString( s, FIELD_KEY, key ) && pb_encode_tag( s, PB_WT_VARINT, FIELD_SINT ) && pb_encode_svarint( s, value );
+    } );
+
+    ok ? mCount++ : mDropped++;
+  }
+
+
+  void Writer::add( const char *const key, const uint64_t value )
+  {
+    const bool ok = appendField( mBuffer.data(), mBuffer.size(), mPos, [ & ]( pb_ostream_t *s ) {
+      return encodeString( s, FIELD_KEY, key ) && pb_encode_tag( s, PB_WT_VARINT, FIELD_UINT ) && pb_encode_varint( s, value );
+    } );
+
+    ok ? mCount++ : mDropped++;
+  }
+
+
+  void Writer::add( const char *const key, const double value )
+  {
+    const bool ok = appendField( mBuffer.data(), mBuffer.size(), mPos, [ & ]( pb_ostream_t *s ) {
+      return encodeString( s, FIELD_KEY, key ) && pb_encode_tag( s, PB_WT_64BIT, FIELD_REAL ) && pb_encode_fixed64( s, &value );
+    } );
+
+    ok ? mCount++ : mDropped++;
+  }
+
+
+  void Writer::add( const char *const key, const bool value )
+  {
+    const bool ok = appendField( mBuffer.data(), mBuffer.size(), mPos, [ & ]( pb_ostream_t *s ) {
+      return encodeString( s, FIELD_KEY, key ) && pb_encode_tag( s, PB_WT_VARINT, FIELD_FLAG ) && pb_encode_varint( s, value );
+    } );
+
+    ok ? mCount++ : mDropped++;
+  }
+
+
+  void Writer::add( const char *const key, const char *const value )
+  {
+    const bool ok = appendField( mBuffer.data(), mBuffer.size(), mPos, [ & ]( pb_ostream_t *s ) {
+      return encodeString( s, FIELD_KEY, key ) && encodeString( s, FIELD_TEXT, value );
+    } );
+
+    ok ? mCount++ : mDropped++;
+  }
+
+
+  Result Writer::emit( const Level level )
+  {
+    Binary::RecordHeader hdr;
+    hdr.id        = RECORD_ID;
+    hdr.timestamp = static_cast<uint32_t>( Chimera::millis() );
+    hdr.level     = static_cast<uint8_t>( level );
+    hdr.nargs     = static_cast<uint8_t>( std::min<size_t>( mCount, 255u ) );
+    hdr.size      = static_cast<uint16_t>( mPos - sizeof( hdr ) );
+    memcpy( mBuffer.data(), &hdr, sizeof( hdr ) );
+
+#if ULOG_KV_FORMAT == ULOG_KV_FORMAT_BINARY
+    return Aurora::Logging::logBinary( level, mBuffer.data(), mPos );
+#else
+    char text[ ULOG_MAX_SNPRINTF_BUFFER_LENGTH ];
+    if ( !render( mBuffer.data(), mPos, static_cast<Format>( ULOG_KV_FORMAT ), text, sizeof( text ) ) )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    return Aurora::Logging::log( level, text, strlen( text ) );
+#endif
+  }
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  size_t render( const void *const record, const size_t length, const Format format, char *const out,
+                 const size_t outSize )
+  {
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( !record || !out || !outSize || ( format == Format::BINARY ) || ( length < sizeof( Binary::RecordHeader ) ) )
+    {
+      return 0;
+    }
+
+    Binary::RecordHeader hdr;
+    memcpy( &hdr, record, sizeof( hdr ) );
+
+    const size_t total = sizeof( hdr ) + hdr.size;
+    if ( ( hdr.id != RECORD_ID ) || ( total > length ) )
+    {
+      return 0;
+    }
+
+    const pb_byte_t *msg  = reinterpret_cast<const pb_byte_t *>( record ) + sizeof( hdr );
+    const bool       json = ( format == Format::JSON );
+    size_t           pos  = 0;
+    out[ 0 ]              = '\0';
+
+    /*-------------------------------------------------------------------------
+    Find the event name first so it leads the output regardless of where it
+    appears in the message
+    -------------------------------------------------------------------------*/
+    char           event[ MAX_STRING ] = { 0 };
+    pb_istream_t   stream              = pb_istream_from_buffer( msg, hdr.size );
+    pb_wire_type_t type;
+    uint32_t       tag = 0;
+    bool           eof = false;
+
+    while ( pb_decode_tag( &stream, &type, &tag, &eof ) )
+    {
+      const bool ok = ( tag == RECORD_EVENT ) ? decodeString( &stream, event, sizeof( event ) )
+                                              : pb_skip_field( &stream, type );
+      if ( !ok )
+      {
+        return 0;
+      }
+    }
+
+    const char *const lvl = levelString( static_cast<Level>( hdr.level ) ).data();
+    if ( json )
+    {
+      append( out, outSize, pos, "{\"ts\":%lu,\"level\":\"%s\",\"event\":", static_cast<unsigned long>( hdr.timestamp ),
+              lvl ? lvl : "" );
+      appendQuoted( out, outSize, pos, event, true );
+      append( out, outSize, pos, ",\"fields\":{" );
+    }
+    else
+    {
+      append( out, outSize, pos, "[%lu][%s] -- %s", static_cast<unsigned long>( hdr.timestamp ), lvl ? lvl : "", event );
+    }
+
+    /*-------------------------------------------------------------------------
+    Now render each field in the order it was logged
+    -------------------------------------------------------------------------*/
+    stream     = pb_istream_from_buffer( msg, hdr.size );
+    bool first = true;
+
+    while ( pb_decode_tag( &stream, &type, &tag, &eof ) )
+    {
+      if ( tag != RECORD_FIELDS )
+      {
+        if ( !pb_skip_field( &stream, type ) )
+        {
+          return 0;
+        }
+        continue;
+      }
+
+      pb_istream_t sub;
+      if ( !pb_make_string_substream( &stream, &sub ) )
+      {
+        return 0;
+      }
+
+      const bool ok = renderField( &sub, json, first, out, outSize, pos );
+      if ( !pb_close_string_substream( &stream, &sub ) || !ok )
+      {
+        return 0;
+      }
+
+      first = false;
+    }
+
+    append( out, outSize, pos, json ? "}}\r\n" : "\r\n" );
+    return total;
+  }
+
+}  // namespace Aurora::Logging::KV
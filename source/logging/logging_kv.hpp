@@ -0,0 +1,187 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_kv.hpp
+ *
+ *  Description:
+ *    Structured key/value logging encoded in the protobuf wire format
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_KV_HPP
+#define AURORA_LOGGING_KV_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_driver.hpp>
+#include <Aurora/source/logging/logging_site.hpp>
+#include <Aurora/source/logging/logging_types.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Aurora::Logging::KV
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Binary::RecordHeader::id reserved for key/value records. The protobuf
+   *  encoded KVRecord (see proto/kv_record.proto) follows the header. No call
+   *  site is ever given this ID.
+   */
+  static constexpr uint32_t RECORD_ID = RESERVED_SITE_ID;
+
+  /*---------------------------------------------------------------------------
+  Enumerations
+  ---------------------------------------------------------------------------*/
+  enum class Format : uint8_t
+  {
+    BINARY = ULOG_KV_FORMAT_BINARY, /**< Header followed by the protobuf message */
+    TEXT   = ULOG_KV_FORMAT_TEXT,   /**< [ts][LEVEL] event key=value ... */
+    JSON   = ULOG_KV_FORMAT_JSON,   /**< One JSON object per line */
+  };
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  A single named value. Build these with the AURORA_KV() macro.
+   */
+  template<typename T>
+  struct Field
+  {
+    const char *key;
+    T           value;
+  };
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Encodes an event and its fields into a KVRecord message. Fields that
+   *  don't fit in the buffer are dropped, never partially written.
+   */
+  class Writer
+  {
+  public:
+    /**
+     *  @param[in]  event     Name of the event being logged
+     */
+    explicit Writer( const char *const event );
+
+    void add( const char *const key, const int64_t value );
+    void add( const char *const key, const uint64_t value );
+    void add( const char *const key, const double value );
+    void add( const char *const key, const bool value );
+    void add( const char *const key, const char *const value );
+
+    /**
+     *  Stamps the record header and sends the record to the sinks, rendering
+     *  it first if ULOG_KV_FORMAT asks for text or JSON
+     *
+     *  @param[in]  level     Severity level of the record
+     *  @return Result
+     */
+    Result emit( const Level level );
+
+    /**
+     *  @return size_t  Number of fields dropped for lack of space
+     */
+    size_t dropped() const
+    {
+      return mDropped;
+    }
+
+  private:
+    std::array<uint8_t, ULOG_KV_MAX_RECORD_BYTES> mBuffer; /**< Record header, then the message */
+    size_t                                        mPos;
+    size_t                                        mCount;
+    size_t                                        mDropped;
+  };
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Renders a key/value record as text or JSON. Works on the device and on
+   *  the host, given the raw bytes a sink received.
+   *
+   *  @param[in]  record    Start of the record, including the header
+   *  @param[in]  length    Bytes available at the record pointer
+   *  @param[in]  format    Format::TEXT or Format::JSON
+   *  @param[out] out       Buffer to render into. Always null terminated.
+   *  @param[in]  outSize   Size of the output buffer
+   *  @return size_t        Number of record bytes consumed, or zero if invalid
+   */
+  size_t render( const void *const record, const size_t length, const Format format, char *const out,
+                 const size_t outSize );
+
+  /**
+   *  Builds a field, normalizing the value into one of the encodable types
+   *
+   *  @param[in]  key       Name of the field
+   *  @param[in]  value     Value of the field
+   *  @return Field
+   */
+  template<typename T>
+  constexpr auto makeField( const char *const key, const T value )
+  {
+    if constexpr ( std::is_same_v<T, bool> )
+    {
+      return Field<bool>{ key, value };
+    }
+    else if constexpr ( std::is_same_v<T, const char *> || std::is_same_v<T, char *> )
+    {
+      return Field<const char *>{ key, value };
+    }
+    else if constexpr ( std::is_enum_v<T> )
+    {
+      return makeField( key, static_cast<std::underlying_type_t<T>>( value ) );
+    }
+    else if constexpr ( std::is_floating_point_v<T> )
+    {
+      return Field<double>{ key, static_cast<double>( value ) };
+    }
+    else if constexpr ( std::is_integral_v<T> && std::is_signed_v<T> )
+    {
+      return Field<int64_t>{ key, static_cast<int64_t>( value ) };
+    }
+    else if constexpr ( std::is_integral_v<T> )
+    {
+      return Field<uint64_t>{ key, static_cast<uint64_t>( value ) };
+    }
+    else
+    {
+      static_assert( !std::is_same_v<T, T>, "Unsupported key/value log field type" );
+    }
+  }
+
+  /**
+   *  Backend for LOG_KV
+   *
+   *  @param[in]  level     Severity level of the record
+   *  @param[in]  event     Name of the event
+   *  @param[in]  fields    Fields built with AURORA_KV()
+   *  @return Result
+   */
+  template<typename... Fields>
+  Result log( const Level level, const char *const event, const Fields... fields )
+  {
+    if ( !isEnabled( level ) )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    Writer writer( event );
+    ( writer.add( fields.key, fields.value ), ... );
+    return writer.emit( level );
+  }
+
+}  // namespace Aurora::Logging::KV
+
+#endif /* !AURORA_LOGGING_KV_HPP */
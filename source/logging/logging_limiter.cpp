@@ -0,0 +1,235 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_limiter.cpp
+ *
+ *  Description:
+ *    Per call site rate limiting and duplicate message suppression
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/logging>
+#include <Chimera/common>
+#include <Chimera/thread>
+#include <algorithm>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Static Data
+  ---------------------------------------------------------------------------*/
+  static Chimera::Thread::Mutex s_limiter_lock;
+  static const Site            *s_pending = nullptr; /**< Sites that may be holding back a repeat summary */
+
+  /*---------------------------------------------------------------------------
+  Summary Call Sites
+  ---------------------------------------------------------------------------*/
+  static constexpr const char *REPEAT_FMT   = "Message at %s:%lu repeated %lu times\r\n";
+  static constexpr const char *SUPPRESS_FMT = "Message at %s:%lu rate limited %lu times\r\n";
+
+  AURORA_LOG_DEFINE_PREFIX( s_repeat_prefix, "ulog", __LINE__, Level::LVL_WARN );
+  AURORA_LOG_DEFINE_PREFIX( s_suppress_prefix, "ulog", __LINE__, Level::LVL_WARN );
+
+  AURORA_LOG_SITE_ATTR static const Site s_repeat_site{
+    siteId( __FILE__, __LINE__, __COUNTER__ ), Level::LVL_WARN, "ulog", __LINE__, REPEAT_FMT, &s_repeat_prefix,
+    nullptr
+  };
+
+  AURORA_LOG_SITE_ATTR static const Site s_suppress_site{
+    siteId( __FILE__, __LINE__, __COUNTER__ ), Level::LVL_WARN, "ulog", __LINE__, SUPPRESS_FMT, &s_suppress_prefix,
+    nullptr
+  };
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Emits a summary message through whichever backend is active
+   *
+   *  @param[in]  summary   Site describing the summary
+   *  @param[in]  about     Site the summary is reporting on
+   *  @param[in]  count     Number of messages summarized
+   *  @return void
+   */
+  static void emitSummary( const Site &summary, const Site *const about, const size_t count )
+  {
+    const auto line = static_cast<unsigned long>( about->line );
+    const auto num  = static_cast<unsigned long>( count );
+
+#if ULOG_BINARY_MODE
+    blog( summary, about->file, line, num );
+#else
+    flog( &summary, about->file, line, num );
+#endif
+  }
+
+
+  /**
+   *  Ends the current run of duplicates, handing back how many there were
+   *
+   *  @param[in]  state     State of the site the run belongs to
+   *  @param[in]  now       Current time
+   *  @return size_t        Number of duplicates to report
+   */
+  static size_t takeRepeats( SiteState &state, const size_t now )
+  {
+    const size_t count = state.repeats;
+
+    state.repeats     = 0;
+    state.repeatStart = now;
+    return count;
+  }
+
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  bool admit( const Site *const site, const uint32_t hash )
+  {
+    /*-------------------------------------------------------------------------
+    Fast exit for statements that aren't subject to any limiting
+    -------------------------------------------------------------------------*/
+    if ( !site || !site->state || ( !ULOG_COLLAPSE_DUPLICATES && !site->state->burst ) )
+    {
+      return true;
+    }
+
+    SiteState &state   = *site->state;
+    bool       accept  = true;
+    size_t     repeats = 0;
+    size_t     limited = 0;
+
+    s_limiter_lock.lock();
+    const size_t now = Chimera::millis();
+
+    /*-------------------------------------------------------------------------
+    Swallow exact repeats of the statement's last message, periodically
+    reporting on them so a never ending flood is still visible. Sites holding
+    back a count are remembered so flushSummaries() can report them later.
+    -------------------------------------------------------------------------*/
+    if constexpr ( ULOG_COLLAPSE_DUPLICATES != 0 )
+    {
+      if ( state.hashValid && ( hash == state.lastHash ) )
+      {
+        state.repeats++;
+        accept = false;
+
+        if ( ( now - state.repeatStart ) >= ULOG_DUPLICATE_REPORT_PERIOD )
+        {
+          repeats = takeRepeats( state, now );
+        }
+        else if ( !state.pending )
+        {
+          state.pending     = true;
+          state.nextPending = s_pending;
+          s_pending         = site;
+        }
+      }
+      else
+      {
+        repeats         = takeRepeats( state, now );
+        state.lastHash  = hash;
+        state.hashValid = true;
+      }
+    }
+
+    /*-------------------------------------------------------------------------
+    Token bucket
+    -------------------------------------------------------------------------*/
+    if ( accept && state.burst )
+    {
+      const size_t refill = state.period ? ( ( now - state.lastRefill ) / state.period ) : state.burst;
+      if ( refill )
+      {
+        state.tokens     = static_cast<uint32_t>( std::min<size_t>( state.tokens + refill, state.burst ) );
+        state.lastRefill += refill * state.period;
+      }
+
+      if ( !state.tokens )
+      {
+        state.suppressed++;
+        accept = false;
+      }
+      else
+      {
+        state.tokens--;
+        limited          = state.suppressed;
+        state.suppressed = 0;
+      }
+    }
+
+    s_limiter_lock.unlock();
+
+    /*-------------------------------------------------------------------------
+    Let the reader know what they missed before the message goes out. This
+    happens outside the lock so other statements aren't held up by the sinks.
+    -------------------------------------------------------------------------*/
+    if ( repeats )
+    {
+      emitSummary( s_repeat_site, site, repeats );
+    }
+
+    if ( limited )
+    {
+      emitSummary( s_suppress_site, site, limited );
+    }
+
+    return accept;
+  }
+
+
+  size_t flushSummaries()
+  {
+    size_t emitted = 0;
+
+    while ( true )
+    {
+      const Site *due     = nullptr;
+      size_t      repeats = 0;
+
+      /*-----------------------------------------------------------------------
+      Find one site whose summary is due, dropping any that no longer have
+      anything to report. Only one is taken per pass so the summary can be
+      emitted without holding the lock.
+      -----------------------------------------------------------------------*/
+      s_limiter_lock.lock();
+      const size_t now = Chimera::millis();
+
+      const Site **link = &s_pending;
+      while ( *link && !due )
+      {
+        SiteState &state = *( *link )->state;
+
+        if ( state.repeats && ( ( now - state.repeatStart ) < ULOG_DUPLICATE_REPORT_PERIOD ) )
+        {
+          link = &state.nextPending;
+          continue;
+        }
+
+        if ( state.repeats )
+        {
+          due     = *link;
+          repeats = takeRepeats( state, now );
+        }
+
+        *link             = state.nextPending;
+        state.nextPending = nullptr;
+        state.pending     = false;
+      }
+
+      s_limiter_lock.unlock();
+
+      if ( !due )
+      {
+        return emitted;
+      }
+
+      emitSummary( s_repeat_site, due, repeats );
+      emitted++;
+    }
+  }
+
+}  // namespace Aurora::Logging
@@ -0,0 +1,129 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_limiter.hpp
+ *
+ *  Description:
+ *    Per call site rate limiting and duplicate message suppression
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_LIMITER_HPP
+#define AURORA_LOGGING_LIMITER_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_driver.hpp>
+#include <Aurora/source/logging/logging_site.hpp>
+#include <Aurora/source/logging/logging_types.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Decides if a statement should be allowed through, based on its token
+   *  bucket and whether it exactly repeats the previous message. Summaries of
+   *  anything suppressed are emitted once the flood stops.
+   *
+   *  @param[in]  site      Call site attempting to log
+   *  @param[in]  hash      Hash of the argument values, from argHash()
+   *  @return bool          True if the statement should be logged
+   */
+  bool admit( const Site *const site, const uint32_t hash );
+
+  /**
+   *  Emits the "repeated N times" summary of any statement whose duplicates
+   *  have gone unreported for at least ULOG_DUPLICATE_REPORT_PERIOD. Without
+   *  this, a flood that simply stops is only reported once its statement logs
+   *  something different. asyncDrainThread() calls it on every pass. Call it
+   *  periodically from your own loop otherwise.
+   *
+   *  @return size_t        Number of summaries emitted
+   */
+  size_t flushSummaries();
+
+  /**
+   *  Hashes the value of a single argument into a running FNV-1a hash.
+   *  Strings are hashed by content, everything else by value.
+   *
+   *  @param[in]  hash      Running hash
+   *  @param[in]  arg       Argument to fold in
+   *  @return uint32_t      Updated hash
+   */
+  template<typename T>
+  uint32_t hashArg( uint32_t hash, const T arg )
+  {
+    if constexpr ( std::is_same_v<T, const char *> || std::is_same_v<T, char *> )
+    {
+      for ( const char *c = arg; c && ( *c != '\0' ); c++ )
+      {
+        hash = ( hash ^ static_cast<uint8_t>( *c ) ) * 16777619u;
+      }
+    }
+    else
+    {
+      const uint8_t *bytes = reinterpret_cast<const uint8_t *>( &arg );
+      for ( size_t i = 0; i < sizeof( T ); i++ )
+      {
+        hash = ( hash ^ bytes[ i ] ) * 16777619u;
+      }
+    }
+
+    return hash;
+  }
+
+  /**
+   *  Hashes a full argument list so repeated messages can be detected without
+   *  formatting them. Compiles to nothing when duplicate collapsing is off.
+   *
+   *  @param[in]  args      Arguments of the log statement
+   *  @return uint32_t
+   */
+  template<typename... Args>
+  uint32_t argHash( const Args... args )
+  {
+    uint32_t hash = 2166136261u;
+
+    if constexpr ( ULOG_COLLAPSE_DUPLICATES != 0 )
+    {
+      ( ( hash = hashArg( hash, args ) ), ... );
+    }
+
+    return hash;
+  }
+
+  /**
+   *  Text mode entry point for LOG_* statements. Runs the cheap level and
+   *  limiter checks before handing off to the formatter.
+   *
+   *  @param[in]  site      Call site that is logging
+   *  @param[in]  args      Arguments matching the site format string
+   *  @return Result
+   */
+  template<typename... Args>
+  Result logSite( const Site *const site, const Args... args )
+  {
+    if ( !isEnabled( site->level ) )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    if ( !admit( site, argHash( args... ) ) )
+    {
+      return Result::RESULT_IGNORE;
+    }
+
+    return flog( site, args... );
+  }
+
+}  // namespace Aurora::Logging
+
+#endif /* !AURORA_LOGGING_LIMITER_HPP */
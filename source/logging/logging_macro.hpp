@@ -13,7 +13,13 @@
 #define LOGGING_MACROS_HPP
 
 /* Aurora Includes */
+#include <Aurora/source/logging/logging_binary.hpp>
+#include <Aurora/source/logging/logging_config.hpp>
 #include <Aurora/source/logging/logging_driver.hpp>
+#include <Aurora/source/logging/logging_isr.hpp>
+#include <Aurora/source/logging/logging_kv.hpp>
+#include <Aurora/source/logging/logging_limiter.hpp>
+#include <Aurora/source/logging/logging_site.hpp>
 
 /*-------------------------------------------------------------------------------
 Create the __SHORT_FILE__ macro, which returns just the file name instead of the
@@ -35,60 +41,197 @@ static constexpr cstr past_last_slash( cstr str )
     sf__;                                               \
   } )
 
+/*-------------------------------------------------------------------------------
+Rate limit selection. Module values, if defined, take precedence over the
+project wide settings.
+-------------------------------------------------------------------------------*/
+#if defined( AURORA_LOG_MODULE_RATE_BURST )
+#define AURORA_LOG_RATE_BURST AURORA_LOG_MODULE_RATE_BURST
+#else
+#define AURORA_LOG_RATE_BURST ULOG_RATE_LIMIT_BURST
+#endif
+
+#if defined( AURORA_LOG_MODULE_RATE_PERIOD )
+#define AURORA_LOG_RATE_PERIOD AURORA_LOG_MODULE_RATE_PERIOD
+#else
+#define AURORA_LOG_RATE_PERIOD ULOG_RATE_LIMIT_PERIOD
+#endif
+
+/*-------------------------------------------------------------------------------
+Backend selection. Every statement gets a static call site descriptor. In text
+mode it carries a header prefix rendered at compile time. In binary mode it is
+placed into a dedicated linker section so the host can rebuild the text later.
+-------------------------------------------------------------------------------*/
+#if ULOG_BINARY_MODE
+#define AURORA_LOG_IMPL( lvl, str, ... )                                                                                     \
+  ( {                                                                                                                        \
+    static Aurora::Logging::SiteState state__{ AURORA_LOG_RATE_BURST, AURORA_LOG_RATE_PERIOD, AURORA_LOG_RATE_BURST, 0, 0 }; \
+    AURORA_LOG_SITE_ATTR static const Aurora::Logging::Site site__{                                                          \
+      Aurora::Logging::siteId( __FILE__, __LINE__, __COUNTER__ ), lvl, past_last_slash( __FILE__ ), __LINE__, str,           \
+      nullptr, &state__                                                                                                      \
+    };                                                                                                                       \
+    Aurora::Logging::blog( site__, ##__VA_ARGS__ );                                                                          \
+  } )
+#else
+#define AURORA_LOG_IMPL( lvl, str, ... )                                                                                     \
+  ( {                                                                                                                        \
+    AURORA_LOG_DEFINE_PREFIX( prefix__, past_last_slash( __FILE__ ), __LINE__, lvl );                                        \
+    static Aurora::Logging::SiteState state__{ AURORA_LOG_RATE_BURST, AURORA_LOG_RATE_PERIOD, AURORA_LOG_RATE_BURST, 0, 0 }; \
+    static const Aurora::Logging::Site site__{                                                                               \
+      Aurora::Logging::siteId( __FILE__, __LINE__, __COUNTER__ ), lvl, past_last_slash( __FILE__ ), __LINE__, str,           \
+      &prefix__, &state__                                                                                                    \
+    };                                                                                                                       \
+    Aurora::Logging::logSite( &site__, ##__VA_ARGS__ );                                                                      \
+  } )
+#endif
+
+/*-------------------------------------------------------------------------------
+Compile time level selection. A module level, if defined, takes precedence over
+the project wide setting.
+-------------------------------------------------------------------------------*/
+#if defined( AURORA_LOG_MODULE_LEVEL )
+#define AURORA_LOG_LEVEL AURORA_LOG_MODULE_LEVEL
+#else
+#define AURORA_LOG_LEVEL ULOG_COMPILE_LEVEL
+#endif
+
 /*-------------------------------------------------------------------------------
 Logging helper macros
 -------------------------------------------------------------------------------*/
-#define LOG_TRACE( str, ... ) \
-  Aurora::Logging::flog( Aurora::Logging::Level::LVL_TRACE, __SHORT_FILE__, __LINE__, str, ##__VA_ARGS__ )
+#if AURORA_LOG_LEVEL <= ULOG_LEVEL_TRACE
+#define LOG_TRACE( str, ... ) AURORA_LOG_IMPL( Aurora::Logging::Level::LVL_TRACE, str, ##__VA_ARGS__ )
 #define LOG_TRACE_IF( predicate, str, ... ) \
   if ( ( predicate ) )                      \
   {                                         \
     LOG_TRACE( ( str ), ##__VA_ARGS__ );    \
   }
-
-
-#define LOG_DEBUG( str, ... ) \
-  Aurora::Logging::flog( Aurora::Logging::Level::LVL_DEBUG, __SHORT_FILE__, __LINE__, str, ##__VA_ARGS__ )
+#define LOG_ISR_TRACE( str, ... ) AURORA_LOG_ISR_IMPL( Aurora::Logging::Level::LVL_TRACE, str, ##__VA_ARGS__ )
+#define LOG_KV_TRACE( event, ... ) Aurora::Logging::KV::log( Aurora::Logging::Level::LVL_TRACE, event, ##__VA_ARGS__ )
+#else
+#define LOG_TRACE( str, ... ) ( ( void )0 )
+#define LOG_TRACE_IF( predicate, str, ... ) ( ( void )0 )
+#define LOG_ISR_TRACE( str, ... ) ( ( void )0 )
+#define LOG_KV_TRACE( event, ... ) ( ( void )0 )
+#endif
+
+#if AURORA_LOG_LEVEL <= ULOG_LEVEL_DEBUG
+#define LOG_DEBUG( str, ... ) AURORA_LOG_IMPL( Aurora::Logging::Level::LVL_DEBUG, str, ##__VA_ARGS__ )
 #define LOG_DEBUG_IF( predicate, str, ... ) \
   if ( ( predicate ) )                      \
   {                                         \
     LOG_DEBUG( ( str ), ##__VA_ARGS__ );    \
   }
-
-
-#define LOG_INFO( str, ... ) \
-  Aurora::Logging::flog( Aurora::Logging::Level::LVL_INFO, __SHORT_FILE__, __LINE__, str, ##__VA_ARGS__ )
+#define LOG_ISR_DEBUG( str, ... ) AURORA_LOG_ISR_IMPL( Aurora::Logging::Level::LVL_DEBUG, str, ##__VA_ARGS__ )
+#define LOG_KV_DEBUG( event, ... ) Aurora::Logging::KV::log( Aurora::Logging::Level::LVL_DEBUG, event, ##__VA_ARGS__ )
+#else
+#define LOG_DEBUG( str, ... ) ( ( void )0 )
+#define LOG_DEBUG_IF( predicate, str, ... ) ( ( void )0 )
+#define LOG_ISR_DEBUG( str, ... ) ( ( void )0 )
+#define LOG_KV_DEBUG( event, ... ) ( ( void )0 )
+#endif
+
+#if AURORA_LOG_LEVEL <= ULOG_LEVEL_INFO
+#define LOG_INFO( str, ... ) AURORA_LOG_IMPL( Aurora::Logging::Level::LVL_INFO, str, ##__VA_ARGS__ )
 #define LOG_INFO_IF( predicate, str, ... ) \
   if ( ( predicate ) )                     \
   {                                        \
     LOG_INFO( ( str ), ##__VA_ARGS__ );    \
   }
-
-
-#define LOG_WARN( str, ... ) \
-  Aurora::Logging::flog( Aurora::Logging::Level::LVL_WARN, __SHORT_FILE__, __LINE__, str, ##__VA_ARGS__ )
+#define LOG_ISR_INFO( str, ... ) AURORA_LOG_ISR_IMPL( Aurora::Logging::Level::LVL_INFO, str, ##__VA_ARGS__ )
+#define LOG_KV_INFO( event, ... ) Aurora::Logging::KV::log( Aurora::Logging::Level::LVL_INFO, event, ##__VA_ARGS__ )
+#else
+#define LOG_INFO( str, ... ) ( ( void )0 )
+#define LOG_INFO_IF( predicate, str, ... ) ( ( void )0 )
+#define LOG_ISR_INFO( str, ... ) ( ( void )0 )
+#define LOG_KV_INFO( event, ... ) ( ( void )0 )
+#endif
+
+#if AURORA_LOG_LEVEL <= ULOG_LEVEL_WARN
+#define LOG_WARN( str, ... ) AURORA_LOG_IMPL( Aurora::Logging::Level::LVL_WARN, str, ##__VA_ARGS__ )
 #define LOG_WARN_IF( predicate, str, ... ) \
   if ( ( predicate ) )                     \
   {                                        \
     LOG_WARN( ( str ), ##__VA_ARGS__ );    \
   }
-
-
-#define LOG_ERROR( str, ... ) \
-  Aurora::Logging::flog( Aurora::Logging::Level::LVL_ERROR, __SHORT_FILE__, __LINE__, str, ##__VA_ARGS__ )
+#define LOG_ISR_WARN( str, ... ) AURORA_LOG_ISR_IMPL( Aurora::Logging::Level::LVL_WARN, str, ##__VA_ARGS__ )
+#define LOG_KV_WARN( event, ... ) Aurora::Logging::KV::log( Aurora::Logging::Level::LVL_WARN, event, ##__VA_ARGS__ )
+#else
+#define LOG_WARN( str, ... ) ( ( void )0 )
+#define LOG_WARN_IF( predicate, str, ... ) ( ( void )0 )
+#define LOG_ISR_WARN( str, ... ) ( ( void )0 )
+#define LOG_KV_WARN( event, ... ) ( ( void )0 )
+#endif
+
+#if AURORA_LOG_LEVEL <= ULOG_LEVEL_ERROR
+#define LOG_ERROR( str, ... ) AURORA_LOG_IMPL( Aurora::Logging::Level::LVL_ERROR, str, ##__VA_ARGS__ )
 #define LOG_ERROR_IF( predicate, str, ... ) \
   if ( ( predicate ) )                      \
   {                                         \
     LOG_ERROR( ( str ), ##__VA_ARGS__ );    \
   }
-
-
-#define LOG_FATAL( str, ... ) \
-  Aurora::Logging::flog( Aurora::Logging::Level::LVL_FATAL, __SHORT_FILE__, __LINE__, str, ##__VA_ARGS__ )
+#define LOG_ISR_ERROR( str, ... ) AURORA_LOG_ISR_IMPL( Aurora::Logging::Level::LVL_ERROR, str, ##__VA_ARGS__ )
+#define LOG_KV_ERROR( event, ... ) Aurora::Logging::KV::log( Aurora::Logging::Level::LVL_ERROR, event, ##__VA_ARGS__ )
+#else
+#define LOG_ERROR( str, ... ) ( ( void )0 )
+#define LOG_ERROR_IF( predicate, str, ... ) ( ( void )0 )
+#define LOG_ISR_ERROR( str, ... ) ( ( void )0 )
+#define LOG_KV_ERROR( event, ... ) ( ( void )0 )
+#endif
+
+#if AURORA_LOG_LEVEL <= ULOG_LEVEL_FATAL
+#define LOG_FATAL( str, ... ) AURORA_LOG_IMPL( Aurora::Logging::Level::LVL_FATAL, str, ##__VA_ARGS__ )
 #define LOG_FATAL_IF( predicate, str, ... ) \
   if ( ( predicate ) )                      \
   {                                         \
     LOG_FATAL( ( str ), ##__VA_ARGS__ );    \
   }
+#define LOG_ISR_FATAL( str, ... ) AURORA_LOG_ISR_IMPL( Aurora::Logging::Level::LVL_FATAL, str, ##__VA_ARGS__ )
+#define LOG_KV_FATAL( event, ... ) Aurora::Logging::KV::log( Aurora::Logging::Level::LVL_FATAL, event, ##__VA_ARGS__ )
+#else
+#define LOG_FATAL( str, ... ) ( ( void )0 )
+#define LOG_FATAL_IF( predicate, str, ... ) ( ( void )0 )
+#define LOG_ISR_FATAL( str, ... ) ( ( void )0 )
+#define LOG_KV_FATAL( event, ... ) ( ( void )0 )
+#endif
+
+/*-------------------------------------------------------------------------------
+Interrupt safe logging. Accepts up to four integer arguments, which must match
+32-bit format specifiers (%d, %u, %x, ...). The statement is only queued here
+and gets rendered later by processISRLogs(). Rate limiting doesn't apply. The
+level is given by name so statements below the compile level drop out:
+
+  LOG_ISR( WARN, "overrun on channel %u", channel );
+-------------------------------------------------------------------------------*/
+#if ULOG_BINARY_MODE
+#define AURORA_LOG_ISR_IMPL( lvl, str, ... )                                                                       \
+  ( {                                                                                                              \
+    AURORA_LOG_SITE_ATTR static const Aurora::Logging::Site site__{                                                \
+      Aurora::Logging::siteId( __FILE__, __LINE__, __COUNTER__ ), lvl, past_last_slash( __FILE__ ), __LINE__, str, \
+      nullptr, nullptr                                                                                             \
+    };                                                                                                             \
+    Aurora::Logging::isrLog( site__, ##__VA_ARGS__ );                                                              \
+  } )
+#else
+#define AURORA_LOG_ISR_IMPL( lvl, str, ... )                                                                       \
+  ( {                                                                                                              \
+    AURORA_LOG_DEFINE_PREFIX( prefix__, past_last_slash( __FILE__ ), __LINE__, lvl );                              \
+    static const Aurora::Logging::Site site__{                                                                     \
+      Aurora::Logging::siteId( __FILE__, __LINE__, __COUNTER__ ), lvl, past_last_slash( __FILE__ ), __LINE__, str, \
+      &prefix__, nullptr                                                                                           \
+    };                                                                                                             \
+    Aurora::Logging::isrLog( site__, ##__VA_ARGS__ );                                                              \
+  } )
+#endif
+
+#define LOG_ISR( lvl, str, ... ) LOG_ISR_##lvl( str, ##__VA_ARGS__ )
+
+/*-------------------------------------------------------------------------------
+Structured logging. Each field is built with AURORA_KV( "key", value ):
+
+  LOG_KV( INFO, "boot", AURORA_KV( "reason", 3 ), AURORA_KV( "fw", "1.2.0" ) );
+-------------------------------------------------------------------------------*/
+#define AURORA_KV( key, value ) Aurora::Logging::KV::makeField( key, value )
+
+#define LOG_KV( lvl, event, ... ) LOG_KV_##lvl( event, ##__VA_ARGS__ )
 
 #endif /* !LOGGING_MACROS_HPP */
@@ -0,0 +1,282 @@
+/******************************************************************************
+ *  File Name:
+ *    logging_site.hpp
+ *
+ *  Description:
+ *    Compile time description of a single logging call site
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_SITE_HPP
+#define AURORA_LOGGING_SITE_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_types.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*-----------------------------------------------------------------------------
+Macros
+-----------------------------------------------------------------------------*/
+/**
+ *  Linker section that collects every call site descriptor. GNU linkers will
+ *  automatically provide __start_ and __stop_ symbols for this section, which
+ *  is how the site table is found at runtime.
+ *
+ *  The explicit alignment stops the compiler from padding large objects out to
+ *  a cache line, which would leave gaps between the entries of the table.
+ */
+#define AURORA_LOG_SITE_ATTR __attribute__( ( section( "aurora_log_sites" ), used, aligned( alignof( void * ) ) ) )
+
+/**
+ *  Declares a static Prefix named `name` along with the storage behind it
+ */
+#define AURORA_LOG_DEFINE_PREFIX( name, file, line, lvl )                                                             \
+  static constexpr auto name##Text__ =                                                                                \
+    Aurora::Logging::makePrefix<Aurora::Logging::prefixLength( file, line, lvl )>( file, line, lvl );                 \
+  static constexpr Aurora::Logging::Prefix name                                                                       \
+  {                                                                                                                   \
+    name##Text__.data(), name##Text__.size() - 1u                                                                     \
+  }
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  /**
+   *  ID that siteId() never produces, so records that aren't tied to a call
+   *  site (see KV::RECORD_ID) can't be mistaken for one
+   */
+  static constexpr uint32_t RESERVED_SITE_ID = 0xFFFFFFFFu;
+
+  /*---------------------------------------------------------------------------
+  Forward Declarations
+  ---------------------------------------------------------------------------*/
+  struct Site;
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  The "[file:line][LEVEL] -- " portion of a log message header, rendered at
+   *  compile time so only the timestamp needs formatting at runtime. Declare
+   *  one with AURORA_LOG_DEFINE_PREFIX.
+   */
+  struct Prefix
+  {
+    const char *text;   /**< Rendered prefix, null terminated */
+    size_t      length; /**< Number of characters, excluding the terminator */
+  };
+
+  /**
+   *  Mutable per call site state used by the rate limiter and duplicate
+   *  collapsing. Only the limiter touches it, and only under its lock.
+   */
+  struct SiteState
+  {
+    const uint32_t burst;      /**< Bucket capacity. Zero disables rate limiting. */
+    const uint32_t period;     /**< Time to refill a single token, in milliseconds */
+    uint32_t       tokens;     /**< Tokens currently available */
+    size_t         lastRefill; /**< Time the bucket was last refilled */
+    uint32_t       suppressed; /**< Statements dropped since the last one that got through */
+
+    uint32_t    lastHash    = 0;       /**< Argument hash of the last message that got through */
+    bool        hashValid   = false;   /**< Whether lastHash has been set yet */
+    uint32_t    repeats     = 0;       /**< Duplicates of that message swallowed since the last summary */
+    size_t      repeatStart = 0;       /**< Time the current run of duplicates started or was last reported */
+    bool        pending     = false;   /**< Linked into the limiter's list of sites to check on flush */
+    const Site *nextPending = nullptr; /**< Pending list link, owned by the limiter */
+  };
+
+  /**
+   *  Everything about a log statement that is known at compile time. In binary
+   *  logging mode, only the ID of this structure is sent over the wire and the
+   *  host uses it to look up the format string.
+   */
+  struct Site
+  {
+    uint32_t      id;     /**< Unique identifier of the call site */
+    Level         level;  /**< Severity level of the statement */
+    const char   *file;   /**< File the statement lives in */
+    uint32_t      line;   /**< Line the statement lives on */
+    const char   *fmt;    /**< Format string */
+    const Prefix *prefix; /**< Prebuilt message prefix. Unused in binary mode. */
+    SiteState    *state;  /**< Rate limiter state, if any */
+  };
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Computes an ID for a call site using FNV-1a over the file path, line
+   *  number, and a per translation unit counter. The counter keeps several
+   *  statements on one line apart. Evaluated at compile time for every log
+   *  statement, so IDs are only meaningful against the site table of the same
+   *  build. RESERVED_SITE_ID is never returned.
+   *
+   *  @param[in]  file      Full path of the file
+   *  @param[in]  line      Line number of the statement
+   *  @param[in]  counter   Value of __COUNTER__ at the statement
+   *  @return uint32_t
+   */
+  static constexpr uint32_t siteId( const char *const file, const uint32_t line, const uint32_t counter )
+  {
+    uint32_t hash = 2166136261u;
+
+    for ( const char *c = file; *c != '\0'; c++ )
+    {
+      hash = ( hash ^ static_cast<uint8_t>( *c ) ) * 16777619u;
+    }
+
+    for ( size_t i = 0; i < sizeof( line ); i++ )
+    {
+      hash = ( hash ^ static_cast<uint8_t>( line >> ( i * 8u ) ) ) * 16777619u;
+    }
+
+    for ( size_t i = 0; i < sizeof( counter ); i++ )
+    {
+      hash = ( hash ^ static_cast<uint8_t>( counter >> ( i * 8u ) ) ) * 16777619u;
+    }
+
+    return ( hash != RESERVED_SITE_ID ) ? hash : ( hash - 1u );
+  }
+
+  /**
+   *  Gets the printable name of a level at compile time
+   *
+   *  @param[in]  lvl       The level to convert
+   *  @return const char*   Empty string if the level is invalid
+   */
+  static constexpr const char *levelName( const Level lvl )
+  {
+    switch ( lvl )
+    {
+      case Level::LVL_TRACE:
+        return "TRACE";
+
+      case Level::LVL_DEBUG:
+        return "DEBUG";
+
+      case Level::LVL_INFO:
+        return "INFO";
+
+      case Level::LVL_WARN:
+        return "WARN";
+
+      case Level::LVL_ERROR:
+        return "ERROR";
+
+      case Level::LVL_FATAL:
+        return "FATAL";
+
+      default:
+        return "";
+    }
+  }
+
+  /**
+   *  Feeds the static part of a message header to an output, one character at
+   *  a time. Shared by prefixLength() and makePrefix() so they can't disagree.
+   *
+   *  @param[in]  file      Short name of the file
+   *  @param[in]  line      Line number of the statement
+   *  @param[in]  lvl       Severity level of the statement
+   *  @param[in]  put       Called with each character in order
+   *  @return void
+   */
+  template<typename Output>
+  static constexpr void renderPrefix( const char *const file, const uint32_t line, const Level lvl, Output &&put )
+  {
+    auto puts = [ &put ]( const char *str ) {
+      while ( *str != '\0' )
+      {
+        put( *str++ );
+      }
+    };
+
+    /*-------------------------------------------------------------------------
+    Line numbers come out of the division backwards, so stage them first
+    -------------------------------------------------------------------------*/
+    char     digits[ 10 ] = {};
+    size_t   count        = 0;
+    uint32_t value        = line;
+
+    do
+    {
+      digits[ count++ ] = static_cast<char>( '0' + ( value % 10u ) );
+      value /= 10u;
+    } while ( value && ( count < sizeof( digits ) ) );
+
+    /*-------------------------------------------------------------------------
+    Assemble "[file:line][LEVEL] -- "
+    -------------------------------------------------------------------------*/
+    put( '[' );
+    puts( file );
+    put( ':' );
+    while ( count )
+    {
+      put( digits[ --count ] );
+    }
+    puts( "][" );
+    puts( levelName( lvl ) );
+    puts( "] -- " );
+  }
+
+  /**
+   *  Number of characters in the static part of a message header
+   *
+   *  @param[in]  file      Short name of the file
+   *  @param[in]  line      Line number of the statement
+   *  @param[in]  lvl       Severity level of the statement
+   *  @return size_t        Length, excluding the terminator
+   */
+  static constexpr size_t prefixLength( const char *const file, const uint32_t line, const Level lvl )
+  {
+    size_t length = 0;
+    renderPrefix( file, line, lvl, [ &length ]( const char ) { length++; } );
+    return length;
+  }
+
+  /**
+   *  Renders the static part of a message header at compile time into storage
+   *  sized to fit it exactly, so the file name and level are never cut short.
+   *
+   *  @param[in]  file      Short name of the file
+   *  @param[in]  line      Line number of the statement
+   *  @param[in]  lvl       Severity level of the statement
+   *  @return std::array    Rendered prefix, null terminated
+   */
+  template<size_t Length>
+  static constexpr std::array<char, Length + 1u> makePrefix( const char *const file, const uint32_t line, const Level lvl )
+  {
+    std::array<char, Length + 1u> text{};
+    size_t                        pos = 0;
+
+    renderPrefix( file, line, lvl, [ &text, &pos ]( const char c ) {
+      if ( pos < Length )
+      {
+        text[ pos++ ] = c;
+      }
+    } );
+
+    return text;
+  }
+
+  /**
+   *  Gets the table of all call sites registered in the image
+   *
+   *  @param[out] count     Number of entries in the table
+   *  @return const Site*   Start of the table, or nullptr if empty
+   */
+  const Site *getSiteTable( size_t &count );
+
+}  // namespace Aurora::Logging
+
+#endif /* !AURORA_LOGGING_SITE_HPP */
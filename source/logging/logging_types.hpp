@@ -87,7 +87,10 @@ namespace Aurora::Logging
     FILE_SINK,
     JLINK_SINK,
     SERIAL_SINK,
-    VGDB_SINK
+    VGDB_SINK,
+    SERIAL_COBS_SINK,
+    MEMORY_SINK,
+    PERSISTENT_SINK
   };
 
 }  // namespace Aurora::Logging
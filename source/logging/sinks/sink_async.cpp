@@ -0,0 +1,205 @@
+/******************************************************************************
+ *  File Name:
+ *    sink_async.cpp
+ *
+ *  Description:
+ *    Implements the per-sink asynchronous queue decorator
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/logging>
+#include <Chimera/common>
+#include <Chimera/thread>
+#include <limits>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Class Implementation
+  ---------------------------------------------------------------------------*/
+  AsyncSink::AsyncSink() :
+      mSink( nullptr ), mPolicy( OverflowPolicy::DROP_NEWEST ), mTimeout( 0 ), mDropped( 0 ), mTruncated( 0 )
+  {
+  }
+
+
+  AsyncSink::AsyncSink( SinkHandle_rPtr sink ) : AsyncSink()
+  {
+    assignSink( sink );
+  }
+
+
+  AsyncSink::~AsyncSink()
+  {
+  }
+
+
+  void AsyncSink::assignSink( SinkHandle_rPtr sink )
+  {
+    mSink = sink;
+
+    if ( mSink )
+    {
+      name = mSink->name;
+    }
+  }
+
+
+  void AsyncSink::setOverflowPolicy( const OverflowPolicy policy, const size_t timeout )
+  {
+    mPolicy  = policy;
+    mTimeout = timeout;
+  }
+
+
+  size_t AsyncSink::process( const size_t limit )
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+    return drain( limit );
+  }
+
+
+  size_t AsyncSink::drain( const size_t limit )
+  {
+    AsyncRecord record;
+    size_t      count = 0;
+
+    if ( !mSink )
+    {
+      return 0;
+    }
+
+    while ( ( count < limit ) && mQueue.pop( record ) )
+    {
+      mSink->log( record.level, record.data, record.length );
+      count++;
+    }
+
+    return count;
+  }
+
+
+  size_t AsyncSink::dropped() const
+  {
+    return mDropped.load();
+  }
+
+
+  size_t AsyncSink::truncated() const
+  {
+    return mTruncated.load();
+  }
+
+
+  void AsyncSink::drainThread( void *arg )
+  {
+    AsyncSink *const sink = reinterpret_cast<AsyncSink *>( arg );
+    RT_HARD_ASSERT( sink );
+
+    while ( true )
+    {
+      if ( !sink->process( ULOG_ASYNC_SINK_QUEUE_DEPTH ) )
+      {
+        Chimera::delayMilliseconds( ULOG_ASYNC_SINK_POLL_PERIOD_MS );
+      }
+    }
+  }
+
+
+  Result AsyncSink::open()
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+
+    if ( !mSink )
+    {
+      return Result::RESULT_FAIL_BAD_SINK;
+    }
+
+    const Result result = mSink->open();
+    enabled             = ( result == Result::RESULT_SUCCESS );
+    return result;
+  }
+
+
+  Result AsyncSink::close()
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+
+    if ( !mSink )
+    {
+      return Result::RESULT_FAIL_BAD_SINK;
+    }
+
+    enabled = false;
+    drain( std::numeric_limits<size_t>::max() );
+    return mSink->close();
+  }
+
+
+  Result AsyncSink::flush()
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+
+    if ( !mSink )
+    {
+      return Result::RESULT_FAIL_BAD_SINK;
+    }
+
+    drain( std::numeric_limits<size_t>::max() );
+    return mSink->flush();
+  }
+
+
+  IOType AsyncSink::getIOType()
+  {
+    return mSink ? mSink->getIOType() : IOType::CONSOLE_SINK;
+  }
+
+
+  bool AsyncSink::acceptsBinary()
+  {
+    return mSink && mSink->acceptsBinary();
+  }
+
+
+  Result AsyncSink::log( const Level level, const void *const message, const size_t length )
+  {
+    /*-------------------------------------------------------------------------
+    Make sure we can actually log the data
+    -------------------------------------------------------------------------*/
+    if ( !mSink )
+    {
+      return Result::RESULT_FAIL_BAD_SINK;
+    }
+
+    if ( !enabled )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    if ( ( level < mSink->logLevel ) || !message || !length )
+    {
+      return Result::RESULT_INVALID_LEVEL;
+    }
+
+    /*-------------------------------------------------------------------------
+    Hand the message off to the drain context
+    -------------------------------------------------------------------------*/
+    AsyncRecord record;
+    if ( packRecord( level, message, length, record ) )
+    {
+      mTruncated++;
+    }
+
+    if ( !pushRecord( mQueue, record, mPolicy, mTimeout, mDropped ) )
+    {
+      return Result::RESULT_FULL;
+    }
+
+    return Result::RESULT_SUCCESS;
+  }
+}  // namespace Aurora::Logging
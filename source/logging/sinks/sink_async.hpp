@@ -0,0 +1,116 @@
+/******************************************************************************
+ *  File Name:
+ *    sink_async.hpp
+ *
+ *  Description:
+ *    Decorator that gives any sink its own queue and drain context
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_ASYNC_SINK_HPP
+#define AURORA_LOGGING_ASYNC_SINK_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/container/lockfree_queue.hpp>
+#include <Aurora/source/logging/logging_async.hpp>
+#include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_types.hpp>
+#include <Aurora/source/logging/sinks/sink_intf.hpp>
+#include <atomic>
+#include <cstddef>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Wraps a slow sink so that logging to it only costs a queue push. The
+   *  wrapped sink is serviced from its own thread, so if it stalls, only its
+   *  own queue fills up and drops messages. Other sinks and the logging caller
+   *  are unaffected.
+   *
+   *  Register the AsyncSink with the logger instead of the wrapped sink. All
+   *  calls into the wrapped sink are serialized by the AsyncSink's lock, so it
+   *  must not be used directly while wrapped. Messages are filtered against
+   *  the wrapped sink's logLevel at the time they're logged, so changing it
+   *  takes effect right away.
+   */
+  class AsyncSink : public SinkInterface
+  {
+  public:
+    AsyncSink();
+    explicit AsyncSink( SinkHandle_rPtr sink );
+    ~AsyncSink();
+
+    /**
+     *  Assigns the sink that messages will be forwarded to
+     *
+     *  @param[in]  sink      The sink to wrap
+     *  @return void
+     */
+    void assignSink( SinkHandle_rPtr sink );
+
+    /**
+     *  Sets what happens when the queue is full
+     *
+     *  @param[in]  policy    Overflow behavior
+     *  @param[in]  timeout   Max time to wait with the BLOCK policy, in ms
+     *  @return void
+     */
+    void setOverflowPolicy( const OverflowPolicy policy, const size_t timeout );
+
+    /**
+     *  Forwards queued messages to the wrapped sink from the calling context
+     *
+     *  @param[in]  limit     Max number of messages to forward
+     *  @return size_t        Number of messages forwarded
+     */
+    size_t process( const size_t limit );
+
+    /**
+     *  Number of messages dropped due to a full queue
+     *
+     *  @return size_t
+     */
+    size_t dropped() const;
+
+    /**
+     *  Number of messages cut short to fit in a queue record
+     *
+     *  @return size_t
+     */
+    size_t truncated() const;
+
+    /**
+     *  Thread entry point that services a single AsyncSink forever
+     *
+     *  @param[in]  arg       Pointer to the AsyncSink to service
+     *  @return void
+     */
+    static void drainThread( void *arg );
+
+    Result open() final override;
+    Result close() final override;
+    Result flush() final override;
+    IOType getIOType() final override;
+    bool   acceptsBinary() final override;
+    Result log( const Level level, const void *const message, const size_t length ) final override;
+
+  private:
+    SinkHandle_rPtr                                                            mSink;
+    OverflowPolicy                                                             mPolicy;
+    size_t                                                                     mTimeout;
+    std::atomic<size_t>                                                        mDropped;
+    std::atomic<size_t>                                                        mTruncated;
+    Aurora::Container::LockFreeQueue<AsyncRecord, ULOG_ASYNC_SINK_QUEUE_DEPTH> mQueue;
+
+    size_t drain( const size_t limit );
+  };
+}  // namespace Aurora::Logging
+
+#endif /* !AURORA_LOGGING_ASYNC_SINK_HPP */
@@ -8,51 +8,145 @@
  *  2021 | Brandon Braun | brandonbraun653@gmail.com
  *****************************************************************************/
 
-#if !defined( EMBEDDED )
-
 /* C++ Includes */
-#include <iostream>
+#include <algorithm>
+#include <limits>
 #include <string>
 
 /* Aurora Includes */
+#include <Aurora/filesystem>
 #include <Aurora/logging>
 
+/* Chimera Includes */
+#include <Chimera/common>
+#include <Chimera/thread>
+
 namespace Aurora::Logging
 {
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr size_t MAX_SUFFIX_LEN = sizeof( "_4294967295" ) - 1u;       /**< Longest suffix added to the base path */
+  static constexpr size_t INDEX_FILE     = std::numeric_limits<size_t>::max(); /**< makePath() selector for the index file */
+
   /*---------------------------------------------------------------------------
   Class Implementation
   ---------------------------------------------------------------------------*/
-  FileSink::FileSink()
+  FileSink::FileSink() :
+      mFile( "" ), mFd( -1 ), mIsOpen( false ), mBuffer( nullptr ), mBufferSize( 0 ), mPageSize( 0 ), mUsed( 0 ),
+      mFileIndex( 0 ), mFileSize( 0 ), mMaxFileSize( 0 ), mMaxFiles( 1 ), mSyncPeriod( 0 ), mSyncBytes( 0 ), mLastSync( 0 ),
+      mUnsynced( 0 )
   {
+    mPath.fill( 0 );
   }
 
 
   FileSink::~FileSink()
   {
+    this->close();
   }
 
 
-  void FileSink::setFile( const std::string_view &file )
+  bool FileSink::setFile( const std::string_view &file )
   {
+    if ( file.empty() || ( ( file.size() + MAX_SUFFIX_LEN ) >= mPath.size() ) )
+    {
+      return false;
+    }
 
+    Chimera::Thread::LockGuard _lck( *this );
+    mFile = file;
+    return true;
+  }
+
+
+  bool FileSink::assignCoreMemory( uint8_t *const buffer, const size_t size, const size_t pageSize )
+  {
+    if ( !buffer || !pageSize || ( size < pageSize ) )
+    {
+      return false;
+    }
+
+    Chimera::Thread::LockGuard _lck( *this );
+    mBuffer     = buffer;
+    mBufferSize = size;
+    mPageSize   = pageSize;
+    mUsed       = 0;
+    return true;
+  }
+
+
+  void FileSink::setRotation( const size_t maxFileSize, const size_t maxFiles )
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+    mMaxFileSize = maxFileSize;
+    mMaxFiles    = std::max<size_t>( maxFiles, 1 );
+  }
+
+
+  void FileSink::setSyncPolicy( const size_t period, const size_t threshold )
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+    mSyncPeriod = period;
+    mSyncBytes  = threshold;
   }
 
 
   Result FileSink::open()
   {
+    Chimera::Thread::LockGuard _lck( *this );
+
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( mIsOpen )
+    {
+      return Result::RESULT_SUCCESS;
+    }
+    else if ( mFile.empty() || !mBuffer )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    /*-------------------------------------------------------------------------
+    Pick up where the previous run left off, appending to its active file
+    -------------------------------------------------------------------------*/
+    if ( !openFile( resumeIndex(), true ) )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    mUsed     = 0;
+    mUnsynced = 0;
+    mLastSync = Chimera::millis();
+    enabled   = true;
     return Result::RESULT_SUCCESS;
   }
 
 
   Result FileSink::close()
   {
-    return Result::RESULT_SUCCESS;
+    Chimera::Thread::LockGuard _lck( *this );
+
+    if ( !mIsOpen )
+    {
+      return Result::RESULT_SUCCESS;
+    }
+
+    const Result result = sync();
+    FileSystem::fclose( mFd );
+
+    mFd     = -1;
+    mIsOpen = false;
+    enabled = false;
+    return result;
   }
 
 
   Result FileSink::flush()
   {
-    return Result::RESULT_SUCCESS;
+    Chimera::Thread::LockGuard _lck( *this );
+    return sync();
   }
 
 
@@ -72,8 +166,246 @@ namespace Aurora::Logging
       return Result::RESULT_FAIL;
     }
 
+    Chimera::Thread::LockGuard _lck( *this );
+    if ( !mIsOpen )
+    {
+      return Result::RESULT_FAIL_BAD_SINK;
+    }
+
+    /*-------------------------------------------------------------------------
+    Stage the message, draining whole pages whenever the buffer fills up
+    -------------------------------------------------------------------------*/
+    const uint8_t *src       = reinterpret_cast<const uint8_t *>( message );
+    size_t         remaining = length;
+
+    while ( remaining )
+    {
+      const size_t chunk = std::min( remaining, mBufferSize - mUsed );
+      memcpy( mBuffer + mUsed, src, chunk );
+
+      mUsed += chunk;
+      src += chunk;
+      remaining -= chunk;
+
+      if ( ( mUsed == mBufferSize ) && !writePending( false ) )
+      {
+        return Result::RESULT_FAIL;
+      }
+    }
+
+    if ( !writePending( false ) )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    /*-------------------------------------------------------------------------
+    Force everything out if a sync threshold was crossed
+    -------------------------------------------------------------------------*/
+    const bool timeout   = mSyncPeriod && ( ( Chimera::millis() - mLastSync ) >= mSyncPeriod );
+    const bool threshold = mSyncBytes && ( mUnsynced >= mSyncBytes );
+
+    if ( timeout || threshold )
+    {
+      return sync();
+    }
+
     return Result::RESULT_SUCCESS;
   }
-}  // namespace Aurora::Logging
 
-#endif  /* !EMBEDDED */
+
+  /**
+   *  Builds the path of a log file, or of the file tracking the active index
+   *
+   *  @param[in]  index     Rotation index, or INDEX_FILE
+   *  @return bool          False if the path doesn't fit
+   */
+  bool FileSink::makePath( const size_t index )
+  {
+    const int   nameLen = static_cast<int>( mFile.size() );
+    const char *name    = mFile.data();
+    int         len     = 0;
+
+    if ( index == INDEX_FILE )
+    {
+      len = npf_snprintf( mPath.data(), mPath.size(), "%.*s_idx", nameLen, name );
+    }
+    else
+    {
+      len = npf_snprintf( mPath.data(), mPath.size(), "%.*s_%u", nameLen, name, static_cast<unsigned>( index ) );
+    }
+
+    return ( len > 0 ) && ( static_cast<size_t>( len ) < mPath.size() );
+  }
+
+
+  /**
+   *  Figures out which file the previous run was writing to. The index file
+   *  says so directly. Without one, files are filled in order, so the first
+   *  missing file is next in line. If they all exist, the set has wrapped and
+   *  the smallest file is the one that was still being filled.
+   *
+   *  @return size_t        Index of the file to resume
+   */
+  size_t FileSink::resumeIndex()
+  {
+    FileSystem::FileId fd    = -1;
+    uint32_t           saved = 0;
+
+    if ( makePath( INDEX_FILE ) && ( FileSystem::fopen( mPath.data(), FileSystem::O_RDONLY, fd ) == 0 ) )
+    {
+      const size_t read = FileSystem::fread( &saved, 1, sizeof( saved ), fd );
+      FileSystem::fclose( fd );
+
+      if ( ( read == sizeof( saved ) ) && ( saved < mMaxFiles ) )
+      {
+        return saved;
+      }
+    }
+
+    size_t best     = 0;
+    size_t bestSize = std::numeric_limits<size_t>::max();
+
+    for ( size_t idx = 0; idx < mMaxFiles; idx++ )
+    {
+      if ( !makePath( idx ) || ( FileSystem::fopen( mPath.data(), FileSystem::O_RDONLY, fd ) != 0 ) )
+      {
+        return idx;
+      }
+
+      const size_t size = FileSystem::fsize( fd );
+      FileSystem::fclose( fd );
+
+      if ( size < bestSize )
+      {
+        best     = idx;
+        bestSize = size;
+      }
+    }
+
+    return best;
+  }
+
+
+  /**
+   *  Opens a log file and records it as the active one
+   *
+   *  @param[in]  index     Rotation index of the file
+   *  @param[in]  resume    Append to the file instead of starting it over
+   *  @return bool
+   */
+  bool FileSink::openFile( const size_t index, const bool resume )
+  {
+    mIsOpen = false;
+
+    /*-------------------------------------------------------------------------
+    Save the active index first. If power is lost before the file is opened,
+    the next run resumes the (still intact) file instead of skipping past it.
+    -------------------------------------------------------------------------*/
+    FileSystem::FileId fd    = -1;
+    const uint32_t     saved = static_cast<uint32_t>( index );
+    const auto         wr    = FileSystem::O_WRONLY | FileSystem::O_CREAT | FileSystem::O_TRUNC;
+
+    if ( makePath( INDEX_FILE ) && ( FileSystem::fopen( mPath.data(), wr, fd ) == 0 ) )
+    {
+      FileSystem::fwrite( &saved, 1, sizeof( saved ), fd );
+      FileSystem::fclose( fd );
+    }
+
+    /*-------------------------------------------------------------------------
+    Open the log itself
+    -------------------------------------------------------------------------*/
+    const auto mode = resume ? ( FileSystem::O_WRONLY | FileSystem::O_CREAT | FileSystem::O_APPEND ) : wr;
+    if ( !makePath( index ) || ( FileSystem::fopen( mPath.data(), mode, mFd ) != 0 ) )
+    {
+      return false;
+    }
+
+    mFileIndex = index;
+    mFileSize  = resume ? FileSystem::fsize( mFd ) : 0;
+    mIsOpen    = true;
+    return true;
+  }
+
+
+  bool FileSink::rotate()
+  {
+    FileSystem::fflush( mFd );
+    FileSystem::fclose( mFd );
+    mFd = -1;
+
+    return openFile( ( mFileIndex + 1 ) % mMaxFiles, false );
+  }
+
+
+  bool FileSink::writePending( const bool force )
+  {
+    while ( mUsed )
+    {
+      /*-----------------------------------------------------------------------
+      Figure out how much can go out while keeping the file offset aligned to
+      page boundaries. A forced write may leave the offset unaligned, so the
+      next write only tops up the partial page before resuming whole pages.
+      -----------------------------------------------------------------------*/
+      const size_t partial = mPageSize - ( mFileSize % mPageSize );
+      size_t       size    = 0;
+
+      if ( mUsed >= partial )
+      {
+        size = partial + ( ( ( mUsed - partial ) / mPageSize ) * mPageSize );
+      }
+      else if ( force )
+      {
+        size = mUsed;
+      }
+      else
+      {
+        break;
+      }
+
+      /*-----------------------------------------------------------------------
+      Move on to the next file rather than exceed the size limit
+      -----------------------------------------------------------------------*/
+      if ( mMaxFileSize && mFileSize && ( ( mFileSize + size ) > mMaxFileSize ) )
+      {
+        if ( !rotate() )
+        {
+          return false;
+        }
+
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      Write and shift whatever is left down to the front of the buffer
+      -----------------------------------------------------------------------*/
+      const size_t written = FileSystem::fwrite( mBuffer, 1, size, mFd );
+      if ( written != size )
+      {
+        return false;
+      }
+
+      mUsed -= written;
+      mFileSize += written;
+      mUnsynced += written;
+      memmove( mBuffer, mBuffer + written, mUsed );
+    }
+
+    return true;
+  }
+
+
+  Result FileSink::sync()
+  {
+    if ( !mIsOpen )
+    {
+      return Result::RESULT_FAIL_BAD_SINK;
+    }
+
+    const bool written = writePending( true );
+    const bool flushed = ( FileSystem::fflush( mFd ) == 0 );
+
+    mUnsynced = 0;
+    mLastSync = Chimera::millis();
+    return ( written && flushed ) ? Result::RESULT_SUCCESS : Result::RESULT_FAIL;
+  }
+}  // namespace Aurora::Logging
@@ -13,16 +13,28 @@
 #define AURORA_LOGGING_FILE_SINK_HPP
 
 /* C++ Includes */
+#include <array>
 #include <cstdlib>
 #include <cstring>
 
 /* Aurora Includes */
+#include <Aurora/source/filesystem/file_types.hpp>
 #include <Aurora/source/logging/logging_types.hpp>
 #include <Aurora/source/logging/sinks/sink_intf.hpp>
 
 
 namespace Aurora::Logging
 {
+  /**
+   *  Logs to a set of files on the Aurora filesystem. Messages are accumulated
+   *  in RAM and only written out in page sized, page aligned chunks, which keeps
+   *  the number of program operations on flash backed filesystems to a minimum.
+   *
+   *  Output rotates across files named "<file>_<n>" once each reaches its size
+   *  limit, wrapping around and truncating the oldest once all are used. The
+   *  active index is kept in "<file>_idx" so a restart appends to the file it
+   *  left off in, rather than overwriting data from the previous run.
+   */
   class FileSink : public SinkInterface
   {
   public:
@@ -30,13 +42,42 @@ namespace Aurora::Logging
     ~FileSink();
 
     /**
-     *  Assigns the serial channel to use when the default
-     *  constructor was used.
+     *  Assigns the base path of the log files. The memory backing the
+     *  string must outlive the sink.
      *
-     *  @param[in]  channel   Which channel to hook into
+     *  @param[in]  file      Base path, without the rotation suffix
+     *  @return bool          False if the path plus its suffix won't fit
+     */
+    bool setFile( const std::string_view &file );
+
+    /**
+     *  Assigns the RAM buffer messages accumulate in before being written
+     *
+     *  @param[in]  buffer    Statically allocated memory
+     *  @param[in]  size      Size of the buffer. Must be at least one page.
+     *  @param[in]  pageSize  Write granularity of the underlying storage
+     *  @return bool
+     */
+    bool assignCoreMemory( uint8_t *const buffer, const size_t size, const size_t pageSize );
+
+    /**
+     *  Configures file rotation
+     *
+     *  @param[in]  maxFileSize   Size at which to move to the next file. Zero disables rotation.
+     *  @param[in]  maxFiles      Number of files to rotate across
      *  @return void
      */
-    void setFile( const std::string_view &file );
+    void setRotation( const size_t maxFileSize, const size_t maxFiles );
+
+    /**
+     *  Configures when buffered data is forced out to storage, even if it's
+     *  less than a page. Checked each time a message is logged.
+     *
+     *  @param[in]  period    Max time between syncs in milliseconds. Zero disables.
+     *  @param[in]  threshold Sync after this many bytes have been written. Zero disables.
+     *  @return void
+     */
+    void setSyncPolicy( const size_t period, const size_t threshold );
 
     Result open() final override;
     Result close() final override;
@@ -45,7 +86,29 @@ namespace Aurora::Logging
     Result log( const Level level, const void *const message, const size_t length ) final override;
 
   private:
-    std::string_view mFile;
+    std::string_view     mFile;        /**< Base path of the log files */
+    std::array<char, 64> mPath;        /**< Path of the active file */
+    FileSystem::FileId   mFd;          /**< Active file descriptor */
+    bool                 mIsOpen;      /**< Is a file currently open? */
+    uint8_t             *mBuffer;      /**< Staging buffer */
+    size_t               mBufferSize;  /**< Size of the staging buffer */
+    size_t               mPageSize;    /**< Write granularity */
+    size_t               mUsed;        /**< Bytes staged in the buffer */
+    size_t               mFileIndex;   /**< Rotation index of the active file */
+    size_t               mFileSize;    /**< Bytes written to the active file */
+    size_t               mMaxFileSize; /**< Rotation threshold */
+    size_t               mMaxFiles;    /**< Number of files to rotate across */
+    size_t               mSyncPeriod;  /**< Time based sync threshold */
+    size_t               mSyncBytes;   /**< Size based sync threshold */
+    size_t               mLastSync;    /**< Time of the last sync */
+    size_t               mUnsynced;    /**< Bytes written since the last sync */
+
+    bool   makePath( const size_t index );
+    size_t resumeIndex();
+    bool   openFile( const size_t index, const bool resume );
+    bool   rotate();
+    bool   writePending( const bool force );
+    Result sync();
   };
 }  // namespace Aurora::Logging
 
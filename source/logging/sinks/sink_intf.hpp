@@ -53,6 +53,17 @@ namespace Aurora::Logging
 
     virtual IOType getIOType() = 0;
 
+    /**
+     *  Whether the sink can store or carry raw binary records, like the ones
+     *  binary logging mode produces. Text only sinks never receive them.
+     *
+     *  @return bool
+     */
+    virtual bool acceptsBinary()
+    {
+      return false;
+    }
+
     /**
      *  Provides the core functionality of the sink by logging messages.
      *
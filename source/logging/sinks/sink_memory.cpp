@@ -0,0 +1,318 @@
+/******************************************************************************
+ *  File Name:
+ *    sink_memory.cpp
+ *
+ *  Description:
+ *    Implements the RAM ring buffer sink
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/logging>
+#include <Aurora/source/logging/sinks/sink_ring.hpp>
+#include <Chimera/common>
+#include <Chimera/thread>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Stored in front of every message in the ring
+   */
+  struct RingHeader
+  {
+    uint32_t sequence;
+    uint32_t timestamp;
+    uint16_t length;
+    uint8_t  level;
+    uint8_t  flags;
+  };
+  static_assert( ( sizeof( RingHeader ) % Ring::ALIGNMENT ) == 0 );
+
+  /*---------------------------------------------------------------------------
+  Class Implementation
+  ---------------------------------------------------------------------------*/
+  MemorySink::MemorySink() : mBuffer( nullptr ), mSize( 0 ), mSequence( 0 ), mHead( 0 ), mTail( 0 )
+  {
+  }
+
+
+  MemorySink::~MemorySink()
+  {
+  }
+
+
+  bool MemorySink::assignCoreMemory( uint8_t *const buffer, const size_t size )
+  {
+    if ( !buffer || ( size < ( 2u * sizeof( RingHeader ) ) ) )
+    {
+      return false;
+    }
+
+    Chimera::Thread::LockGuard _lck( *this );
+    mBuffer = buffer;
+    mSize   = size & ~( Ring::ALIGNMENT - 1u );
+    mHead.store( 0 );
+    mTail.store( 0 );
+    return true;
+  }
+
+
+  void MemorySink::clear()
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+    mTail.store( mHead.load() );
+  }
+
+
+  MemoryCursor MemorySink::begin() const
+  {
+    MemoryCursor cursor;
+    cursor.position = mTail.load( std::memory_order_acquire );
+    cursor.lost     = 0;
+    return cursor;
+  }
+
+
+  bool MemorySink::next( MemoryCursor &cursor, const MemoryQuery &query, MemoryRecord &record, void *const data,
+                         const size_t size ) const
+  {
+    if ( !mBuffer )
+    {
+      return false;
+    }
+
+    while ( true )
+    {
+      const size_t head = mHead.load( std::memory_order_acquire );
+      const size_t tail = mTail.load( std::memory_order_acquire );
+
+      /*-----------------------------------------------------------------------
+      Catch up if the writer has overwritten our position
+      -----------------------------------------------------------------------*/
+      if ( !isValid( cursor.position, tail, head ) )
+      {
+        cursor.lost += tail - cursor.position;
+        cursor.position = tail;
+      }
+
+      if ( cursor.position == head )
+      {
+        return false;
+      }
+
+      /*-----------------------------------------------------------------------
+      Copy the record out. Anything read here may be torn by a concurrent
+      write, so nothing is trusted until the position is validated again.
+      -----------------------------------------------------------------------*/
+      const size_t offset    = cursor.position % mSize;
+      const size_t remaining = mSize - offset;
+
+      RingHeader hdr;
+      size_t     copied = 0;
+      bool       wrap   = ( remaining < sizeof( RingHeader ) );
+
+      if ( !wrap )
+      {
+        memcpy( &hdr, mBuffer + offset, sizeof( hdr ) );
+        wrap = ( hdr.flags & Ring::FLAG_WRAP ) || ( ( sizeof( hdr ) + hdr.length ) > remaining );
+      }
+
+      if ( !wrap && data )
+      {
+        copied = std::min<size_t>( hdr.length, size );
+        memcpy( data, mBuffer + offset + sizeof( hdr ), copied );
+      }
+
+      std::atomic_thread_fence( std::memory_order_acquire );
+      if ( !isValid( cursor.position, mTail.load( std::memory_order_relaxed ), head ) )
+      {
+        continue;
+      }
+
+      /*-----------------------------------------------------------------------
+      The copy is good, move past it and check it against the query
+      -----------------------------------------------------------------------*/
+      if ( wrap )
+      {
+        cursor.position += remaining;
+        continue;
+      }
+
+      cursor.position += Ring::alignUp( sizeof( hdr ) + hdr.length );
+
+      const Level level = static_cast<Level>( hdr.level );
+      if ( ( level < query.level ) || ( hdr.timestamp < query.start ) || ( hdr.timestamp > query.end ) )
+      {
+        continue;
+      }
+
+      record.sequence  = hdr.sequence;
+      record.timestamp = hdr.timestamp;
+      record.level     = level;
+      record.length    = hdr.length;
+      record.copied    = copied;
+      return true;
+    }
+  }
+
+
+  size_t MemorySink::dump( SinkHandle_rPtr sink, const MemoryQuery &query ) const
+  {
+    std::array<uint8_t, ULOG_MAX_SNPRINTF_BUFFER_LENGTH> buffer;
+    MemoryRecord                                         record;
+    MemoryCursor                                         cursor = begin();
+    size_t                                               count  = 0;
+
+    if ( !sink || ( sink == this ) )
+    {
+      return 0;
+    }
+
+    while ( next( cursor, query, record, buffer.data(), buffer.size() ) )
+    {
+      sink->log( record.level, buffer.data(), record.copied );
+      count++;
+    }
+
+    return count;
+  }
+
+
+  Result MemorySink::open()
+  {
+    if ( !mBuffer )
+    {
+      return Result::RESULT_NO_MEM;
+    }
+
+    enabled = true;
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  Result MemorySink::close()
+  {
+    enabled = false;
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  Result MemorySink::flush()
+  {
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  IOType MemorySink::getIOType()
+  {
+    return IOType::MEMORY_SINK;
+  }
+
+
+  bool MemorySink::acceptsBinary()
+  {
+    return true;
+  }
+
+
+  Result MemorySink::log( const Level level, const void *const message, const size_t length )
+  {
+    /*-------------------------------------------------------------------------
+    Make sure we can actually log the data
+    -------------------------------------------------------------------------*/
+    if ( !enabled || !mBuffer || ( level < logLevel ) || !message || !length )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    const size_t span = Ring::alignUp( sizeof( RingHeader ) + length );
+    if ( ( length > Ring::MAX_LENGTH ) || ( span > ( mSize / 2u ) ) )
+    {
+      return Result::RESULT_FAIL_MSG_TOO_LONG;
+    }
+
+    Chimera::Thread::LockGuard _lck( *this );
+    size_t                     head   = mHead.load( std::memory_order_relaxed );
+    size_t                     offset = head % mSize;
+
+    /*-------------------------------------------------------------------------
+    Records never straddle the end of the ring. Mark the leftover space as
+    unused and start over at the beginning.
+    -------------------------------------------------------------------------*/
+    if ( ( offset + span ) > mSize )
+    {
+      const size_t remaining = mSize - offset;
+      reserve( head, remaining );
+
+      if ( remaining >= sizeof( RingHeader ) )
+      {
+        RingHeader marker{};
+        marker.flags = Ring::FLAG_WRAP;
+        memcpy( mBuffer + offset, &marker, sizeof( marker ) );
+      }
+
+      head += remaining;
+      offset = 0;
+      mHead.store( head, std::memory_order_release );
+    }
+
+    /*-------------------------------------------------------------------------
+    Evict whatever is in the way, then write the record
+    -------------------------------------------------------------------------*/
+    reserve( head, span );
+
+    RingHeader hdr;
+    hdr.sequence  = mSequence++;
+    hdr.timestamp = static_cast<uint32_t>( Chimera::millis() );
+    hdr.length    = static_cast<uint16_t>( length );
+    hdr.level     = static_cast<uint8_t>( level );
+    hdr.flags     = 0;
+
+    memcpy( mBuffer + offset, &hdr, sizeof( hdr ) );
+    memcpy( mBuffer + offset + sizeof( hdr ), message, length );
+
+    mHead.store( head + span, std::memory_order_release );
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  /**
+   *  Checks if a logical position still refers to live data. Positions are
+   *  compared by distance so the check survives counter wrap around.
+   *
+   *  @param[in]  position  Position to check
+   *  @param[in]  tail      Oldest valid position
+   *  @param[in]  head      Next write position
+   *  @return bool
+   */
+  bool MemorySink::isValid( const size_t position, const size_t tail, const size_t head ) const
+  {
+    return ( position - tail ) <= ( head - tail );
+  }
+
+
+  /**
+   *  Moves the tail forward until there is room to write at the head. The new
+   *  tail is published before any bytes are overwritten, so a reader that
+   *  validates after copying will always notice the overwrite.
+   *
+   *  @param[in]  head      Position the write will start at
+   *  @param[in]  bytes     Number of bytes about to be written
+   *  @return void
+   */
+  void MemorySink::reserve( const size_t head, const size_t bytes )
+  {
+    const size_t tail = Ring::evict<RingHeader>( mBuffer, mSize, mTail.load( std::memory_order_relaxed ), head, bytes );
+    mTail.store( tail, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+  }
+}  // namespace Aurora::Logging
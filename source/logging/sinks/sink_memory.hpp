@@ -0,0 +1,148 @@
+/******************************************************************************
+ *  File Name:
+ *    sink_memory.hpp
+ *
+ *  Description:
+ *    RAM ring buffer sink that can be queried while logging continues
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_MEMORY_SINK_HPP
+#define AURORA_LOGGING_MEMORY_SINK_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/logging/logging_types.hpp>
+#include <Aurora/source/logging/sinks/sink_intf.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Description of a single message read back out of a MemorySink
+   */
+  struct MemoryRecord
+  {
+    uint32_t sequence;  /**< Increments by one for every message logged */
+    uint32_t timestamp; /**< System time the message was logged, in ms */
+    Level    level;     /**< Severity level */
+    size_t   length;    /**< Full length of the message */
+    size_t   copied;    /**< Bytes of the message copied out to the caller */
+  };
+
+  /**
+   *  Selects which messages are returned when iterating a MemorySink
+   */
+  struct MemoryQuery
+  {
+    Level  level; /**< Minimum level to return */
+    size_t start; /**< Earliest timestamp to return, inclusive */
+    size_t end;   /**< Latest timestamp to return, inclusive */
+
+    MemoryQuery() : level( Level::LVL_MIN ), start( 0 ), end( std::numeric_limits<size_t>::max() )
+    {
+    }
+  };
+
+  /**
+   *  Read position within a MemorySink. Initialize with MemorySink::begin().
+   */
+  struct MemoryCursor
+  {
+    size_t position; /**< Logical byte offset of the next record */
+    size_t lost;     /**< Bytes overwritten before the reader could get to them */
+  };
+
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Keeps the most recent messages in a RAM ring, overwriting the oldest once
+   *  full. Logging costs a header and a memcpy.
+   *
+   *  Readers never take the sink lock, so they can walk the ring from a shell
+   *  command or a fault handler while producers keep logging. Each record is
+   *  copied out and then checked against the oldest valid position. If the
+   *  writer lapped the reader during the copy, the record is discarded and
+   *  the reader jumps forward to the oldest surviving record.
+   */
+  class MemorySink : public SinkInterface
+  {
+  public:
+    MemorySink();
+    ~MemorySink();
+
+    /**
+     *  Assigns the memory the ring lives in
+     *
+     *  @param[in]  buffer    Statically allocated memory, 4 byte aligned
+     *  @param[in]  size      Size of the buffer in bytes
+     *  @return bool
+     */
+    bool assignCoreMemory( uint8_t *const buffer, const size_t size );
+
+    /**
+     *  Discards everything currently held in the ring
+     *
+     *  @return void
+     */
+    void clear();
+
+    /**
+     *  Gets a cursor pointing at the oldest message in the ring
+     *
+     *  @return MemoryCursor
+     */
+    MemoryCursor begin() const;
+
+    /**
+     *  Reads the next message matching the query and advances the cursor
+     *
+     *  @param[in]  cursor    Read position, updated on return
+     *  @param[in]  query     Filter to apply
+     *  @param[out] record    Description of the message that was read
+     *  @param[out] data      Buffer to copy the message into. May be nullptr.
+     *  @param[in]  size      Size of the data buffer. Longer messages are cut short.
+     *  @return bool          False once there are no more matching messages
+     */
+    bool next( MemoryCursor &cursor, const MemoryQuery &query, MemoryRecord &record, void *const data,
+               const size_t size ) const;
+
+    /**
+     *  Sends every message matching the query to another sink, oldest first
+     *
+     *  @param[in]  sink      Where to send the messages
+     *  @param[in]  query     Filter to apply
+     *  @return size_t        Number of messages sent
+     */
+    size_t dump( SinkHandle_rPtr sink, const MemoryQuery &query ) const;
+
+    Result open() final override;
+    Result close() final override;
+    Result flush() final override;
+    IOType getIOType() final override;
+    bool   acceptsBinary() final override;
+    Result log( const Level level, const void *const message, const size_t length ) final override;
+
+  private:
+    uint8_t            *mBuffer;   /**< Ring storage */
+    size_t              mSize;     /**< Usable bytes in the ring, a multiple of 4 */
+    uint32_t            mSequence; /**< Sequence number of the next message */
+    std::atomic<size_t> mHead;     /**< Logical position the next record is written at */
+    std::atomic<size_t> mTail;     /**< Logical position of the oldest valid record */
+
+    bool isValid( const size_t position, const size_t tail, const size_t head ) const;
+    void reserve( const size_t head, const size_t bytes );
+  };
+}  // namespace Aurora::Logging
+
+#endif /* !AURORA_LOGGING_MEMORY_SINK_HPP */
@@ -0,0 +1,352 @@
+/******************************************************************************
+ *  File Name:
+ *    sink_persistent.cpp
+ *
+ *  Description:
+ *    Implements the no-init RAM crash log sink
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/logging>
+#include <Aurora/source/logging/sinks/sink_ring.hpp>
+#include <Chimera/common>
+#include <Chimera/thread>
+#include <atomic>
+#include <cstring>
+#include <etl/crc32.h>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr uint32_t MAGIC = 0x4C4F4721; /* "LOG!" */
+
+  /*---------------------------------------------------------------------------
+  Structures
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Lives at the start of the no-init region. Only the fields that never
+   *  change are covered by the CRC, so updating the positions is cheap.
+   */
+  struct PersistentSink::Control
+  {
+    uint32_t magic;    /**< Identifies a formatted region */
+    uint32_t size;     /**< Ring size the region was formatted with */
+    uint32_t crc;      /**< CRC of magic and size */
+    uint32_t sequence; /**< Sequence number of the next record */
+    uint32_t head;     /**< Logical position of the next write */
+    uint32_t tail;     /**< Logical position of the oldest record */
+  };
+
+  /**
+   *  Stored in front of every message
+   */
+  struct PersistentRecord
+  {
+    uint32_t crc;       /**< Covers everything after this field plus the message */
+    uint32_t sequence;  /**< Continues across resets */
+    uint32_t timestamp; /**< System time the message was logged, in ms */
+    uint16_t length;    /**< Message length in bytes */
+    uint8_t  level;     /**< Severity level */
+    uint8_t  flags;     /**< FLAG_WRAP marks unused space at the end of the ring */
+  };
+  static_assert( ( sizeof( PersistentRecord ) % Ring::ALIGNMENT ) == 0 );
+
+  /*---------------------------------------------------------------------------
+  Static Functions
+  ---------------------------------------------------------------------------*/
+  static uint32_t controlCRC( const uint32_t magic, const uint32_t size )
+  {
+    etl::crc32 crc;
+    crc.add( reinterpret_cast<const uint8_t *>( &magic ), reinterpret_cast<const uint8_t *>( &magic ) + sizeof( magic ) );
+    crc.add( reinterpret_cast<const uint8_t *>( &size ), reinterpret_cast<const uint8_t *>( &size ) + sizeof( size ) );
+    return crc.value();
+  }
+
+
+  static uint32_t recordCRC( const PersistentRecord &rec, const uint8_t *const data, const size_t length )
+  {
+    const uint8_t *fields = reinterpret_cast<const uint8_t *>( &rec ) + sizeof( rec.crc );
+
+    etl::crc32 crc;
+    crc.add( fields, fields + sizeof( rec ) - sizeof( rec.crc ) );
+    crc.add( data, data + length );
+    return crc.value();
+  }
+
+
+  /**
+   *  Keeps the compiler from sinking the position update above the record
+   *  writes, so a reset in the middle of a write never exposes a partial record
+   */
+  static inline void commitBarrier()
+  {
+    std::atomic_signal_fence( std::memory_order_seq_cst );
+  }
+
+  /*---------------------------------------------------------------------------
+  Class Implementation
+  ---------------------------------------------------------------------------*/
+  PersistentSink::PersistentSink() : mCtrl( nullptr ), mRing( nullptr ), mRingSize( 0 ), mRecovered( false )
+  {
+  }
+
+
+  PersistentSink::~PersistentSink()
+  {
+  }
+
+
+  bool PersistentSink::assignCoreMemory( void *const region, const size_t size )
+  {
+    if ( !region || ( size < ( sizeof( Control ) + 2u * sizeof( PersistentRecord ) ) ) )
+    {
+      return false;
+    }
+
+    Chimera::Thread::LockGuard _lck( *this );
+    mCtrl     = reinterpret_cast<Control *>( region );
+    mRing     = reinterpret_cast<uint8_t *>( region ) + sizeof( Control );
+    mRingSize = ( size - sizeof( Control ) ) & ~( Ring::ALIGNMENT - 1u );
+
+    /*-------------------------------------------------------------------------
+    Keep the old contents only if the header is intact and the positions make
+    sense for this geometry. Anything else means a cold boot or a new layout.
+    -------------------------------------------------------------------------*/
+    const uint32_t ringSize = static_cast<uint32_t>( mRingSize );
+    const bool     intact   = ( mCtrl->magic == MAGIC ) && ( mCtrl->size == ringSize ) &&
+                          ( mCtrl->crc == controlCRC( MAGIC, ringSize ) ) &&
+                          ( ( mCtrl->head - mCtrl->tail ) <= ringSize ) && isConsistent();
+
+    if ( !intact )
+    {
+      mCtrl->magic    = MAGIC;
+      mCtrl->size     = ringSize;
+      mCtrl->crc      = controlCRC( MAGIC, ringSize );
+      mCtrl->sequence = 0;
+      mCtrl->head     = 0;
+      mCtrl->tail     = 0;
+    }
+
+    mRecovered = intact && ( mCtrl->head != mCtrl->tail );
+    return true;
+  }
+
+
+  bool PersistentSink::hasRecovered() const
+  {
+    return mRecovered;
+  }
+
+
+  size_t PersistentSink::recover( SinkHandle_rPtr sink )
+  {
+    if ( !mCtrl || !sink || ( sink == this ) )
+    {
+      return 0;
+    }
+
+    Chimera::Thread::LockGuard _lck( *this );
+    uint32_t                   position = mCtrl->tail;
+    size_t                     count    = 0;
+
+    while ( position != mCtrl->head )
+    {
+      const size_t span = Ring::span<PersistentRecord>( mRing, mRingSize, position );
+      if ( !span || ( span > static_cast<uint32_t>( mCtrl->head - position ) ) )
+      {
+        break;
+      }
+
+      /*-----------------------------------------------------------------------
+      A bad CRC means the record was damaged or being written when the reset
+      hit. Its length can't be trusted either, so nothing past it is replayed.
+      -----------------------------------------------------------------------*/
+      const size_t offset = position % mRingSize;
+      if ( ( mRingSize - offset ) >= sizeof( PersistentRecord ) )
+      {
+        PersistentRecord rec;
+        memcpy( &rec, mRing + offset, sizeof( rec ) );
+
+        const bool     wrap   = ( rec.flags & Ring::FLAG_WRAP );
+        const uint8_t *data   = mRing + offset + sizeof( rec );
+        const size_t   length = wrap ? 0 : rec.length;
+
+        if ( rec.crc != recordCRC( rec, data, length ) )
+        {
+          break;
+        }
+
+        if ( !wrap )
+        {
+          sink->log( static_cast<Level>( rec.level ), data, length );
+          count++;
+        }
+      }
+
+      position += static_cast<uint32_t>( span );
+    }
+
+    mCtrl->tail = mCtrl->head;
+    mRecovered  = false;
+    return count;
+  }
+
+
+  void PersistentSink::clear()
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+    if ( mCtrl )
+    {
+      mCtrl->tail = mCtrl->head;
+    }
+  }
+
+
+  Result PersistentSink::open()
+  {
+    if ( !mCtrl )
+    {
+      return Result::RESULT_NO_MEM;
+    }
+
+    enabled = true;
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  Result PersistentSink::close()
+  {
+    enabled = false;
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  Result PersistentSink::flush()
+  {
+    /* Nothing to do, RAM is as durable as this sink gets */
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  IOType PersistentSink::getIOType()
+  {
+    return IOType::PERSISTENT_SINK;
+  }
+
+
+  bool PersistentSink::acceptsBinary()
+  {
+    return true;
+  }
+
+
+  Result PersistentSink::log( const Level level, const void *const message, const size_t length )
+  {
+    /*-------------------------------------------------------------------------
+    Make sure we can actually log the data
+    -------------------------------------------------------------------------*/
+    if ( !enabled || !mCtrl || ( level < logLevel ) || !message || !length )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    const size_t span = Ring::alignUp( sizeof( PersistentRecord ) + length );
+    if ( ( length > Ring::MAX_LENGTH ) || ( span > ( mRingSize / 2u ) ) )
+    {
+      return Result::RESULT_FAIL_MSG_TOO_LONG;
+    }
+
+    Chimera::Thread::LockGuard _lck( *this );
+    uint32_t                   head   = mCtrl->head;
+    size_t                     offset = head % mRingSize;
+
+    /*-------------------------------------------------------------------------
+    Records never straddle the end of the ring
+    -------------------------------------------------------------------------*/
+    if ( ( offset + span ) > mRingSize )
+    {
+      const size_t remaining = mRingSize - offset;
+      reserve( head, remaining );
+
+      if ( remaining >= sizeof( PersistentRecord ) )
+      {
+        PersistentRecord marker{};
+        marker.flags = Ring::FLAG_WRAP;
+        marker.crc   = recordCRC( marker, nullptr, 0 );
+        memcpy( mRing + offset, &marker, sizeof( marker ) );
+      }
+
+      head += static_cast<uint32_t>( remaining );
+      offset = 0;
+
+      commitBarrier();
+      mCtrl->head = head;
+    }
+
+    /*-------------------------------------------------------------------------
+    Write the record first, then publish it by moving the head
+    -------------------------------------------------------------------------*/
+    reserve( head, span );
+
+    PersistentRecord rec;
+    rec.sequence  = mCtrl->sequence++;
+    rec.timestamp = static_cast<uint32_t>( Chimera::millis() );
+    rec.length    = static_cast<uint16_t>( length );
+    rec.level     = static_cast<uint8_t>( level );
+    rec.flags     = 0;
+    rec.crc       = recordCRC( rec, reinterpret_cast<const uint8_t *>( message ), length );
+
+    memcpy( mRing + offset, &rec, sizeof( rec ) );
+    memcpy( mRing + offset + sizeof( rec ), message, length );
+
+    commitBarrier();
+    mCtrl->head = head + static_cast<uint32_t>( span );
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  /**
+   *  Walks the ring from tail to head using only the record headers, checking
+   *  that the spans line up exactly with the head. Once this passes, eviction
+   *  can trust the lengths without checking any CRCs.
+   *
+   *  @return bool
+   */
+  bool PersistentSink::isConsistent() const
+  {
+    uint32_t position = mCtrl->tail;
+
+    while ( position != mCtrl->head )
+    {
+      const size_t span = Ring::span<PersistentRecord>( mRing, mRingSize, position );
+      if ( !span || ( span > static_cast<uint32_t>( mCtrl->head - position ) ) )
+      {
+        return false;
+      }
+
+      position += static_cast<uint32_t>( span );
+    }
+
+    return true;
+  }
+
+
+  /**
+   *  Evicts the oldest records until there is room to write at the head
+   *
+   *  @param[in]  head      Position the write will start at
+   *  @param[in]  bytes     Number of bytes about to be written
+   *  @return void
+   */
+  void PersistentSink::reserve( const uint32_t head, const size_t bytes )
+  {
+    mCtrl->tail = Ring::evict<PersistentRecord>( mRing, mRingSize, mCtrl->tail, head, bytes );
+    commitBarrier();
+  }
+}  // namespace Aurora::Logging
@@ -0,0 +1,114 @@
+/******************************************************************************
+ *  File Name:
+ *    sink_persistent.hpp
+ *
+ *  Description:
+ *    Log sink backed by no-init RAM that survives a warm reset
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_PERSISTENT_SINK_HPP
+#define AURORA_LOGGING_PERSISTENT_SINK_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_types.hpp>
+#include <Aurora/source/logging/sinks/sink_intf.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/*-----------------------------------------------------------------------------
+Macros
+-----------------------------------------------------------------------------*/
+/**
+ *  Places a buffer in RAM the startup code doesn't zero or initialize, so its
+ *  contents are still there after a watchdog reset or fault. The linker script
+ *  must provide the section.
+ */
+#define AURORA_LOG_NOINIT_ATTR __attribute__( ( section( ULOG_NOINIT_SECTION ), aligned( 4 ) ) )
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Writes messages into a ring in no-init RAM and does nothing else, so
+   *  capturing the lead up to a crash costs only a memcpy and a CRC.
+   *
+   *  The region starts with a header holding a magic number, the geometry,
+   *  and the ring positions, and every record carries its own CRC. On the
+   *  next boot, assignCoreMemory() checks whether the region holds a log
+   *  from before the reset, and recover() replays whatever survived intact
+   *  into a real sink, such as a FileSink or SerialSink. CRCs are only
+   *  checked during recovery. Eviction only reads record headers.
+   *
+   *  Typical boot sequence:
+   *    1. assignCoreMemory() with the no-init buffer
+   *    2. recover() into a sink that writes to storage or a console
+   *    3. registerSink() with this sink
+   */
+  class PersistentSink : public SinkInterface
+  {
+  public:
+    PersistentSink();
+    ~PersistentSink();
+
+    /**
+     *  Attaches the no-init region. A valid log left over from before the
+     *  reset is kept for recover(), otherwise the region is formatted.
+     *
+     *  @param[in]  region    No-init memory, 4 byte aligned
+     *  @param[in]  size      Size of the region in bytes
+     *  @return bool
+     */
+    bool assignCoreMemory( void *const region, const size_t size );
+
+    /**
+     *  Checks if messages from before the last reset are waiting
+     *
+     *  @return bool
+     */
+    bool hasRecovered() const;
+
+    /**
+     *  Replays surviving messages into another sink, oldest first, then
+     *  empties the ring. Stops at the first record that fails its CRC.
+     *
+     *  @param[in]  sink      Where to send the messages
+     *  @return size_t        Number of messages replayed
+     */
+    size_t recover( SinkHandle_rPtr sink );
+
+    /**
+     *  Discards everything in the ring
+     *
+     *  @return void
+     */
+    void clear();
+
+    Result open() final override;
+    Result close() final override;
+    Result flush() final override;
+    IOType getIOType() final override;
+    bool   acceptsBinary() final override;
+    Result log( const Level level, const void *const message, const size_t length ) final override;
+
+  private:
+    struct Control;
+
+    Control *mCtrl;      /**< Header at the start of the region */
+    uint8_t *mRing;      /**< Record storage following the header */
+    size_t   mRingSize;  /**< Usable bytes in the ring, a multiple of 4 */
+    bool     mRecovered; /**< A previous log was found at startup */
+
+    bool isConsistent() const;
+    void reserve( const uint32_t head, const size_t bytes );
+  };
+}  // namespace Aurora::Logging
+
+#endif /* !AURORA_LOGGING_PERSISTENT_SINK_HPP */
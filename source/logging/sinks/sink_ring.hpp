@@ -0,0 +1,114 @@
+/******************************************************************************
+ *  File Name:
+ *    sink_ring.hpp
+ *
+ *  Description:
+ *    Record ring layout shared by the RAM backed sinks
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_SINK_RING_HPP
+#define AURORA_LOGGING_SINK_RING_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace Aurora::Logging::Ring
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr uint8_t FLAG_WRAP  = 0x01; /**< Rest of the ring is unused, continue at the start */
+  static constexpr size_t  ALIGNMENT  = 4;    /**< Every record starts on this boundary */
+  static constexpr size_t  MAX_LENGTH = std::numeric_limits<uint16_t>::max();
+
+  /*---------------------------------------------------------------------------
+  Public Functions
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Rounds a record size up to the ring alignment
+   *
+   *  @param[in]  value     Size in bytes
+   *  @return size_t
+   */
+  static constexpr size_t alignUp( const size_t value )
+  {
+    return ( value + ALIGNMENT - 1u ) & ~( ALIGNMENT - 1u );
+  }
+
+
+  /**
+   *  Number of bytes the record at a position occupies, including any wrap
+   *  padding. Only the header is read, so this is cheap enough to call for
+   *  every record evicted. The Header type must have `length` and `flags`
+   *  fields and a size that is a multiple of ALIGNMENT.
+   *
+   *  @param[in]  ring      Start of the ring storage
+   *  @param[in]  size      Size of the ring in bytes
+   *  @param[in]  position  Logical position of the record
+   *  @return size_t        Span in bytes, or zero if the length runs off the end
+   */
+  template<typename Header>
+  size_t span( const uint8_t *const ring, const size_t size, const size_t position )
+  {
+    static_assert( ( sizeof( Header ) % ALIGNMENT ) == 0 );
+
+    const size_t offset    = position % size;
+    const size_t remaining = size - offset;
+
+    if ( remaining < sizeof( Header ) )
+    {
+      return remaining;
+    }
+
+    Header hdr;
+    memcpy( &hdr, ring + offset, sizeof( hdr ) );
+
+    if ( hdr.flags & FLAG_WRAP )
+    {
+      return remaining;
+    }
+
+    const size_t bytes = alignUp( sizeof( hdr ) + hdr.length );
+    return ( bytes <= remaining ) ? bytes : 0;
+  }
+
+
+  /**
+   *  Finds the tail that leaves enough room to write at the head, stepping
+   *  over the oldest records one span at a time. A damaged header empties
+   *  the ring rather than spinning on it.
+   *
+   *  @param[in]  ring      Start of the ring storage
+   *  @param[in]  size      Size of the ring in bytes
+   *  @param[in]  tail      Logical position of the oldest record
+   *  @param[in]  head      Position the write will start at
+   *  @param[in]  bytes     Number of bytes about to be written
+   *  @return Position      New tail
+   */
+  template<typename Header, typename Position>
+  Position evict( const uint8_t *const ring, const size_t size, Position tail, const Position head, const size_t bytes )
+  {
+    while ( static_cast<size_t>( static_cast<Position>( head + bytes - tail ) ) > size )
+    {
+      const size_t step = span<Header>( ring, size, tail );
+      if ( !step )
+      {
+        return head;
+      }
+
+      tail += static_cast<Position>( step );
+    }
+
+    return tail;
+  }
+}  // namespace Aurora::Logging::Ring
+
+#endif /* !AURORA_LOGGING_SINK_RING_HPP */
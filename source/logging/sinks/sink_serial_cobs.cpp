@@ -0,0 +1,156 @@
+/******************************************************************************
+ *  File Name:
+ *    sink_serial_cobs.cpp
+ *
+ *  Description:
+ *    Implements the COBS framed serial sink
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/logging>
+#include <Chimera/serial>
+#include <Chimera/thread>
+#include <cstring>
+#include <etl/crc32.h>
+
+#include "cobs.h"
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Class Implementation
+  ---------------------------------------------------------------------------*/
+  SerialCobsSink::SerialCobsSink() : mSerial( nullptr )
+  {
+  }
+
+
+  SerialCobsSink::SerialCobsSink( Chimera::Serial::Channel channel ) : SerialCobsSink()
+  {
+    assignChannel( channel );
+  }
+
+
+  SerialCobsSink::~SerialCobsSink()
+  {
+  }
+
+
+  void SerialCobsSink::assignChannel( Chimera::Serial::Channel channel )
+  {
+    mSerial = Chimera::Serial::getDriver( channel );
+    RT_DBG_ASSERT( mSerial );
+  }
+
+
+  Result SerialCobsSink::open()
+  {
+    if ( !mSerial )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  Result SerialCobsSink::close()
+  {
+    Chimera::Thread::LockGuard _lck( *this );
+    mSerial = nullptr;
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  Result SerialCobsSink::flush()
+  {
+    return Result::RESULT_SUCCESS;
+  }
+
+
+  IOType SerialCobsSink::getIOType()
+  {
+    return IOType::SERIAL_COBS_SINK;
+  }
+
+
+  bool SerialCobsSink::acceptsBinary()
+  {
+    return true;
+  }
+
+
+  Result SerialCobsSink::log( const Level level, const void *const message, const size_t length )
+  {
+    using namespace Chimera::Thread;
+
+    /*-------------------------------------------------------------------------
+    Make sure we can actually log the data
+    -------------------------------------------------------------------------*/
+    if ( mSerial == nullptr )
+    {
+      return Result::RESULT_FAIL_BAD_SINK;
+    }
+
+    if ( level < logLevel )
+    {
+      return Result::RESULT_INVALID_LEVEL;
+    }
+
+    if ( !message || !length )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    if ( length > MAX_MESSAGE_SIZE )
+    {
+      return Result::RESULT_FAIL_MSG_TOO_LONG;
+    }
+
+    LockGuard _lck( *this );
+
+    /*-------------------------------------------------------------------------
+    Assemble the raw frame: level, message, then the CRC over both
+    -------------------------------------------------------------------------*/
+    mRaw[ 0 ] = static_cast<uint8_t>( level );
+    memcpy( mRaw.data() + 1, message, length );
+
+    etl::crc32 crc;
+    crc.add( mRaw.begin(), mRaw.begin() + 1 + length );
+
+    const uint32_t value = crc.value();
+    for ( size_t i = 0; i < sizeof( value ); i++ )
+    {
+      mRaw[ 1 + length + i ] = static_cast<uint8_t>( value >> ( 8u * i ) );
+    }
+
+    /*-------------------------------------------------------------------------
+    Encode and terminate with the frame delimiter
+    -------------------------------------------------------------------------*/
+    const size_t             rawSize = length + FRAME_OVERHEAD;
+    const cobs_encode_result encoded = cobs_encode( mFrame.data(), mFrame.size() - 1, mRaw.data(), rawSize );
+    if ( encoded.status != COBS_ENCODE_OK )
+    {
+      return Result::RESULT_FAIL;
+    }
+
+    mFrame[ encoded.out_len ] = 0x00;
+
+    /*-------------------------------------------------------------------------
+    Ship the whole frame at once, blocking until the driver is done with it
+    -------------------------------------------------------------------------*/
+    if ( mSerial->write( mFrame.data(), encoded.out_len + 1, TIMEOUT_BLOCK ) == Chimera::Status::OK )
+    {
+      return Result::RESULT_SUCCESS;
+    }
+    else
+    {
+      return Result::RESULT_FAIL;
+    }
+  }
+
+}  // namespace Aurora::Logging
@@ -0,0 +1,93 @@
+/******************************************************************************
+ *  File Name:
+ *    sink_serial_cobs.hpp
+ *
+ *  Description:
+ *    Serial sink that frames each log record with COBS and a CRC
+ *
+ *  2023 | Brandon Braun | brandonbraun653@protonmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_LOGGING_SERIAL_COBS_SINK_HPP
+#define AURORA_LOGGING_SERIAL_COBS_SINK_HPP
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/logging/logging_binary.hpp>
+#include <Aurora/source/logging/logging_config.hpp>
+#include <Aurora/source/logging/logging_types.hpp>
+#include <Aurora/source/logging/sinks/sink_intf.hpp>
+#include <Chimera/serial>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Aurora::Logging
+{
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   *  Sends each log record, text or binary, as a single COBS encoded frame:
+   *
+   *    COBS( level[1] | message[N] | crc32[4] ) | 0x00
+   *
+   *  The CRC is little endian and covers the level and message bytes. Since
+   *  0x00 only ever appears as the delimiter, a receiver that loses bytes
+   *  resynchronizes on the next frame boundary. Each frame is handed to the
+   *  serial driver in one write so it can go out as a single DMA transfer.
+   *
+   *  Projects using this sink must link against lib_cobs.
+   */
+  class SerialCobsSink : public SinkInterface
+  {
+  public:
+    /**
+     *  Largest message that can be framed. Sized to fit the longest formatted
+     *  text message, a full binary record, or a full key/value record.
+     */
+    static constexpr size_t MAX_MESSAGE_SIZE =
+        std::max<size_t>( { ULOG_MAX_MESSAGE_LENGTH, sizeof( Binary::RecordHeader ) + ULOG_BINARY_MAX_ARG_BYTES,
+                            ULOG_KV_MAX_RECORD_BYTES } );
+
+    /**
+     *  Bytes of framing overhead added around each message before encoding
+     */
+    static constexpr size_t FRAME_OVERHEAD = sizeof( uint8_t ) + sizeof( uint32_t );
+
+    SerialCobsSink();
+    explicit SerialCobsSink( Chimera::Serial::Channel channel );
+    ~SerialCobsSink();
+
+    /**
+     *  Assigns the serial channel to use when the default
+     *  constructor was used.
+     *
+     *  @param[in]  channel   Which channel to hook into
+     *  @return void
+     */
+    void assignChannel( Chimera::Serial::Channel channel );
+
+    Result open() final override;
+    Result close() final override;
+    Result flush() final override;
+    IOType getIOType() final override;
+    bool   acceptsBinary() final override;
+    Result log( const Level level, const void *const message, const size_t length ) final override;
+
+  private:
+    static constexpr size_t RAW_SIZE = MAX_MESSAGE_SIZE + FRAME_OVERHEAD;
+
+    /* Worst case COBS expansion is one byte per 254, plus the delimiter */
+    static constexpr size_t ENCODED_SIZE = RAW_SIZE + ( ( RAW_SIZE + 253u ) / 254u ) + 1u;
+
+    Chimera::Serial::Driver_rPtr      mSerial;
+    std::array<uint8_t, RAW_SIZE>     mRaw;
+    std::array<uint8_t, ENCODED_SIZE> mFrame;
+  };
+}  // namespace Aurora::Logging
+
+#endif /* !AURORA_LOGGING_SERIAL_COBS_SINK_HPP */
@@ -0,0 +1,221 @@
+/******************************************************************************
+ *  File Name:
+ *    generic_file_device.cpp
+ *
+ *  Description:
+ *    File backed memory device implementation
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#if defined( SIMULATOR )
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/memory/generic/generic_file_device.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+namespace Aurora::Memory
+{
+  /*---------------------------------------------------------------------------
+  Constants
+  ---------------------------------------------------------------------------*/
+  static constexpr uint8_t ERASED_VALUE = 0xFF;
+
+  /*---------------------------------------------------------------------------
+  Class Implementation
+  ---------------------------------------------------------------------------*/
+  FileDevice::FileDevice() : mSize( 0 ), mFd( -1 ), mAttr( { 0, 0, 0 } )
+  {
+  }
+
+
+  FileDevice::~FileDevice()
+  {
+    close();
+  }
+
+
+  void FileDevice::configure( const std::filesystem::path &path, const size_t size )
+  {
+    mPath = path;
+    mSize = size;
+  }
+
+
+  Status FileDevice::open( const DeviceAttr *const attributes )
+  {
+    /*-------------------------------------------------------------------------
+    Input Protection
+    -------------------------------------------------------------------------*/
+    if ( !attributes || !attributes->readSize || !attributes->writeSize || !attributes->eraseSize || !mSize
+         || mPath.empty() )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    if ( mFd >= 0 )
+    {
+      return Status::ERR_OK;
+    }
+
+    /*-------------------------------------------------------------------------
+    Open the backing file, sizing it to match the device. New space reads back
+    as erased memory.
+    -------------------------------------------------------------------------*/
+    const bool existed = std::filesystem::exists( mPath );
+    const int  fd      = ::open( mPath.c_str(), O_RDWR | O_CREAT, 0644 );
+    if ( fd < 0 )
+    {
+      return Status::ERR_DRIVER_ERR;
+    }
+
+    const off_t oldSize = existed ? lseek( fd, 0, SEEK_END ) : 0;
+    if ( ( oldSize < 0 ) || ( ftruncate( fd, static_cast<off_t>( mSize ) ) != 0 ) )
+    {
+      ::close( fd );
+      return Status::ERR_DRIVER_ERR;
+    }
+
+    mFd   = fd;
+    mAttr = *attributes;
+
+    if ( static_cast<size_t>( oldSize ) < mSize )
+    {
+      return erase( static_cast<size_t>( oldSize ), mSize - static_cast<size_t>( oldSize ) );
+    }
+
+    return Status::ERR_OK;
+  }
+
+
+  Status FileDevice::close()
+  {
+    if ( mFd >= 0 )
+    {
+      fsync( mFd );
+      ::close( mFd );
+      mFd = -1;
+    }
+
+    return Status::ERR_OK;
+  }
+
+
+  Status FileDevice::write( const size_t chunk, const size_t offset, const void *const data, const size_t length )
+  {
+    return write( ( chunk * mAttr.writeSize ) + offset, data, length );
+  }
+
+
+  Status FileDevice::write( const size_t address, const void *const data, const size_t length )
+  {
+    if ( !data || !inRange( address, length ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    const ssize_t written = pwrite( mFd, data, length, static_cast<off_t>( address ) );
+    return ( written == static_cast<ssize_t>( length ) ) ? Status::ERR_OK : Status::ERR_DRIVER_ERR;
+  }
+
+
+  Status FileDevice::read( const size_t chunk, const size_t offset, void *const data, const size_t length )
+  {
+    return read( ( chunk * mAttr.readSize ) + offset, data, length );
+  }
+
+
+  Status FileDevice::read( const size_t address, void *const data, const size_t length )
+  {
+    if ( !data || !inRange( address, length ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    const ssize_t bytes = pread( mFd, data, length, static_cast<off_t>( address ) );
+    return ( bytes == static_cast<ssize_t>( length ) ) ? Status::ERR_OK : Status::ERR_DRIVER_ERR;
+  }
+
+
+  Status FileDevice::erase( const size_t chunk )
+  {
+    return erase( chunk * mAttr.eraseSize, mAttr.eraseSize );
+  }
+
+
+  Status FileDevice::erase( const size_t address, const size_t length )
+  {
+    if ( !inRange( address, length ) )
+    {
+      return Status::ERR_BAD_ARG;
+    }
+
+    /*-------------------------------------------------------------------------
+    Fill in bounded pieces to keep the scratch memory small
+    -------------------------------------------------------------------------*/
+    std::vector<uint8_t> fill( std::min( length, std::max<size_t>( mAttr.eraseSize, 4096 ) ), ERASED_VALUE );
+
+    size_t done = 0;
+    while ( done < length )
+    {
+      const size_t  chunk   = std::min( fill.size(), length - done );
+      const ssize_t written = pwrite( mFd, fill.data(), chunk, static_cast<off_t>( address + done ) );
+      if ( written != static_cast<ssize_t>( chunk ) )
+      {
+        return Status::ERR_DRIVER_ERR;
+      }
+
+      done += chunk;
+    }
+
+    return Status::ERR_OK;
+  }
+
+
+  Status FileDevice::erase()
+  {
+    return erase( 0, mSize );
+  }
+
+
+  Status FileDevice::flush()
+  {
+    if ( mFd < 0 )
+    {
+      return Status::ERR_FAIL;
+    }
+
+    return ( fdatasync( mFd ) == 0 ) ? Status::ERR_OK : Status::ERR_DRIVER_ERR;
+  }
+
+
+  Status FileDevice::pendEvent( const Event event, const size_t timeout )
+  {
+    /*-------------------------------------------------------------------------
+    Every operation completes before returning
+    -------------------------------------------------------------------------*/
+    ( void )timeout;
+    return ( event == Event::MEM_ERROR ) ? Status::ERR_FAIL : Status::ERR_OK;
+  }
+
+
+  /**
+   * @brief Checks that an access is on an open device and within its bounds
+   *
+   * @param address   Starting byte
+   * @param length    Number of bytes
+   * @return bool
+   */
+  bool FileDevice::inRange( const size_t address, const size_t length ) const
+  {
+    return ( mFd >= 0 ) && ( address <= mSize ) && ( length <= ( mSize - address ) );
+  }
+}  // namespace Aurora::Memory
+
+#endif /* SIMULATOR */
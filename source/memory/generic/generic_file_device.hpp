@@ -0,0 +1,74 @@
+/******************************************************************************
+ *  File Name:
+ *    generic_file_device.hpp
+ *
+ *  Description:
+ *    Memory device backed by a file on the host, for simulator builds
+ *
+ *  2023 | Brandon Braun | brandonbraun653@gmail.com
+ *****************************************************************************/
+
+#pragma once
+#ifndef AURORA_GENERIC_FILE_DEVICE_HPP
+#define AURORA_GENERIC_FILE_DEVICE_HPP
+
+#if defined( SIMULATOR )
+
+/*-----------------------------------------------------------------------------
+Includes
+-----------------------------------------------------------------------------*/
+#include <Aurora/source/memory/generic/generic_intf.hpp>
+#include <Aurora/source/memory/generic/generic_types.hpp>
+#include <cstddef>
+#include <filesystem>
+
+namespace Aurora::Memory
+{
+  /*---------------------------------------------------------------------------
+  Classes
+  ---------------------------------------------------------------------------*/
+  /**
+   * @brief Block device that stores its contents in a host file
+   *
+   * Every transfer is a single pread/pwrite, no matter the size, which makes
+   * it a reasonable stand-in for an SD card when exercising a filesystem on
+   * the host. Chunk sizes come from the DeviceAttr passed to open().
+   */
+  class FileDevice : public virtual IGenericDevice
+  {
+  public:
+    FileDevice();
+    ~FileDevice();
+
+    /**
+     * @brief Selects the backing file. Must be called before open().
+     *
+     * @param path      File to store the device contents in. Created if missing.
+     * @param size      Device capacity in bytes
+     */
+    void configure( const std::filesystem::path &path, const size_t size );
+
+    Status open( const DeviceAttr *const attributes ) final override;
+    Status close() final override;
+    Status write( const size_t chunk, const size_t offset, const void *const data, const size_t length ) final override;
+    Status write( const size_t address, const void *const data, const size_t length ) final override;
+    Status read( const size_t chunk, const size_t offset, void *const data, const size_t length ) final override;
+    Status read( const size_t address, void *const data, const size_t length ) final override;
+    Status erase( const size_t chunk ) final override;
+    Status erase( const size_t address, const size_t length ) final override;
+    Status erase() final override;
+    Status flush() final override;
+    Status pendEvent( const Event event, const size_t timeout ) final override;
+
+  private:
+    std::filesystem::path mPath; /**< Backing file */
+    size_t                mSize; /**< Capacity in bytes */
+    int                   mFd;   /**< Open file descriptor, negative if closed */
+    DeviceAttr            mAttr; /**< Chunk sizes */
+
+    bool inRange( const size_t address, const size_t length ) const;
+  };
+}  // namespace Aurora::Memory
+
+#endif /* SIMULATOR */
+#endif /* !AURORA_GENERIC_FILE_DEVICE_HPP */
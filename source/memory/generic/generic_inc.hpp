@@ -12,6 +12,7 @@
 #ifndef AURORA_GENERIC_MEMORY_INCLUDES_HPP
 #define AURORA_GENERIC_MEMORY_INCLUDES_HPP
 
+#include <Aurora/source/memory/generic/generic_file_device.hpp>
 #include <Aurora/source/memory/generic/generic_intf.hpp>
 #include <Aurora/source/memory/generic/generic_types.hpp>
 #include <Aurora/source/memory/generic/generic_utils.hpp>